@@ -7,5 +7,6 @@
 
 #include "JsonReader.h"
 #include "JsonWriter.h"
+#include "JsonGenerator.h"
 
 /* JSON_H_ */
@@ -0,0 +1,135 @@
+/*
+ * JsonAllocator.h
+ *
+ * Allocator counting the memory of the documents and reader stacks of the toolkit.
+ *
+ * The memory pool of a document frees its chunks on the next parse only, and the
+ * stack of a reader keeps the capacity needed for the longest string it copied,
+ * so one large document can keep memory resident long after it was processed.
+ * The counts show which context or operator holds it.
+ */
+
+#ifndef JSON_ALLOCATOR_H_
+#define JSON_ALLOCATOR_H_
+
+#include "rapidjson/allocators.h"
+
+#include <cstdlib>
+#include <string>
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+
+
+namespace com { namespace ibm { namespace streamsx { namespace json {
+
+	/*
+	 * Allocations of one allocator, for a memory pool an allocation is a chunk
+	 */
+	struct AllocationStats {
+
+		AllocationStats() : allocations(0), frees(0), bytesAllocated(0), currentBytes(0), peakBytes(0) {}
+
+		void add(size_t size) {
+			allocations++;
+			bytesAllocated += size;
+			currentBytes += size;
+			if(currentBytes > peakBytes)
+				peakBytes = currentBytes;
+		}
+
+		void remove(size_t size) {
+			frees++;
+			currentBytes -= size;
+		}
+
+		/* counts by name with the given prefix */
+		void toMap(std::string const& prefix, SPL::map<SPL::rstring, SPL::uint64> & values) const {
+			values[prefix + "Allocations"] = allocations;
+			values[prefix + "Blocks"] = allocations - frees;
+			values[prefix + "BytesAllocated"] = bytesAllocated;
+			values[prefix + "CurrentBytes"] = currentBytes;
+			values[prefix + "PeakBytes"] = peakBytes;
+		}
+
+		SPL::uint64 allocations;
+		SPL::uint64 frees;
+		SPL::uint64 bytesAllocated;
+		SPL::uint64 currentBytes;
+		SPL::uint64 peakBytes;
+	};
+
+	/*
+	 * rapidjson base allocator on malloc that counts its allocations. Free is static
+	 * in the allocator concept, so each block starts with a header that holds its size
+	 * and statistics. An allocator without statistics does not count.
+	 */
+	class CountingAllocator {
+
+	public:
+		static const bool kNeedFree = true;
+
+		CountingAllocator(AllocationStats * stats = NULL) : stats(stats) {}
+
+		void * Malloc(size_t size) {
+			if(!size)
+				return NULL;
+
+			Header * header = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+			if(!header)
+				return NULL;
+
+			header->size = size;
+			header->stats = stats;
+			if(stats)
+				stats->add(size);
+			return header + 1;
+		}
+
+		void * Realloc(void * originalPtr, size_t originalSize, size_t newSize) {
+			(void)originalSize;
+			if(!originalPtr)
+				return Malloc(newSize);
+			if(!newSize) {
+				Free(originalPtr);
+				return NULL;
+			}
+
+			Header * header = static_cast<Header*>(originalPtr) - 1;
+			size_t oldSize = header->size;
+			header = static_cast<Header*>(std::realloc(header, sizeof(Header) + newSize));
+			if(!header)
+				return NULL;
+
+			header->size = newSize;
+			if(header->stats) {
+				header->stats->remove(oldSize);
+				header->stats->add(newSize);
+			}
+			return header + 1;
+		}
+
+		static void Free(void * ptr) {
+			if(!ptr)
+				return;
+
+			Header * header = static_cast<Header*>(ptr) - 1;
+			if(header->stats)
+				header->stats->remove(header->size);
+			std::free(header);
+		}
+
+	private:
+		// two words keep the alignment of malloc for the block
+		struct Header {
+			size_t size;
+			AllocationStats * stats;
+		};
+
+		AllocationStats * stats;
+	};
+
+	typedef rapidjson::MemoryPoolAllocator<CountingAllocator> DocumentAllocator;
+}}}}
+
+#endif /* JSON_ALLOCATOR_H_ */
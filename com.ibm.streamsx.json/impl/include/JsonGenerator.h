@@ -0,0 +1,471 @@
+/*
+ * JsonGenerator.h
+ *
+ * Deterministic generator of JSON documents and their SPL tuple type, to benchmark
+ * and soak test the parsers and serializers with the shapes of production data.
+ *
+ * The generator is configured with a list of name=value pairs separated by commas,
+ * all names are optional:
+ *   seed               seed of the schema and documents (1)
+ *   width              attributes per tuple (8)
+ *   depth              levels of tuples, each level but the last has one nested tuple (1)
+ *   arrays             list attributes per tuple (1)
+ *   minArrayLength     shortest list (0)
+ *   maxArrayLength     longest list (10)
+ *   minStringLength    shortest string (1)
+ *   maxStringLength    longest string (32)
+ *   stringDistribution uniform or exponential, whose mean is a quarter of the range (uniform)
+ *   escapeRatio        fraction of the characters of a string that are escaped (0)
+ *   stringRatio        fraction of the scalar attributes that are rstring (0.4)
+ *   booleanRatio       fraction of the scalar attributes that are boolean (0.1)
+ *   numberTypes        types of the other scalar attributes and the list elements,
+ *                      separated by colons: int32, int64, uint64 and float64 (int64:float64)
+ *   optionalDensity    fraction of the attributes that are optional (0)
+ *   nullRatio          fraction of the values of optional attributes that are null (0.5)
+ *   keyOrder           order of the keys of an object: schema, reverse or random (schema)
+ *   unmatchedKeyRatio  keys without attribute per object, relative to the width (0)
+ *
+ * The schema depends on the configuration only, the documents on the configuration
+ * and the number of documents generated before, so a seed reproduces the workload
+ * on any host.
+ */
+
+#ifndef JSON_GENERATOR_H_
+#define JSON_GENERATOR_H_
+
+#include "JsonHandles.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <streams_boost/lexical_cast.hpp>
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+
+
+namespace com { namespace ibm { namespace streamsx { namespace json {
+
+	/*
+	 * splitmix64, the same sequence on every platform unlike the generators of the C library
+	 */
+	class WorkloadRandom {
+
+	public:
+		WorkloadRandom(SPL::uint64 seed) : state(seed) {}
+
+		SPL::uint64 next() {
+			SPL::uint64 z = (state += 0x9e3779b97f4a7c15ULL);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			return z ^ (z >> 31);
+		}
+
+		/* in [0, 1) */
+		double uniform() {
+			return (next() >> 11) * (1.0 / 9007199254740992.0);
+		}
+
+		/* in [min, max] */
+		SPL::uint64 between(SPL::uint64 min, SPL::uint64 max) {
+			return max <= min ? min : min + next() % (max - min + 1);
+		}
+
+		bool chance(double ratio) {
+			return uniform() < ratio;
+		}
+
+	private:
+		SPL::uint64 state;
+	};
+
+	struct WorkloadConfig {
+
+		WorkloadConfig() : seed(1), width(8), depth(1), arrays(1), minArrayLength(0), maxArrayLength(10),
+			minStringLength(1), maxStringLength(32), exponentialStrings(false), escapeRatio(0), stringRatio(0.4),
+			booleanRatio(0.1), optionalDensity(0), nullRatio(0.5), keyOrder(SCHEMA_ORDER), unmatchedKeyRatio(0) {
+			numberTypes.push_back(INT64);
+			numberTypes.push_back(FLOAT64);
+		}
+
+		enum Type { BOOLEAN, INT32, INT64, UINT64, FLOAT64, RSTRING, LIST, TUPLE };
+		enum KeyOrder { SCHEMA_ORDER, REVERSE_ORDER, RANDOM_ORDER };
+
+		/* name=value pairs separated by commas, see above */
+		static WorkloadConfig parse(std::string const& text) {
+			WorkloadConfig config;
+			std::string::size_type begin = 0;
+			while(begin < text.size()) {
+				std::string::size_type end = text.find(',', begin);
+				if(end == std::string::npos)
+					end = text.size();
+				std::string pair = text.substr(begin, end - begin);
+				begin = end + 1;
+				if(pair.empty())
+					continue;
+
+				std::string::size_type equals = pair.find('=');
+				if(equals == std::string::npos)
+					THROW(SPL::SPLRuntimeOperator, "Invalid JSON generator configuration '" << pair << "', name=value expected.");
+				config.set(pair.substr(0, equals), pair.substr(equals + 1));
+			}
+
+			if(config.width == 0 || config.depth == 0 || config.minArrayLength > config.maxArrayLength || config.minStringLength > config.maxStringLength)
+				THROW(SPL::SPLRuntimeOperator, "Invalid JSON generator configuration '" << text << "', width and depth must be positive and the minimum lengths at most the maximum.");
+			return config;
+		}
+
+		SPL::uint64 seed;
+		SPL::uint32 width;
+		SPL::uint32 depth;
+		SPL::uint32 arrays;
+		SPL::uint32 minArrayLength;
+		SPL::uint32 maxArrayLength;
+		SPL::uint32 minStringLength;
+		SPL::uint32 maxStringLength;
+		bool exponentialStrings;
+		double escapeRatio;
+		double stringRatio;
+		double booleanRatio;
+		std::vector<Type> numberTypes;
+		double optionalDensity;
+		double nullRatio;
+		KeyOrder keyOrder;
+		double unmatchedKeyRatio;
+
+	private:
+		void set(std::string const& name, std::string const& value) {
+			try {
+				if(name == "seed") seed = streams_boost::lexical_cast<SPL::uint64>(value);
+				else if(name == "width") width = streams_boost::lexical_cast<SPL::uint32>(value);
+				else if(name == "depth") depth = streams_boost::lexical_cast<SPL::uint32>(value);
+				else if(name == "arrays") arrays = streams_boost::lexical_cast<SPL::uint32>(value);
+				else if(name == "minArrayLength") minArrayLength = streams_boost::lexical_cast<SPL::uint32>(value);
+				else if(name == "maxArrayLength") maxArrayLength = streams_boost::lexical_cast<SPL::uint32>(value);
+				else if(name == "minStringLength") minStringLength = streams_boost::lexical_cast<SPL::uint32>(value);
+				else if(name == "maxStringLength") maxStringLength = streams_boost::lexical_cast<SPL::uint32>(value);
+				else if(name == "escapeRatio") escapeRatio = streams_boost::lexical_cast<double>(value);
+				else if(name == "stringRatio") stringRatio = streams_boost::lexical_cast<double>(value);
+				else if(name == "booleanRatio") booleanRatio = streams_boost::lexical_cast<double>(value);
+				else if(name == "optionalDensity") optionalDensity = streams_boost::lexical_cast<double>(value);
+				else if(name == "nullRatio") nullRatio = streams_boost::lexical_cast<double>(value);
+				else if(name == "unmatchedKeyRatio") unmatchedKeyRatio = streams_boost::lexical_cast<double>(value);
+				else if(name == "stringDistribution" && (value == "uniform" || value == "exponential")) exponentialStrings = value == "exponential";
+				else if(name == "keyOrder" && value == "schema") keyOrder = SCHEMA_ORDER;
+				else if(name == "keyOrder" && value == "reverse") keyOrder = REVERSE_ORDER;
+				else if(name == "keyOrder" && value == "random") keyOrder = RANDOM_ORDER;
+				else if(name == "numberTypes") setNumberTypes(value);
+				else
+					THROW(SPL::SPLRuntimeOperator, "Invalid JSON generator configuration '" << name << "=" << value << "'.");
+			}
+			catch(streams_boost::bad_lexical_cast const&) {
+				THROW(SPL::SPLRuntimeOperator, "Invalid JSON generator configuration '" << name << "=" << value << "', number expected.");
+			}
+		}
+
+		void setNumberTypes(std::string const& value) {
+			numberTypes.clear();
+			std::string::size_type begin = 0;
+			while(begin <= value.size()) {
+				std::string::size_type end = std::min(value.find(':', begin), value.size());
+				std::string type = value.substr(begin, end - begin);
+				begin = end + 1;
+
+				if(type == "int32") numberTypes.push_back(INT32);
+				else if(type == "int64") numberTypes.push_back(INT64);
+				else if(type == "uint64") numberTypes.push_back(UINT64);
+				else if(type == "float64") numberTypes.push_back(FLOAT64);
+				else
+					THROW(SPL::SPLRuntimeOperator, "Invalid JSON generator number type '" << type << "'.");
+			}
+		}
+	};
+
+	/*
+	 * Generates the documents of one configuration. A generator must not be used
+	 * by more than one thread at the same time.
+	 */
+	class WorkloadGenerator {
+
+	public:
+		WorkloadGenerator(WorkloadConfig const& config) : config(config), random(config.seed ^ 0x5deece66dULL) {
+			WorkloadRandom schemaRandom(config.seed);
+			createTuple(root, 1, schemaRandom);
+		}
+
+		/* SPL type of the documents, e.g. tuple<int64 f0, optional<rstring> f1, list<float64> f2> */
+		std::string getSplType() const {
+			std::string type;
+			appendType(type, root);
+			return type;
+		}
+
+		std::string next() {
+			buffer.Clear();
+			Writer writer(buffer);
+			writeTuple(writer, root);
+			return std::string(buffer.GetString(), buffer.GetSize());
+		}
+
+	private:
+		typedef rapidjson::Writer<rapidjson::StringBuffer> Writer;
+
+		struct Field {
+			std::string name;
+			WorkloadConfig::Type type;
+			WorkloadConfig::Type elementType;
+			bool optional;
+			std::vector<Field> fields;
+		};
+
+		void createTuple(Field & tuple, SPL::uint32 level, WorkloadRandom & schemaRandom) {
+			tuple.type = WorkloadConfig::TUPLE;
+			tuple.optional = false;
+			tuple.fields.resize(config.width);
+
+			SPL::uint32 nested = level < config.depth ? 1 : 0;
+			for(SPL::uint32 i = 0; i < config.width; i++) {
+				Field & field = tuple.fields[i];
+				field.name = "f" + streams_boost::lexical_cast<std::string>(i);
+				field.optional = schemaRandom.chance(config.optionalDensity);
+				if(i < nested) {
+					createTuple(field, level + 1, schemaRandom);
+					field.optional = false;
+				}
+				else if(i < nested + config.arrays) {
+					field.type = WorkloadConfig::LIST;
+					field.elementType = scalarType(schemaRandom, false);
+				}
+				else {
+					field.type = scalarType(schemaRandom, true);
+				}
+			}
+		}
+
+		WorkloadConfig::Type scalarType(WorkloadRandom & schemaRandom, bool withStrings) {
+			double r = schemaRandom.uniform();
+			if(withStrings && r < config.stringRatio)
+				return WorkloadConfig::RSTRING;
+			if(withStrings && r < config.stringRatio + config.booleanRatio)
+				return WorkloadConfig::BOOLEAN;
+			if(config.numberTypes.empty())
+				return WorkloadConfig::RSTRING;
+			return config.numberTypes[schemaRandom.next() % config.numberTypes.size()];
+		}
+
+		static const char * typeName(WorkloadConfig::Type type) {
+			switch(type) {
+				case WorkloadConfig::BOOLEAN : return "boolean";
+				case WorkloadConfig::INT32 : return "int32";
+				case WorkloadConfig::INT64 : return "int64";
+				case WorkloadConfig::UINT64 : return "uint64";
+				case WorkloadConfig::FLOAT64 : return "float64";
+				default : return "rstring";
+			}
+		}
+
+		static void appendType(std::string & type, Field const& field) {
+			if(field.optional)
+				type += "optional<";
+
+			if(field.type == WorkloadConfig::TUPLE) {
+				type += "tuple<";
+				for(size_t i = 0; i < field.fields.size(); i++) {
+					if(i)
+						type += ", ";
+					appendType(type, field.fields[i]);
+					type += " " + field.fields[i].name;
+				}
+				type += ">";
+			}
+			else if(field.type == WorkloadConfig::LIST) {
+				type += std::string("list<") + typeName(field.elementType) + ">";
+			}
+			else {
+				type += typeName(field.type);
+			}
+
+			if(field.optional)
+				type += ">";
+		}
+
+		void writeTuple(Writer & writer, Field const& tuple) {
+			// indexes of the fields, unmatched keys are negative
+			order.clear();
+			for(size_t i = 0; i < tuple.fields.size(); i++)
+				order.push_back(static_cast<int>(i));
+			if(config.keyOrder == WorkloadConfig::REVERSE_ORDER)
+				std::reverse(order.begin(), order.end());
+
+			double unmatched = config.unmatchedKeyRatio * tuple.fields.size();
+			int unmatchedKeys = static_cast<int>(unmatched) + (random.chance(unmatched - std::floor(unmatched)) ? 1 : 0);
+			for(int i = 0; i < unmatchedKeys; i++)
+				order.insert(order.begin() + random.between(0, order.size()), -1 - i);
+
+			if(config.keyOrder == WorkloadConfig::RANDOM_ORDER) {
+				for(size_t i = order.size(); i > 1; i--)
+					std::swap(order[i - 1], order[random.next() % i]);
+			}
+
+			// copied, the nested tuples reuse the buffer
+			std::vector<int> keys(order);
+			writer.StartObject();
+			for(size_t i = 0; i < keys.size(); i++) {
+				if(keys[i] < 0) {
+					std::string key = "x" + streams_boost::lexical_cast<std::string>(-1 - keys[i]);
+					writer.Key(key.c_str(), key.size());
+					writeUnmatched(writer);
+					continue;
+				}
+
+				Field const& field = tuple.fields[keys[i]];
+				writer.Key(field.name.c_str(), field.name.size());
+				if(field.optional && random.chance(config.nullRatio))
+					writer.Null();
+				else if(field.type == WorkloadConfig::TUPLE)
+					writeTuple(writer, field);
+				else if(field.type == WorkloadConfig::LIST)
+					writeList(writer, field.elementType);
+				else
+					writeScalar(writer, field.type);
+			}
+			writer.EndObject();
+		}
+
+		void writeList(Writer & writer, WorkloadConfig::Type elementType) {
+			SPL::uint64 length = random.between(config.minArrayLength, config.maxArrayLength);
+			writer.StartArray();
+			for(SPL::uint64 i = 0; i < length; i++)
+				writeScalar(writer, elementType);
+			writer.EndArray();
+		}
+
+		/* scalars mostly, objects and arrays to skip sometimes */
+		void writeUnmatched(Writer & writer) {
+			double r = random.uniform();
+			if(r < 0.1) {
+				writer.StartObject();
+				writer.Key("id");
+				writeScalar(writer, WorkloadConfig::INT64);
+				writer.Key("name");
+				writeScalar(writer, WorkloadConfig::RSTRING);
+				writer.EndObject();
+			}
+			else if(r < 0.2) {
+				writeList(writer, WorkloadConfig::FLOAT64);
+			}
+			else {
+				writeScalar(writer, r < 0.6 ? WorkloadConfig::RSTRING : WorkloadConfig::INT64);
+			}
+		}
+
+		/* numbers with a uniformly distributed number of digits */
+		void writeScalar(Writer & writer, WorkloadConfig::Type type) {
+			switch(type) {
+				case WorkloadConfig::BOOLEAN :
+					writer.Bool(random.chance(0.5));
+					break;
+				case WorkloadConfig::INT32 :
+					writer.Int(static_cast<int>(signedNumber(9)));
+					break;
+				case WorkloadConfig::INT64 :
+					writer.Int64(signedNumber(18));
+					break;
+				case WorkloadConfig::UINT64 :
+					writer.Uint64(random.between(0, power(random.between(1, 19)) - 1));
+					break;
+				case WorkloadConfig::FLOAT64 :
+					writer.Double(random.uniform() * std::pow(10.0, static_cast<double>(random.between(0, 12)) - 6));
+					break;
+				default :
+					writeString(writer);
+			}
+		}
+
+		SPL::int64 signedNumber(SPL::uint64 maxDigits) {
+			SPL::int64 value = static_cast<SPL::int64>(random.between(0, power(random.between(1, maxDigits)) - 1));
+			return random.chance(0.5) ? -value : value;
+		}
+
+		static SPL::uint64 power(SPL::uint64 digits) {
+			SPL::uint64 value = 1;
+			for(SPL::uint64 i = 0; i < digits; i++)
+				value *= 10;
+			// 10^20 overflows, 10^19 - 1 is below the maximum of uint64
+			return digits < 20 ? value : ~0ULL;
+		}
+
+		void writeString(Writer & writer) {
+			static const char chars[] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+			static const char escaped[] = "\"\\\n\t";
+
+			SPL::uint64 length;
+			if(config.exponentialStrings) {
+				double mean = (config.maxStringLength - config.minStringLength) / 4.0;
+				length = config.minStringLength + static_cast<SPL::uint64>(-mean * std::log(1.0 - random.uniform()));
+				length = std::min(length, static_cast<SPL::uint64>(config.maxStringLength));
+			}
+			else {
+				length = random.between(config.minStringLength, config.maxStringLength);
+			}
+
+			text.resize(length);
+			for(SPL::uint64 i = 0; i < length; i++) {
+				if(config.escapeRatio > 0 && random.chance(config.escapeRatio))
+					text[i] = escaped[random.next() % (sizeof(escaped) - 1)];
+				else
+					text[i] = chars[random.next() % (sizeof(chars) - 1)];
+			}
+			writer.String(text.data(), static_cast<rapidjson::SizeType>(text.size()));
+		}
+
+		WorkloadConfig config;
+		WorkloadRandom random;
+		Field root;
+		rapidjson::StringBuffer buffer;
+		std::vector<int> order;
+		std::string text;
+	};
+
+	namespace {
+
+		/*
+		 * A generator handle refers to a generator of the handle table of the processing
+		 * element, and is checked like a context handle.
+		 */
+		inline WorkloadGenerator& getGenerator(SPL::uint64 generator) {
+
+			WorkloadGenerator * generatorPtr = HandleTable<WorkloadGenerator>::instance().get(generator);
+			if(!generatorPtr)
+				THROW(SPL::SPLRuntimeOperator, "Invalid JSON generator, 'createJSONGenerator' function must be used before.");
+
+			return *generatorPtr;
+		}
+
+		inline SPL::uint64 createJSONGenerator(SPL::rstring const& config) {
+			SPL::uint64 generator = HandleTable<WorkloadGenerator>::instance().add(new WorkloadGenerator(WorkloadConfig::parse(config)));
+			if(!generator)
+				THROW(SPL::SPLRuntimeOperator, "Too many JSON generators, 'releaseJSONGenerator' function must be used to release them.");
+
+			return generator;
+		}
+
+		inline void releaseJSONGenerator(SPL::uint64 generator) {
+			if(!HandleTable<WorkloadGenerator>::instance().release(generator))
+				THROW(SPL::SPLRuntimeOperator, "Invalid JSON generator, 'createJSONGenerator' function must be used before.");
+		}
+
+		inline SPL::rstring generateJSON(SPL::uint64 generator) {
+			return getGenerator(generator).next();
+		}
+
+		inline SPL::rstring getJSONGeneratorType(SPL::uint64 generator) {
+			return getGenerator(generator).getSplType();
+		}
+	}
+}}}}
+
+#endif /* JSON_GENERATOR_H_ */
@@ -0,0 +1,159 @@
+/*
+ * JsonHandles.h
+ *
+ * Table of the objects the SPL functions pass as uint64 handles, the JSON contexts
+ * and generators. The table of a type is shared by the operators of the processing
+ * element and deletes the objects still registered when the processing element shuts down.
+ *
+ * A handle is the slot index plus one in the low 32 bits and the generation of the slot
+ * in the high 32 bits. The generation is incremented when the object is released, so the
+ * handle of a released object, an uninitialized handle (0) and a handle restored from a
+ * checkpoint of another processing element do not find an object. The generations of a
+ * table start at a random value for the latter.
+ *
+ * Slots are allocated in chunks that are never moved, so a lookup takes no lock. Adding and
+ * releasing take the lock of the table; an object must not be released while it is used.
+ * The chunk pointers and the objects and generations of the slots are written with release
+ * stores and read with acquire loads (the GCC atomic builtins, the toolkit is C++98), so a
+ * lookup sees an initialized chunk and the object of a handle once it sees the handle valid.
+ */
+
+#ifndef JSON_HANDLES_H_
+#define JSON_HANDLES_H_
+
+#include <ctime>
+#include <vector>
+#include <unistd.h>
+#include <streams_boost/thread/mutex.hpp>
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+
+
+namespace com { namespace ibm { namespace streamsx { namespace json {
+
+	template<typename T>
+	class HandleTable {
+
+	public:
+		enum { CHUNK_SIZE = 256, MAX_CHUNKS = 4096 };
+
+		static HandleTable & instance() {
+			static HandleTable table;
+			return table;
+		}
+
+		~HandleTable() {
+			for(size_t chunk = 0; chunk < MAX_CHUNKS && chunks[chunk]; chunk++) {
+				for(size_t slot = 0; slot < CHUNK_SIZE; slot++)
+					delete chunks[chunk][slot].object;
+				delete[] chunks[chunk];
+			}
+		}
+
+		/* takes the ownership of the object, returns 0 if the table is full */
+		SPL::uint64 add(T * object) {
+			streams_boost::mutex::scoped_lock lock(mutex);
+
+			uint32_t index;
+			if(!freeSlots.empty()) {
+				index = freeSlots.back();
+				freeSlots.pop_back();
+			}
+			else if(size < CHUNK_SIZE * MAX_CHUNKS) {
+				index = size++;
+				if(!chunks[index / CHUNK_SIZE]) {
+					Slot * chunk = new Slot[CHUNK_SIZE];
+					for(size_t slot = 0; slot < CHUNK_SIZE; slot++) {
+						chunk[slot].object = NULL;
+						chunk[slot].generation = generationBase + static_cast<uint32_t>(slot);
+					}
+					store(chunks[index / CHUNK_SIZE], chunk);
+				}
+			}
+			else {
+				delete object;
+				return 0;
+			}
+
+			Slot & slot = chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+			store(slot.object, object);
+			return (static_cast<SPL::uint64>(slot.generation) << 32) | (index + 1);
+		}
+
+		/* object of a handle, NULL if the handle is invalid or released */
+		T * get(SPL::uint64 handle) const {
+			Slot const* slot = find(handle);
+			if(!slot)
+				return NULL;
+
+			/* the slot may have been released and reused since find checked the generation */
+			T * object = load(slot->object);
+			return load(slot->generation) == static_cast<uint32_t>(handle >> 32) ? object : NULL;
+		}
+
+		/* deletes the object of a handle, returns false if the handle is invalid or released */
+		bool release(SPL::uint64 handle) {
+			T * object;
+			{
+				streams_boost::mutex::scoped_lock lock(mutex);
+
+				Slot * slot = const_cast<Slot*>(find(handle));
+				if(!slot || !slot->object)
+					return false;
+
+				object = slot->object;
+				store(slot->object, static_cast<T*>(NULL));
+				store(slot->generation, slot->generation + 1);
+				freeSlots.push_back(static_cast<uint32_t>(handle) - 1);
+			}
+			delete object;
+			return true;
+		}
+
+	private:
+		struct Slot {
+			T * object;
+			uint32_t generation;
+		};
+
+		HandleTable() : size(0), generationBase(static_cast<uint32_t>(time(NULL)) ^ (static_cast<uint32_t>(getpid()) << 16)) {
+			for(size_t chunk = 0; chunk < MAX_CHUNKS; chunk++)
+				chunks[chunk] = NULL;
+		}
+
+		HandleTable(HandleTable const&);
+		HandleTable & operator=(HandleTable const&);
+
+		Slot const* find(SPL::uint64 handle) const {
+			uint32_t index = static_cast<uint32_t>(handle) - 1;
+			if(index >= CHUNK_SIZE * MAX_CHUNKS)
+				return NULL;
+
+			Slot const* chunk = load(chunks[index / CHUNK_SIZE]);
+			if(!chunk)
+				return NULL;
+
+			Slot const& slot = chunk[index % CHUNK_SIZE];
+			return load(slot.generation) == static_cast<uint32_t>(handle >> 32) ? &slot : NULL;
+		}
+
+		template<typename V>
+		static V load(V const& value) {
+			return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+		}
+
+		template<typename V>
+		static void store(V & value, V newValue) {
+			__atomic_store_n(&value, newValue, __ATOMIC_RELEASE);
+		}
+
+		Slot * chunks[MAX_CHUNKS];
+		uint32_t size;
+		uint32_t generationBase;
+		std::vector<uint32_t> freeSlots;
+		streams_boost::mutex mutex;
+	};
+}}}}
+
+#endif /* JSON_HANDLES_H_ */
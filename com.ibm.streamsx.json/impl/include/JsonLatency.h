@@ -0,0 +1,264 @@
+/*
+ * JsonLatency.h
+ *
+ * Latency histograms and the slowest documents of the native functions and
+ * operators, to find the documents that cause the tail latency the averages
+ * of the metrics hide.
+ *
+ * A histogram counts the calls in buckets by the power of two of their time in
+ * nanoseconds, so recording a call is a bit scan and a few increments. A document
+ * is only copied when it took longer than the fastest of the slowest documents
+ * kept, which becomes rare once the buffer is filled.
+ */
+
+#ifndef JSON_LATENCY_H_
+#define JSON_LATENCY_H_
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+#include <streams_boost/lexical_cast.hpp>
+#include <streams_boost/thread/mutex.hpp>
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+
+
+namespace com { namespace ibm { namespace streamsx { namespace json {
+
+	typedef rapidjson::Writer<rapidjson::StringBuffer> LatencyWriter;
+
+	/*
+	 * Bucket 0 counts the calls that took 0 ns, bucket i > 0 the calls
+	 * that took from 2^(i-1) to 2^i - 1 ns.
+	 */
+	class LatencyHistogram {
+
+	public:
+		enum { BUCKET_COUNT = 65 };
+
+		LatencyHistogram() : count(0), totalNanos(0), maxNanos(0) {
+			std::fill(counts, counts + BUCKET_COUNT, 0);
+		}
+
+		static int bucket(SPL::uint64 nanos) {
+			return nanos ? 64 - __builtin_clzll(nanos) : 0;
+		}
+
+		static SPL::uint64 upperBound(int bucket) {
+			return bucket < 64 ? (1ULL << bucket) - 1 : ~0ULL;
+		}
+
+		void add(SPL::uint64 nanos) {
+			counts[bucket(nanos)]++;
+			count++;
+			totalNanos += nanos;
+			if(nanos > maxNanos)
+				maxNanos = nanos;
+		}
+
+		/* upper bound of the bucket that contains the percentile (nearest rank), at most the maximum */
+		SPL::uint64 percentile(double fraction) const {
+			SPL::uint64 rank = static_cast<SPL::uint64>(std::ceil(fraction * count));
+			SPL::uint64 seen = 0;
+			for(int i = 0; i < BUCKET_COUNT; i++) {
+				seen += counts[i];
+				if(seen && seen >= rank)
+					return std::min(upperBound(i), maxNanos);
+			}
+			return maxNanos;
+		}
+
+		/* totals, percentiles and the non-empty buckets by upper bound */
+		void write(LatencyWriter & writer) const {
+			writer.Key("count"); writer.Uint64(count);
+			writer.Key("totalNanos"); writer.Uint64(totalNanos);
+			writer.Key("maxNanos"); writer.Uint64(maxNanos);
+			writer.Key("p50Nanos"); writer.Uint64(percentile(0.5));
+			writer.Key("p90Nanos"); writer.Uint64(percentile(0.9));
+			writer.Key("p99Nanos"); writer.Uint64(percentile(0.99));
+			writer.Key("p999Nanos"); writer.Uint64(percentile(0.999));
+
+			writer.Key("buckets");
+			writer.StartObject();
+			for(int i = 0; i < BUCKET_COUNT; i++) {
+				if(counts[i]) {
+					std::string bound = streams_boost::lexical_cast<std::string>(upperBound(i));
+					writer.Key(bound.c_str(), bound.size());
+					writer.Uint64(counts[i]);
+				}
+			}
+			writer.EndObject();
+		}
+
+	private:
+		SPL::uint64 counts[BUCKET_COUNT];
+		SPL::uint64 count;
+		SPL::uint64 totalNanos;
+		SPL::uint64 maxNanos;
+	};
+
+	/*
+	 * Bounded buffer of the slowest documents with their size and first bytes,
+	 * a slower document replaces the fastest one kept.
+	 */
+	class SlowDocuments {
+
+	public:
+		enum { HEAD_LENGTH = 256 };
+
+		struct Document {
+			SPL::uint64 nanos;
+			SPL::uint64 size;
+			std::string head;
+
+			bool operator<(Document const& other) const {
+				return nanos > other.nanos;
+			}
+		};
+
+		SlowDocuments(size_t capacity) : capacity(capacity), fastest(0) {}
+
+		bool isSlow(SPL::uint64 nanos) const {
+			return documents.size() < capacity || (capacity && nanos > documents[fastest].nanos);
+		}
+
+		void add(SPL::uint64 nanos, const char * data, size_t size) {
+			Document document = { nanos, size, std::string(data, std::min(size, static_cast<size_t>(HEAD_LENGTH))) };
+			if(documents.size() < capacity)
+				documents.push_back(document);
+			else
+				documents[fastest] = document;
+
+			if(documents.size() == capacity) {
+				fastest = 0;
+				for(size_t i = 1; i < documents.size(); i++) {
+					if(documents[i].nanos < documents[fastest].nanos)
+						fastest = i;
+				}
+			}
+		}
+
+		/* slowest first */
+		void write(LatencyWriter & writer) const {
+			std::vector<Document> sorted(documents);
+			std::sort(sorted.begin(), sorted.end());
+
+			writer.StartArray();
+			for(size_t i = 0; i < sorted.size(); i++) {
+				writer.StartObject();
+				writer.Key("nanos"); writer.Uint64(sorted[i].nanos);
+				writer.Key("size"); writer.Uint64(sorted[i].size);
+				writer.Key("head"); writer.String(sorted[i].head.c_str(), sorted[i].head.size());
+				writer.EndObject();
+			}
+			writer.EndArray();
+		}
+
+	private:
+		size_t capacity;
+		size_t fastest;
+		std::vector<Document> documents;
+	};
+
+	/*
+	 * Histogram and slowest documents of one function or operator. Only the owning
+	 * thread adds documents, the histogram is read without lock by the dump of
+	 * another thread, so a dump may miss the documents added meanwhile.
+	 */
+	class LatencyProfile {
+
+	public:
+		LatencyProfile(size_t slowDocuments) : slowest(slowDocuments) {}
+
+		void add(SPL::uint64 nanos, const char * data, size_t size) {
+			histogram.add(nanos);
+			if(slowest.isSlow(nanos)) {
+				streams_boost::mutex::scoped_lock lock(mutex);
+				slowest.add(nanos, data, size);
+			}
+		}
+
+		void write(LatencyWriter & writer) {
+			writer.StartObject();
+			histogram.write(writer);
+			writer.Key("slowest");
+			{
+				streams_boost::mutex::scoped_lock lock(mutex);
+				slowest.write(writer);
+			}
+			writer.EndObject();
+		}
+
+		std::string toJSON() {
+			rapidjson::StringBuffer buffer;
+			LatencyWriter writer(buffer);
+			write(writer);
+			return std::string(buffer.GetString(), buffer.GetSize());
+		}
+
+	private:
+		LatencyHistogram histogram;
+		SlowDocuments slowest;
+		streams_boost::mutex mutex;
+	};
+
+	/*
+	 * Profiles of the operators in the processing element by operator name,
+	 * an operator registers its profile for its lifetime.
+	 */
+	class LatencyRegistry {
+
+	public:
+		static LatencyRegistry & instance() {
+			static LatencyRegistry registry;
+			return registry;
+		}
+
+		void add(std::string const& name, LatencyProfile * profile) {
+			streams_boost::mutex::scoped_lock lock(mutex);
+			profiles[name] = profile;
+		}
+
+		void remove(LatencyProfile * profile) {
+			streams_boost::mutex::scoped_lock lock(mutex);
+			for(std::map<std::string, LatencyProfile*>::iterator it = profiles.begin(); it != profiles.end(); ++it) {
+				if(it->second == profile) {
+					profiles.erase(it);
+					return;
+				}
+			}
+		}
+
+		void write(LatencyWriter & writer) {
+			streams_boost::mutex::scoped_lock lock(mutex);
+			writer.StartObject();
+			for(std::map<std::string, LatencyProfile*>::iterator it = profiles.begin(); it != profiles.end(); ++it) {
+				writer.Key(it->first.c_str(), it->first.size());
+				it->second->write(writer);
+			}
+			writer.EndObject();
+		}
+
+	private:
+		streams_boost::mutex mutex;
+		std::map<std::string, LatencyProfile*> profiles;
+	};
+
+	/*
+	 * Profiles of the native functions on one thread
+	 */
+	struct FunctionLatency {
+		FunctionLatency(size_t slowDocuments) : extractFromJSON(slowDocuments), parseJSON(slowDocuments) {}
+
+		LatencyProfile extractFromJSON;
+		LatencyProfile parseJSON;
+	};
+}}}}
+
+#endif /* JSON_LATENCY_H_ */
@@ -0,0 +1,168 @@
+/*
+ * JsonMetrics.h
+ *
+ * Statistics of the JSON documents parsed and serialized by the native functions
+ * and operators of the toolkit.
+ *
+ * The operators update custom metrics that are declared in their operator models.
+ * A JSON context of the native functions collects the statistics once they are
+ * enabled with enableJSONStatistics, getJSONStatistics returns them by metric name
+ * and the SPL function updateJSONMetrics sets them as custom metrics of the operator
+ * that owns the context.
+ */
+
+#ifndef JSON_METRICS_H_
+#define JSON_METRICS_H_
+
+#include "JsonAllocator.h"
+#include "JsonParseErrors.h"
+
+#include <string>
+#include <time.h>
+
+#include <SPL/Runtime/Common/Metric.h>
+#include <SPL/Runtime/Operator/OperatorMetrics.h>
+#include <SPL/Runtime/Type/SPLType.h>
+
+
+
+namespace com { namespace ibm { namespace streamsx { namespace json {
+
+	inline SPL::uint64 nanoTime() {
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return static_cast<SPL::uint64>(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+	}
+
+	/*
+	 * Statistics of a JSON context, collected when enabled
+	 */
+	struct JsonStatistics {
+
+		JsonStatistics() : enabled(false), documents(0), bytesIn(0), maxDocumentSize(0), parseTimeNanos(0), queries(0), queriesFound(0) {}
+
+		void addDocument(SPL::uint64 size, SPL::uint64 nanos) {
+			documents++;
+			bytesIn += size;
+			parseTimeNanos += nanos;
+			if(size > maxDocumentSize)
+				maxDocumentSize = size;
+		}
+
+		template<typename Status>
+		void addQuery(Status const& status) {
+			queries++;
+			// FOUND and FOUND_CAST
+			if(status == 0 || status == 1)
+				queriesFound++;
+		}
+
+		/* statistics by metric name, with the parse error counts by status */
+		SPL::map<SPL::rstring, SPL::uint64> toMap(ParseErrorLog const& parseErrors) const {
+			SPL::map<SPL::rstring, SPL::uint64> values;
+			values["nDocuments"] = documents;
+			values["nBytesIn"] = bytesIn;
+			values["maxDocumentSize"] = maxDocumentSize;
+			values["avgDocumentSize"] = documents ? bytesIn / documents : 0;
+			values["parseTimeNanos"] = parseTimeNanos;
+			values["nQueries"] = queries;
+			values["nQueriesFound"] = queriesFound;
+			values["nParseErrors"] = parseErrors.getTotal();
+			for(int i = 1; i < ParseErrorLog::STATUS_COUNT; i++) {
+				if(parseErrors.getCount(i))
+					values[std::string("nParseErrors_") + ParseErrorLog::statusName(i)] = parseErrors.getCount(i);
+			}
+			return values;
+		}
+
+		bool enabled;
+		SPL::uint64 documents;
+		SPL::uint64 bytesIn;
+		SPL::uint64 maxDocumentSize;
+		SPL::uint64 parseTimeNanos;
+		SPL::uint64 queries;
+		SPL::uint64 queriesFound;
+	};
+
+	/*
+	 * Custom metrics of an operator that converts documents, the operator holds
+	 * the port mutex while they are updated.
+	 */
+	class DocumentMetrics {
+
+	public:
+		DocumentMetrics(SPL::OperatorMetrics & metrics, const char * bytesName, const char * timeName) :
+			documents(metrics.getCustomMetricByName("nDocuments")),
+			bytes(metrics.getCustomMetricByName(bytesName)),
+			maxDocumentSize(metrics.getCustomMetricByName("maxDocumentSize")),
+			avgDocumentSize(metrics.getCustomMetricByName("avgDocumentSize")),
+			time(metrics.getCustomMetricByName(timeName)) {}
+
+		void addDocument(SPL::uint64 size, SPL::uint64 nanos) {
+			documents.incrementValueNoLock(1);
+			bytes.incrementValueNoLock(size);
+			time.incrementValueNoLock(nanos);
+			if(static_cast<SPL::int64>(size) > maxDocumentSize.getValueNoLock())
+				maxDocumentSize.setValueNoLock(size);
+			avgDocumentSize.setValueNoLock(bytes.getValueNoLock() / documents.getValueNoLock());
+		}
+
+	private:
+		SPL::Metric & documents;
+		SPL::Metric & bytes;
+		SPL::Metric & maxDocumentSize;
+		SPL::Metric & avgDocumentSize;
+		SPL::Metric & time;
+	};
+
+	/*
+	 * Metrics of an operator that parses documents, a metric per parse error
+	 * status is created when the first error with that status occurs.
+	 */
+	class ParseMetrics : public DocumentMetrics {
+
+	public:
+		ParseMetrics(SPL::OperatorMetrics & metrics) :
+			DocumentMetrics(metrics, "nBytesIn", "parseTimeNanos"),
+			metrics(metrics),
+			keysMatched(metrics.getCustomMetricByName("nKeysMatched")),
+			keysDropped(metrics.getCustomMetricByName("nKeysDropped")),
+			parseErrors(metrics.getCustomMetricByName("nParseErrors")),
+			readerStackBytes(metrics.getCustomMetricByName("readerStackBytes")),
+			readerStackPeakBytes(metrics.getCustomMetricByName("readerStackPeakBytes")) {
+			for(int i = 0; i < ParseErrorLog::STATUS_COUNT; i++)
+				statusErrors[i] = NULL;
+		}
+
+		void addKeys(SPL::uint64 matched, SPL::uint64 dropped) {
+			keysMatched.incrementValueNoLock(matched);
+			keysDropped.incrementValueNoLock(dropped);
+		}
+
+		void setReaderMemory(AllocationStats const& memory) {
+			readerStackBytes.setValueNoLock(memory.currentBytes);
+			readerStackPeakBytes.setValueNoLock(memory.peakBytes);
+		}
+
+		void addError(rapidjson::ParseErrorCode code) {
+			int status = static_cast<int>(code) < ParseErrorLog::STATUS_COUNT ? code : rapidjson::kParseErrorUnspecificSyntaxError;
+			parseErrors.incrementValueNoLock(1);
+			if(!statusErrors[status]) {
+				std::string name = std::string("nParseErrors_") + ParseErrorLog::statusName(status);
+				statusErrors[status] = &metrics.createCustomMetric(name, "Number of JSON strings with parse error " + std::string(ParseErrorLog::statusName(status)), SPL::Metric::Counter);
+			}
+			statusErrors[status]->incrementValueNoLock(1);
+		}
+
+	private:
+		SPL::OperatorMetrics & metrics;
+		SPL::Metric & keysMatched;
+		SPL::Metric & keysDropped;
+		SPL::Metric & parseErrors;
+		SPL::Metric & readerStackBytes;
+		SPL::Metric & readerStackPeakBytes;
+		SPL::Metric * statusErrors[ParseErrorLog::STATUS_COUNT];
+	};
+}}}}
+
+#endif /* JSON_METRICS_H_ */
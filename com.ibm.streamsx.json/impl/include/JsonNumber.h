@@ -0,0 +1,289 @@
+/*
+ * JsonNumber.h
+ *
+ * Conversion of JSON string values to SPL numeric and boolean types.
+ *
+ * The conversions don't use iostreams, don't depend on the locale and don't
+ * throw on invalid input, so quoted numbers can be converted at the same cost
+ * as rapidjson parses unquoted ones. Each function converts the whole string
+ * and returns false if it is no valid value of the target type or out of range,
+ * the result is not modified in that case.
+ */
+
+#ifndef JSON_NUMBER_H_
+#define JSON_NUMBER_H_
+
+#include "rapidjson/reader.h"
+
+#include <limits>
+#include <string>
+#include <streams_boost/lexical_cast.hpp>
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+
+
+namespace com { namespace ibm { namespace streamsx { namespace json {
+
+	/*
+	 * Integers are accepted with an optional sign and decimal digits only.
+	 * The magnitude is accumulated as uint64 and checked against the range
+	 * of the target type on each digit.
+	 */
+	template<typename T>
+	inline bool parseInteger(const char * s, rapidjson::SizeType length, T & result) {
+
+		const char * end = s + length;
+		bool negative = false;
+
+		if(s != end && (*s == '-' || *s == '+')) {
+			negative = (*s == '-');
+			s++;
+		}
+		if(s == end)
+			return false;
+
+		const uint64_t limit = negative ?
+				(std::numeric_limits<T>::is_signed ? static_cast<uint64_t>(std::numeric_limits<T>::max()) + 1 : 0) :
+				static_cast<uint64_t>(std::numeric_limits<T>::max());
+		uint64_t magnitude = 0;
+
+		for(; s != end; s++) {
+			unsigned digit = static_cast<unsigned char>(*s) - '0';
+			if(digit > 9 || digit > limit || magnitude > (limit - digit) / 10)
+				return false;
+			magnitude = magnitude * 10 + digit;
+		}
+
+		if(negative && magnitude)
+			result = static_cast<T>(-static_cast<T>(magnitude - 1) - 1);
+		else
+			result = static_cast<T>(magnitude);
+
+		return true;
+	}
+
+	/*
+	 * Collects the number as JSON Number event for the full precision fallback
+	 */
+	struct NumberHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, NumberHandler> {
+
+		NumberHandler() : number(0) {}
+
+		bool Default() { return false; }
+		bool Int(int i) { number = i; return true; }
+		bool Uint(unsigned u) { number = u; return true; }
+		bool Int64(int64_t i) { number = static_cast<double>(i); return true; }
+		bool Uint64(uint64_t u) { number = static_cast<double>(u); return true; }
+		bool Double(double d) { number = d; return true; }
+
+		double number;
+	};
+
+	inline bool matchesIgnoreCase(const char * s, const char * end, const char * lowerCase) {
+
+		for(; s != end && *lowerCase; s++, lowerCase++) {
+			if((*s | 0x20) != *lowerCase)
+				return false;
+		}
+		return s == end && !*lowerCase;
+	}
+
+	/*
+	 * Floating point numbers are accepted with an optional sign, integer and/or fraction
+	 * digits and an optional exponent, as well as nan, inf and infinity.
+	 *
+	 * Numbers with up to 19 significant digits, a mantissa below 2^53 and a decimal
+	 * exponent within +/-22 are exact with a single multiplication or division
+	 * (Clinger's fast path). All other numbers are written in JSON number syntax and
+	 * converted by the rapidjson reader with full precision.
+	 */
+	inline bool parseDouble(const char * s, rapidjson::SizeType length, double & result) {
+
+		static const double pow10[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+		const char * end = s + length;
+		bool negative = false;
+
+		if(s != end && (*s == '-' || *s == '+')) {
+			negative = (*s == '-');
+			s++;
+		}
+
+		if(s != end && (*s | 0x20) >= 'a') {
+			if(matchesIgnoreCase(s, end, "nan"))
+				result = std::numeric_limits<double>::quiet_NaN();
+			else if(matchesIgnoreCase(s, end, "inf") || matchesIgnoreCase(s, end, "infinity"))
+				result = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+			else
+				return false;
+
+			return true;
+		}
+
+		// skip leading zeros, they are neither significant nor allowed by the JSON number syntax
+		const char * digits = s;
+		while(s != end && *s == '0')
+			s++;
+
+		const char * significant = s;
+		uint64_t mantissa = 0;
+		int significantCount = 0;
+		int fractionCount = 0;
+		bool hasDigits = (s != digits);
+
+		for(; s != end && static_cast<unsigned>(*s - '0') <= 9; s++, hasDigits = true) {
+			if(significantCount < 19)
+				mantissa = mantissa * 10 + (*s - '0');
+			significantCount++;
+		}
+
+		const char * integerEnd = s;
+		const char * fraction = s;
+		const char * fractionEnd = s;
+
+		if(s != end && *s == '.') {
+			fraction = ++s;
+			for(; s != end && static_cast<unsigned>(*s - '0') <= 9; s++, hasDigits = true) {
+				fractionCount++;
+				if(significantCount || *s != '0') {
+					if(significantCount < 19)
+						mantissa = mantissa * 10 + (*s - '0');
+					significantCount++;
+				}
+			}
+			fractionEnd = s;
+		}
+
+		if(!hasDigits)
+			return false;
+
+		int exponent = 0;
+		if(s != end && (*s | 0x20) == 'e') {
+			s++;
+			bool negativeExponent = false;
+			if(s != end && (*s == '-' || *s == '+')) {
+				negativeExponent = (*s == '-');
+				s++;
+			}
+			if(s == end)
+				return false;
+			for(; s != end && static_cast<unsigned>(*s - '0') <= 9; s++) {
+				if(exponent < 100000)
+					exponent = exponent * 10 + (*s - '0');
+			}
+			if(negativeExponent)
+				exponent = -exponent;
+		}
+
+		if(s != end)
+			return false;
+
+		if(!mantissa) {
+			result = negative ? -0.0 : 0.0;
+			return true;
+		}
+
+		exponent -= fractionCount;
+
+		if(significantCount <= 19 && mantissa <= (static_cast<uint64_t>(1) << 53) && exponent >= -22 && exponent <= 22) {
+			double d = static_cast<double>(mantissa);
+			d = exponent < 0 ? d / pow10[-exponent] : d * pow10[exponent];
+			result = negative ? -d : d;
+			return true;
+		}
+
+		// <sign><integer and fraction digits without leading zeros>e<exponent>
+		std::string number;
+		number.reserve((end - digits) + 16);
+		if(negative)
+			number += '-';
+		number.append(significant, integerEnd);
+
+		const char * f = fraction;
+		if(significant == integerEnd) {
+			while(f != fractionEnd && *f == '0')
+				f++;
+		}
+		number.append(f, fractionEnd);
+
+		number += 'e';
+		number += streams_boost::lexical_cast<std::string>(exponent);
+
+		NumberHandler handler;
+		rapidjson::Reader reader;
+		rapidjson::StringStream numberStream(number.c_str());
+
+		if(reader.Parse<rapidjson::kParseFullPrecisionFlag>(numberStream, handler).IsError())
+			return false;
+
+		result = handler.number;
+		return true;
+	}
+
+	inline bool parseString(const char * s, rapidjson::SizeType length, SPL::int8 & result) { return parseInteger(s, length, result); }
+	inline bool parseString(const char * s, rapidjson::SizeType length, SPL::int16 & result) { return parseInteger(s, length, result); }
+	inline bool parseString(const char * s, rapidjson::SizeType length, SPL::int32 & result) { return parseInteger(s, length, result); }
+	inline bool parseString(const char * s, rapidjson::SizeType length, SPL::int64 & result) { return parseInteger(s, length, result); }
+	inline bool parseString(const char * s, rapidjson::SizeType length, SPL::uint8 & result) { return parseInteger(s, length, result); }
+	inline bool parseString(const char * s, rapidjson::SizeType length, SPL::uint16 & result) { return parseInteger(s, length, result); }
+	inline bool parseString(const char * s, rapidjson::SizeType length, SPL::uint32 & result) { return parseInteger(s, length, result); }
+	inline bool parseString(const char * s, rapidjson::SizeType length, SPL::uint64 & result) { return parseInteger(s, length, result); }
+
+	inline bool parseString(const char * s, rapidjson::SizeType length, SPL::float64 & result) { return parseDouble(s, length, result); }
+
+	inline bool parseString(const char * s, rapidjson::SizeType length, SPL::float32 & result) {
+
+		double d;
+		if(!parseDouble(s, length, d))
+			return false;
+
+		// out of range like a failing strtof
+		if(d == d && (d > std::numeric_limits<float>::max() || d < -std::numeric_limits<float>::max()) &&
+				d != std::numeric_limits<double>::infinity() && d != -std::numeric_limits<double>::infinity())
+			return false;
+
+		result = static_cast<SPL::float32>(d);
+		return true;
+	}
+
+	/*
+	 * Booleans are accepted as true, false, 1 and 0.
+	 */
+	inline bool parseString(const char * s, rapidjson::SizeType length, SPL::boolean & result) {
+
+		switch(length) {
+			case 1:
+				if(*s == '1') { result = true; return true; }
+				if(*s == '0') { result = false; return true; }
+				break;
+			case 4:
+				if(!memcmp(s, "true", 4)) { result = true; return true; }
+				break;
+			case 5:
+				if(!memcmp(s, "false", 5)) { result = false; return true; }
+				break;
+		}
+		return false;
+	}
+
+	/*
+	 * Decimal types keep the SPL conversion
+	 */
+	template<typename T>
+	inline bool parseString(const char * s, rapidjson::SizeType length, T & result) {
+
+		try {
+			result = streams_boost::lexical_cast<T>(std::string(s, length));
+			return true;
+		}
+		catch(streams_boost::bad_lexical_cast const&) {
+			return false;
+		}
+	}
+}}}}
+
+#endif /* JSON_NUMBER_H_ */
@@ -0,0 +1,114 @@
+/*
+ * JsonParseErrors.h
+ *
+ * Counters and rate-limited logging for JSON documents that cannot be parsed.
+ *
+ * When a producer sends malformed JSON every document fails, and a trace entry per
+ * document slows the processing down far more than the parsing itself. The errors
+ * are counted by parse error code instead, the first error is logged and then at
+ * most one per interval, together with the counts of the errors not logged since.
+ */
+
+#ifndef JSON_PARSE_ERRORS_H_
+#define JSON_PARSE_ERRORS_H_
+
+#include "rapidjson/error/error.h"
+
+#include <ctime>
+#include <sstream>
+#include <string>
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+
+
+namespace com { namespace ibm { namespace streamsx { namespace json {
+
+	/*
+	 * Parse errors of one parser, like a JSON context or an operator. The counters are
+	 * indexed by rapidjson::ParseErrorCode, which has the order of JsonParseStatus.status.
+	 * Not thread safe, like the parser it is used with.
+	 */
+	class ParseErrorLog {
+
+	public:
+		enum { STATUS_COUNT = rapidjson::kParseErrorUnspecificSyntaxError + 1, REPORT_INTERVAL = 10 };
+
+		ParseErrorLog() : total(0), totalReported(0), notReported(0), firstOffset(0), lastOffset(0), lastReport(0) {
+			for(int i = 0; i < STATUS_COUNT; i++)
+				counts[i] = 0;
+		}
+
+		void add(rapidjson::ParseErrorCode code, size_t offset) {
+			if(total == 0)
+				firstOffset = offset;
+			lastOffset = offset;
+			counts[static_cast<int>(code) < STATUS_COUNT ? code : rapidjson::kParseErrorUnspecificSyntaxError]++;
+			total++;
+		}
+
+		/*
+		 * true if the error added last is to be logged, the first error is
+		 * logged and then at most one per REPORT_INTERVAL seconds
+		 */
+		bool report() {
+			time_t now = time(NULL);
+			if(totalReported != 0 && now - lastReport < REPORT_INTERVAL)
+				return false;
+
+			lastReport = now;
+			notReported = total - totalReported - 1;
+			totalReported = total;
+			return true;
+		}
+
+		/*
+		 * text appended to a logged error, with the counts of the errors
+		 * not logged since the previous report
+		 */
+		std::string summary() const {
+			if(notReported == 0)
+				return "";
+
+			std::ostringstream s;
+			s << " (" << notReported << " errors not logged since the last logged error, " << total << " errors in total:";
+			for(int i = 1; i < STATUS_COUNT; i++) {
+				if(counts[i])
+					s << " " << statusName(i) << "=" << counts[i];
+			}
+			s << ", first at offset " << firstOffset << ", last at offset " << lastOffset << ")";
+			return s.str();
+		}
+
+		SPL::uint64 getCount(int status) const {
+			return status >= 0 && status < STATUS_COUNT ? counts[status] : 0;
+		}
+
+		SPL::uint64 getTotal() const { return total; }
+		size_t getFirstOffset() const { return firstOffset; }
+		size_t getLastOffset() const { return lastOffset; }
+
+		/* name of the JsonParseStatus.status value */
+		static const char * statusName(int status) {
+			static const char * const names[STATUS_COUNT] = {
+				"PARSED", "DOCUMENT_EMPTY", "MULTIPLE_ROOTS", "VALUE_INVALID", "KEY_MISSING", "COLON_MISSING",
+				"OBJECT_COMMA_OR_BRACKET_MISSING", "ARRAY_COMMA_OR_BRACKET_MISSING",
+				"UNICODE_ESCAPE_INVALID", "UNICODE_SURROGATE_INVALID",
+				"STRING_ESCAPE_INVALID", "STRING_QUOTATION_MISSING", "STRING_INVALID_ENCODING",
+				"NUMBER_TOO_BIG", "NUMBER_MISS_FRACTION", "NUMBER_MISS_EXPONENT", "TERMINATION", "SYNTAX_ERROR"
+			};
+			return status >= 0 && status < STATUS_COUNT ? names[status] : "SYNTAX_ERROR";
+		}
+
+	private:
+		SPL::uint64 counts[STATUS_COUNT];
+		SPL::uint64 total;
+		SPL::uint64 totalReported;
+		SPL::uint64 notReported;
+		size_t firstOffset;
+		size_t lastOffset;
+		time_t lastReport;
+	};
+}}}}
+
+#endif /* JSON_PARSE_ERRORS_H_ */
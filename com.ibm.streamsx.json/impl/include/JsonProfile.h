@@ -0,0 +1,156 @@
+/*
+ * JsonProfile.h
+ *
+ * Profile of the JSON values extractFromJSON drops: keys without matching attribute
+ * and values whose type does not match the attribute type.
+ *
+ * Tracing the dropped values costs far more than parsing them, the profile instead
+ * keeps the exact totals and a bounded top-k sketch of the keys (space saving
+ * algorithm), so the keys dropped most often are known with their byte volume
+ * while the memory does not grow with the number of distinct keys.
+ */
+
+#ifndef JSON_PROFILE_H_
+#define JSON_PROFILE_H_
+
+#include "rapidjson/stream.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+
+
+namespace com { namespace ibm { namespace streamsx { namespace json {
+
+	/*
+	 * Top-k sketch of keys with their count and bytes. While there are less than
+	 * capacity keys they are counted exactly, then a new key replaces the key with
+	 * the lowest count and inherits its count, which is kept as the error of the
+	 * estimate. Keys counted more often than total/capacity are always contained.
+	 */
+	class KeySketch {
+
+	public:
+		struct Entry {
+			std::string key;
+			SPL::uint64 count;
+			SPL::uint64 bytes;
+			SPL::uint64 error;
+		};
+
+		KeySketch(size_t capacity) : capacity(capacity) {}
+
+		void add(const char * key, size_t length, SPL::uint64 bytes) {
+			if(capacity == 0)
+				return;
+
+			std::string name(key, length);
+			std::map<std::string, size_t>::iterator it = index.find(name);
+			if(it != index.end()) {
+				entries[it->second].count++;
+				entries[it->second].bytes += bytes;
+				return;
+			}
+
+			Entry entry = { name, 1, bytes, 0 };
+			if(entries.size() < capacity) {
+				index[name] = entries.size();
+				entries.push_back(entry);
+				return;
+			}
+
+			size_t min = 0;
+			for(size_t i = 1; i < entries.size(); i++) {
+				if(entries[i].count < entries[min].count)
+					min = i;
+			}
+			index.erase(entries[min].key);
+			entry.count += entries[min].count;
+			entry.bytes += entries[min].bytes;
+			entry.error = entries[min].count;
+			entries[min] = entry;
+			index[name] = min;
+		}
+
+		std::vector<Entry> const& getEntries() const { return entries; }
+
+	private:
+		size_t capacity;
+		std::vector<Entry> entries;
+		std::map<std::string, size_t> index;
+	};
+
+	/*
+	 * String stream the reader does not copy to a local while it parses a string or
+	 * number, like it does for rapidjson::StringStream, so Tell() returns the offset
+	 * after the token in the handler events
+	 */
+	struct ProfiledStringStream : public rapidjson::StringStream {
+		ProfiledStringStream(const char * json) : rapidjson::StringStream(json) {}
+	};
+
+	/*
+	 * Dropped keys and type mismatches of the extractFromJSON calls on one thread,
+	 * the bytes of a value are counted from the end of the previous token, so they
+	 * include the separators and whitespace before it.
+	 */
+	class ExtractProfile {
+
+	public:
+		enum Kind { DROPPED_KEY, TYPE_MISMATCH, KIND_COUNT };
+
+		ExtractProfile(size_t capacity) : documents(0) {
+			for(int i = 0; i < KIND_COUNT; i++) {
+				sketches.push_back(KeySketch(capacity));
+				counts[i] = 0;
+				bytes[i] = 0;
+			}
+		}
+
+		void addDocument() {
+			documents++;
+		}
+
+		void add(Kind kind, const char * key, size_t length, SPL::uint64 valueBytes) {
+			counts[kind]++;
+			bytes[kind] += valueBytes;
+			sketches[kind].add(key, length, valueBytes);
+		}
+
+		/*
+		 * totals and top keys by name, the keys are prefixed with droppedKey or
+		 * typeMismatch and suffixed with .count, .bytes and .error
+		 */
+		SPL::map<SPL::rstring, SPL::uint64> toMap() const {
+			static const char * const names[KIND_COUNT] = { "droppedKey", "typeMismatch" };
+			static const char * const totals[KIND_COUNT] = { "nDroppedKeys", "nTypeMismatches" };
+
+			SPL::map<SPL::rstring, SPL::uint64> values;
+			values["nDocuments"] = documents;
+			for(int i = 0; i < KIND_COUNT; i++) {
+				values[totals[i]] = counts[i];
+				values[std::string(totals[i]) + "Bytes"] = bytes[i];
+
+				std::vector<KeySketch::Entry> const& entries = sketches[i].getEntries();
+				for(size_t j = 0; j < entries.size(); j++) {
+					std::string prefix = std::string(names[i]) + "." + entries[j].key;
+					values[prefix + ".count"] = entries[j].count;
+					values[prefix + ".bytes"] = entries[j].bytes;
+					values[prefix + ".error"] = entries[j].error;
+				}
+			}
+			return values;
+		}
+
+	private:
+		SPL::uint64 documents;
+		SPL::uint64 counts[KIND_COUNT];
+		SPL::uint64 bytes[KIND_COUNT];
+		std::vector<KeySketch> sketches;
+	};
+}}}}
+
+#endif /* JSON_PROFILE_H_ */
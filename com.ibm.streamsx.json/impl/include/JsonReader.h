@@ -10,6 +10,14 @@
 
 #define STREAMS_BOOST_LEXICAL_CAST_ASSUME_C_LOCALE
 
+#include "JsonAllocator.h"
+#include "JsonHandles.h"
+#include "JsonLatency.h"
+#include "JsonMetrics.h"
+#include "JsonNumber.h"
+#include "JsonParseErrors.h"
+#include "JsonProfile.h"
+
 #include "rapidjson/error/en.h"
 #include "rapidjson/document.h"
 #include "rapidjson/pointer.h"
@@ -17,7 +25,9 @@
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
 
+#include <map>
 #include <stack>
+#include <vector>
 #include <streams_boost/lexical_cast.hpp>
 #include <streams_boost/mpl/or.hpp>
 #include <streams_boost/thread/tss.hpp>
@@ -32,6 +42,11 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 
 	typedef enum{ NO, LIST, MAP } InCollection;
 
+	/* documents and their stacks allocate with a CountingAllocator, see JsonContext */
+	typedef rapidjson::GenericDocument<rapidjson::UTF8<>, DocumentAllocator, CountingAllocator> JsonDocument;
+	typedef JsonDocument::ValueType JsonValue;
+	typedef rapidjson::GenericPointer<JsonValue> JsonPointer;
+
 
 	/* Structure holding the state of the actual open tuple
 	 * tuple		reference to the SPl tuple object
@@ -93,13 +108,25 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 	 */
 	struct EventHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, EventHandler> {
 
-		EventHandler(SPL::Tuple & _tuple) {
+		EventHandler(SPL::Tuple & _tuple, bool _coerceStrings = false, bool _replaceCollections = false) :
+			coerceStrings(_coerceStrings), replaceCollections(_replaceCollections), profile(NULL), stream(NULL), lastOffset(0), lastValueBytes(0), inSpan(false), spanNesting(0), spanStart(0) {
 			objectStack.push(TupleState(_tuple));
 		}
 
+		/*
+		 * Profile the dropped keys and type mismatches, the stream is the one
+		 * parsed and gives the offsets for the byte volume of the values
+		 */
+		void profileWith(ExtractProfile * _profile, rapidjson::StringStream const * _stream) {
+			profile = _profile;
+			stream = _stream;
+		}
+
 		bool Key(const char* jsonKey, rapidjson::SizeType length, bool copy) {
 			SPLAPPTRC(L_DEBUG, "extracted key: " << jsonKey, "EXTRACT_FROM_JSON");
 
+			if(profile) profileOffset();
+
 			TupleState & state = objectStack.top();
 			SPL::TupleIterator const& endIter = state.tuple.getEndIterator();
 
@@ -121,10 +148,13 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 				TupleState & newState = objectStack.top();
 				newState.attrIter = newState.tuple.findAttribute(jsonKey);
 
-				if(newState.attrIter == endIter)
+				if(newState.attrIter == endIter) {
 					SPLAPPTRC(L_DEBUG, "not matched, dropped key: " << jsonKey, "EXTRACT_FROM_JSON");
+					if(profile) beginSpan(ExtractProfile::DROPPED_KEY, jsonKey, length, lastOffset - lastValueBytes);
+				}
 				else if(!newState.foundKeys.insert(jsonKey).second) {
 					SPLAPPTRC(L_DEBUG, "duplicate, dropped key: " << jsonKey, "EXTRACT_FROM_JSON");
+					if(profile) beginSpan(ExtractProfile::DROPPED_KEY, jsonKey, length, lastOffset - lastValueBytes);
 					newState.attrIter = endIter;
 				}
 			}
@@ -139,6 +169,8 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 		 * Set elements will not be added as null gives no information in a set.
 		 * */
 		bool Null() {
+			if(profile) profileValue();
+
 			TupleState & state = objectStack.top();
 
 			if(state.attrIter == state.tuple.getEndIterator()) {
@@ -207,8 +239,7 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 			return true;
 		}
 
-		bool Bool(bool b) {
-
+		bool Boolean(bool b) {
 			TupleState & state = objectStack.top();
 
 			if(state.attrIter == state.tuple.getEndIterator()) {
@@ -226,12 +257,12 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 						if (refOptional.getValueMetaType() == SPL::Meta::Type::BOOLEAN)
 							static_cast<SPL::optional<SPL::boolean> &>(refOptional) = SPL::boolean(b);
 						else
-							SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+							notMatched();
 					}
 					else if (valueHandle.getMetaType() == SPL::Meta::Type::BOOLEAN )
 						static_cast<SPL::boolean&>(valueHandle) = b;
 					else
-						SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+						notMatched();
 				}
 				else {
 					if (valueHandle.getMetaType() == SPL::Meta::Type::OPTIONAL){
@@ -240,17 +271,17 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 							valueHandle = refOptional.getValue();
 							switch(valueType) {
 								case SPL::Meta::Type::BOOLEAN : {InsertValue(valueHandle, SPL::ConstValueHandle(SPL::boolean(b)));break;}
-								default : SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+								default : notMatched();
 							}
 
 						}
 						else
-							SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+							notMatched();
 					}
 					else {
 						switch(valueType) {
 							case SPL::Meta::Type::BOOLEAN : {InsertValue(valueHandle, SPL::ConstValueHandle(SPL::boolean(b)));break;}
-							default : SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+							default : notMatched();
 						}
 					}
 				}
@@ -258,6 +289,8 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 			return true;
 		}
 
+		bool Bool(bool b) { if(profile) profileValue(); return Boolean(b); }
+
 		template <typename T>
 		bool Num(T num) {
 			TupleState & state = objectStack.top();
@@ -284,7 +317,7 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 							case SPL::Meta::Type::UINT64 : { static_cast<SPL::optional<SPL::uint64> &>(refOptional) = SPL::uint64(num); break; }
 							case SPL::Meta::Type::FLOAT32 : { static_cast<SPL::optional<SPL::float32> &>(refOptional) = SPL::float32(num); break; }
 							case SPL::Meta::Type::FLOAT64 : { static_cast<SPL::optional<SPL::float64> &>(refOptional) = SPL::float64(num); break; }
-							default : SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+							default : notMatched();
 						}
 					}
 					else {
@@ -299,7 +332,7 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 							case SPL::Meta::Type::UINT64 : { static_cast<SPL::uint64&>(valueHandle) = num; break; }
 							case SPL::Meta::Type::FLOAT32 : { static_cast<SPL::float32&>(valueHandle) = num; break; }
 							case SPL::Meta::Type::FLOAT64 : { static_cast<SPL::float64&>(valueHandle) = num; break; }
-							default : SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+							default : notMatched();
 						}
 					}
 				}
@@ -319,7 +352,7 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 								case SPL::Meta::Type::UINT64 : { InsertValue(valueHandle, SPL::ConstValueHandle(static_cast<SPL::uint64>(num))); break; }
 								case SPL::Meta::Type::FLOAT32 : { InsertValue(valueHandle, SPL::ConstValueHandle(static_cast<SPL::float32>(num))); break; }
 								case SPL::Meta::Type::FLOAT64 : { InsertValue(valueHandle, SPL::ConstValueHandle(static_cast<SPL::float64>(num))); break; }
-								default : SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+								default : notMatched();
 							}
 						}
 						else
@@ -337,7 +370,7 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 							case SPL::Meta::Type::UINT64 : { InsertValue(valueHandle, SPL::ConstValueHandle(static_cast<SPL::uint64>(num))); break; }
 							case SPL::Meta::Type::FLOAT32 : { InsertValue(valueHandle, SPL::ConstValueHandle(static_cast<SPL::float32>(num))); break; }
 							case SPL::Meta::Type::FLOAT64 : { InsertValue(valueHandle, SPL::ConstValueHandle(static_cast<SPL::float64>(num))); break; }
-							default : SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+							default : notMatched();
 						}
 					}
 				}
@@ -345,15 +378,20 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 			return true;
 		}
 
-		bool Int(int32_t i) { return Num(i); }
-		bool Uint(uint32_t u) { return Num(u); }
-		bool Int64(int64_t ii) { return Num(ii); }
-		bool Uint64(uint64_t uu) { return Num(uu); }
-		bool Double(double d) { return Num(d); }
+		bool Int(int32_t i) { if(profile) profileValue(); return Num(i); }
+		bool Uint(uint32_t u) { if(profile) profileValue(); return Num(u); }
+		bool Int64(int64_t ii) { if(profile) profileValue(); return Num(ii); }
+		bool Uint64(uint64_t uu) { if(profile) profileValue(); return Num(uu); }
+		bool Double(double d) { if(profile) profileValue(); return Num(d); }
 
 		bool String(const char* s, rapidjson::SizeType length, bool copy) {
+			if(profile) profileValue();
+
 			TupleState & state = objectStack.top();
 
+			if(coerceStrings && state.attrIter != state.tuple.getEndIterator() && CoerceString(s, length))
+				return true;
+
 			if(state.attrIter == state.tuple.getEndIterator()) {
 				SPLAPPTRC(L_DEBUG, "not matched, dropped value: " << s, "EXTRACT_FROM_JSON");
 			}
@@ -378,7 +416,7 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 							case SPL::Meta::Type::USTRING : {
 								static_cast<SPL::optional<SPL::ustring> &>(refOptional) = SPL::ustring(s,length);
 								break; }
-							default : SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+							default : notMatched();
 						}
 					}
 					else {
@@ -386,7 +424,7 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 							case SPL::Meta::Type::BSTRING : { static_cast<SPL::BString&>(valueHandle) = SPL::rstring(s, length); break; }
 							case SPL::Meta::Type::RSTRING : { static_cast<SPL::rstring&>(valueHandle) = s; break; }
 							case SPL::Meta::Type::USTRING : { static_cast<SPL::ustring&>(valueHandle) = s; break; }
-							default : SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+							default : notMatched();
 						}
 					}
 				}
@@ -399,7 +437,7 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 								case SPL::Meta::Type::BSTRING : { InsertValue(valueHandle, SPL::ConstValueHandle(SPL::bstring<1024>(s, length))); break; }
 								case SPL::Meta::Type::RSTRING : { InsertValue(valueHandle, SPL::ConstValueHandle(SPL::rstring(s, length))); break; }
 								case SPL::Meta::Type::USTRING : { InsertValue(valueHandle, SPL::ConstValueHandle(SPL::ustring(s, length))); break; }
-								default : SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+								default : notMatched();
 							}
 
 						}
@@ -411,7 +449,7 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 							case SPL::Meta::Type::BSTRING : { InsertValue(valueHandle, SPL::ConstValueHandle(SPL::bstring<1024>(s, length))); break; }
 							case SPL::Meta::Type::RSTRING : { InsertValue(valueHandle, SPL::ConstValueHandle(SPL::rstring(s, length))); break; }
 							case SPL::Meta::Type::USTRING : { InsertValue(valueHandle, SPL::ConstValueHandle(SPL::ustring(s, length))); break; }
-							default : SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+							default : notMatched();
 						}
 					}
 				}
@@ -423,6 +461,8 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 		bool StartObject() {
 			SPLAPPTRC(L_DEBUG, "object started", "EXTRACT_FROM_JSON");
 
+			if(profile) profileStart();
+
 			TupleState & state = objectStack.top();
 			SPL::TupleIterator const& endIter = state.tuple.getEndIterator();
 
@@ -439,6 +479,9 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 				 * 	bmap
 				 * */
 				if(state.inCollection == NO) {
+					if(replaceCollections)
+						ClearCollection(valueHandle);
+
 					switch(valueHandle.getMetaType()) {
 						case SPL::Meta::Type::MAP : {
 							SPLAPPTRC(L_DEBUG, "matched to map", "EXTRACT_FROM_JSON");
@@ -558,14 +601,14 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 									break;
 								}
 								default : {
-									SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+									notMatchedContainer();
 									state.attrIter = endIter;
 								}
 							}
 							break;
 						}
 						default : {
-							SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+							notMatchedContainer();
 							state.attrIter = endIter;
 						}
 					}
@@ -670,6 +713,8 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 		bool EndObject(rapidjson::SizeType memberCount) {
 			SPLAPPTRC(L_DEBUG, "object ended", "EXTRACT_FROM_JSON");
 
+			if(profile) profileEnd();
+
 			TupleState & state = objectStack.top();
 
 			/* if the tuple object containing the collection attribute (can be only map)
@@ -703,6 +748,8 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 		bool StartArray() {
 			SPLAPPTRC(L_DEBUG, "array started", "EXTRACT_FROM_JSON");
 
+			if(profile) profileStart();
+
 			TupleState & state = objectStack.top();
 			SPL::TupleIterator const& endIter = state.tuple.getEndIterator();
 
@@ -713,6 +760,10 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 			if(state.attrIter != endIter) {
 				SPL::ValueHandle valueHandle = (*state.attrIter).getValue();
 
+				/* a nested array of a collection being filled must not clear it */
+				if(replaceCollections && state.inCollection == NO)
+					ClearCollection(valueHandle);
+
 				switch (valueHandle.getMetaType()) {
 					case SPL::Meta::Type::LIST : {
 						SPLAPPTRC(L_DEBUG, "matched to list", "EXTRACT_FROM_JSON");
@@ -830,14 +881,14 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 								break;
 							}
 							default : {
-								SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+								notMatchedContainer();
 								state.attrIter = endIter;
 							}
 						}
 						break;
 					}
 					default : {
-						SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+						notMatchedContainer();
 						state.attrIter = endIter;
 					}
 				}
@@ -850,11 +901,67 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 		bool EndArray(rapidjson::SizeType elementCount) {
 			SPLAPPTRC(L_DEBUG, "array ended", "EXTRACT_FROM_JSON");
 
+			if(profile) profileEnd();
+
 			objectStack.top().inCollection = NO;
 			return true;
 		}
 
 
+		/*
+		 * In string coercion mode a JSON string for a numeric or boolean attribute or
+		 * collection element is converted and handled like a JSON number or boolean.
+		 * Strings not convertible to the target type are dropped.
+		 * Returns false if the target type is neither numeric nor boolean.
+		 */
+		bool CoerceString(const char* s, rapidjson::SizeType length) {
+			TupleState & state = objectStack.top();
+			SPL::Meta::Type type = valueType;
+
+			if(state.inCollection == NO) {
+				SPL::ValueHandle valueHandle = (*state.attrIter).getValue();
+				type = valueHandle.getMetaType();
+				if(type == SPL::Meta::Type::OPTIONAL)
+					type = static_cast<SPL::Optional&>(valueHandle).getValueMetaType();
+			}
+
+			switch(type) {
+				case SPL::Meta::Type::BOOLEAN : return CoerceString<SPL::boolean>(s, length);
+				case SPL::Meta::Type::INT8 : return CoerceString<SPL::int8>(s, length);
+				case SPL::Meta::Type::INT16 : return CoerceString<SPL::int16>(s, length);
+				case SPL::Meta::Type::INT32 : return CoerceString<SPL::int32>(s, length);
+				case SPL::Meta::Type::INT64 : return CoerceString<SPL::int64>(s, length);
+				case SPL::Meta::Type::UINT8 : return CoerceString<SPL::uint8>(s, length);
+				case SPL::Meta::Type::UINT16 : return CoerceString<SPL::uint16>(s, length);
+				case SPL::Meta::Type::UINT32 : return CoerceString<SPL::uint32>(s, length);
+				case SPL::Meta::Type::UINT64 : return CoerceString<SPL::uint64>(s, length);
+				case SPL::Meta::Type::FLOAT32 : return CoerceString<SPL::float32>(s, length);
+				case SPL::Meta::Type::FLOAT64 : return CoerceString<SPL::float64>(s, length);
+				default : return false;
+			}
+		}
+
+		template <typename T>
+		bool CoerceString(const char* s, rapidjson::SizeType length) {
+			T value;
+
+			if(parseString(s, length, value))
+				Coerced(value);
+			else {
+				SPLAPPTRC(L_DEBUG, "not converted, dropped value: " << s, "EXTRACT_FROM_JSON");
+				if(profile) addMismatch();
+			}
+
+			return true;
+		}
+
+		void Coerced(SPL::boolean b) { Boolean(b); }
+		void Coerced(SPL::int8 num) { Num(static_cast<SPL::int32>(num)); }
+		void Coerced(SPL::uint8 num) { Num(static_cast<SPL::uint32>(num)); }
+
+		template <typename T>
+		void Coerced(T num) { Num(num); }
+
 		/* Inserting a value in a collection type attribute
 		 * MAP/BMAP
 		 * LIST/BLIST
@@ -958,6 +1065,28 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 		}
 
 
+		/* Function to remove the elements of a collection attribute, a JSON array
+		 * or object replaces the collection instead of adding to it
+		 * The collection attribute may be optional, other types are not changed
+		 * */
+		void ClearCollection(SPL::ValueHandle valueHandle) {
+			switch (valueHandle.getMetaType()) {
+				case SPL::Meta::Type::LIST : { static_cast<SPL::List&>(valueHandle).removeAllElements(); break; }
+				case SPL::Meta::Type::BLIST : { static_cast<SPL::BList&>(valueHandle).removeAllElements(); break; }
+				case SPL::Meta::Type::SET : { static_cast<SPL::Set&>(valueHandle).removeAllElements(); break; }
+				case SPL::Meta::Type::BSET : { static_cast<SPL::BSet&>(valueHandle).removeAllElements(); break; }
+				case SPL::Meta::Type::MAP : { static_cast<SPL::Map&>(valueHandle).removeAllElements(); break; }
+				case SPL::Meta::Type::BMAP : { static_cast<SPL::BMap&>(valueHandle).removeAllElements(); break; }
+				case SPL::Meta::Type::OPTIONAL : {
+					SPL::Optional & refOptional = valueHandle;
+					if(refOptional.isPresent())
+						ClearCollection(refOptional.getValue());
+					break;
+				}
+				default:;
+			}
+		}
+
 		/* Function to set an Optional to present with its value
 		 * default initialization,
 		 * necessary e.g. to set an optional collection to present and empty
@@ -968,6 +1097,75 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 			value.deleteValue();
 		}
 
+		/* Profiling of dropped keys and type mismatches
+		 * The offsets are taken from the stream at each event, the bytes of a value are
+		 * counted from the end of the previous token. A dropped key with its value and a
+		 * container that does not match the attribute type are a span, which ends with
+		 * the value or the end of the container. Values in a span are not profiled on their own.
+		 * */
+		void profileOffset() {
+			size_t offset = stream->Tell();
+			lastValueBytes = offset - lastOffset;
+			lastOffset = offset;
+		}
+
+		void profileValue() {
+			profileOffset();
+			if(inSpan && spanNesting == 0)
+				endSpan();
+		}
+
+		void profileStart() {
+			profileOffset();
+			if(inSpan)
+				spanNesting++;
+		}
+
+		void profileEnd() {
+			profileOffset();
+			if(inSpan && --spanNesting == 0)
+				endSpan();
+		}
+
+		void beginSpan(ExtractProfile::Kind kind, const char * key, size_t length, size_t start) {
+			if(inSpan)
+				return;
+
+			inSpan = true;
+			spanKind = kind;
+			spanKey.assign(key, length);
+			spanStart = start;
+			spanNesting = 0;
+		}
+
+		void endSpan() {
+			inSpan = false;
+			profile->add(spanKind, spanKey.data(), spanKey.size(), lastOffset - spanStart);
+		}
+
+		void addMismatch() {
+			if(inSpan)
+				return;
+
+			std::string const& name = (*objectStack.top().attrIter).getName();
+			profile->add(ExtractProfile::TYPE_MISMATCH, name.data(), name.size(), lastValueBytes);
+		}
+
+		void notMatched() {
+			SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+			if(profile) addMismatch();
+		}
+
+		/* called by StartObject and StartArray, the container is a span */
+		void notMatchedContainer() {
+			SPLAPPTRC(L_DEBUG, "not matched", "EXTRACT_FROM_JSON");
+			if(profile && !inSpan) {
+				std::string const& name = (*objectStack.top().attrIter).getName();
+				beginSpan(ExtractProfile::TYPE_MISMATCH, name.data(), name.size(), lastOffset - lastValueBytes);
+				spanNesting = 1;
+			}
+		}
+
 	private:
 		// store last JSON key for creating map-collection (key,value) pairs with next JSON value event
 		SPL::rstring lastKey;
@@ -979,21 +1177,98 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 		bool valueIsOptional;
 		// store the stack of nested tuples, the top is the one which is open/in-work
 		std::stack<TupleState> objectStack;
+		// convert JSON strings for numeric and boolean attributes
+		bool coerceStrings;
+		// clear a collection attribute when its JSON array or object starts, set when the tuple is a default value
+		bool replaceCollections;
+		// profile of the dropped keys and type mismatches, NULL if not enabled
+		ExtractProfile * profile;
+		rapidjson::StringStream const * stream;
+		size_t lastOffset;
+		size_t lastValueBytes;
+		// value of a dropped key or a container not matching the attribute type
+		bool inSpan;
+		ExtractProfile::Kind spanKind;
+		std::string spanKey;
+		int spanNesting;
+		size_t spanStart;
 	};
 
-	inline SPL::Tuple& extractFromJSON(SPL::rstring const& jsonString, SPL::Tuple & tuple) {
+	/*
+	 * Profile of the extractFromJSON calls on the calling thread, NULL unless
+	 * enabled by enableExtractProfile
+	 */
+	inline streams_boost::thread_specific_ptr<ExtractProfile> & extractProfile() {
+		static streams_boost::thread_specific_ptr<ExtractProfile> profile;
+		return profile;
+	}
+
+	/*
+	 * Latency profiles of extractFromJSON and parseJSON on the calling thread,
+	 * NULL unless enabled by enableLatencyProfile
+	 */
+	inline streams_boost::thread_specific_ptr<FunctionLatency> & functionLatency() {
+		static streams_boost::thread_specific_ptr<FunctionLatency> latency;
+		return latency;
+	}
+
+	/*
+	 * Reader of extractFromJSON on one thread, reused like the reader of NativeJSONToTuple,
+	 * so its stack keeps the capacity for the longest string and is counted.
+	 */
+	struct ExtractReader {
+		ExtractReader() : stackAllocator(&stackMemory), reader(&stackAllocator) {}
+
+		AllocationStats stackMemory;
+		CountingAllocator stackAllocator;
+		rapidjson::GenericReader<rapidjson::UTF8<>, rapidjson::UTF8<>, CountingAllocator> reader;
+	};
+
+	inline ExtractReader & extractReader() {
+		static streams_boost::thread_specific_ptr<ExtractReader> readerPtr_;
 
-	    EventHandler handler(tuple);
-	    rapidjson::Reader reader;
-	    rapidjson::StringStream jsonStringStream(jsonString.c_str());
-	    reader.Parse(jsonStringStream, handler);
+		ExtractReader * readerPtr = readerPtr_.get();
+		if(!readerPtr) {
+			readerPtr_.reset(new ExtractReader());
+			readerPtr = readerPtr_.get();
+		}
+
+		return *readerPtr;
+	}
 
+	inline SPL::Tuple& extractFromJSON(SPL::rstring const& jsonString, SPL::Tuple & tuple, SPL::boolean coerceStrings) {
+
+	    EventHandler handler(tuple, coerceStrings);
+	    ExtractReader & extract = extractReader();
+
+	    FunctionLatency * latency = functionLatency().get();
+	    SPL::uint64 start = latency ? nanoTime() : 0;
+
+	    ExtractProfile * profile = extractProfile().get();
+	    if(profile) {
+	    	// a stream type without copy optimization, so its offset is current in the events
+	    	ProfiledStringStream profiledStream(jsonString.c_str());
+	    	profile->addDocument();
+	    	handler.profileWith(profile, &profiledStream);
+	    	extract.reader.Parse(profiledStream, handler);
+	    }
+	    else {
+	    	rapidjson::StringStream jsonStringStream(jsonString.c_str());
+	    	extract.reader.Parse(jsonStringStream, handler);
+	    }
+
+		if(latency)
+			latency->extractFromJSON.add(nanoTime() - start, jsonString.c_str(), jsonString.size());
 		return tuple;
 	}
 
+	inline SPL::Tuple& extractFromJSON(SPL::rstring const& jsonString, SPL::Tuple & tuple) {
+		return extractFromJSON(jsonString, tuple, false);
+	}
+
 
 	template<typename T>
-	inline T parseNumber(rapidjson::Value * value) {
+	inline T parseNumber(JsonValue * value) {
 		rapidjson::StringBuffer str;
 		rapidjson::Writer<rapidjson::StringBuffer> writer(str);
 		value->Accept(writer);
@@ -1006,16 +1281,15 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 	}
 
 	template<typename Status, typename Index>
-	inline SPL::boolean getJSONValue(rapidjson::Value * value, SPL::boolean defaultVal, Status & status, Index const& jsonIndex) {
+	inline SPL::boolean getJSONValue(JsonValue * value, SPL::boolean defaultVal, Status & status, Index const& jsonIndex) {
 
 		if(!value)					status = 4;
 		else if(value->IsNull())	status = 3;
 		else {
-			try {
-				if(value->IsBool())		{ status = 0; return static_cast<SPL::boolean>(value->GetBool()); }
-				if(value->IsString())	{ status = 1; return streams_boost::lexical_cast<SPL::boolean>(value->GetString()); }
-			}
-			catch(streams_boost::bad_lexical_cast const&) {}
+			SPL::boolean result;
+
+			if(value->IsBool())		{ status = 0; return static_cast<SPL::boolean>(value->GetBool()); }
+			if(value->IsString() && parseString(value->GetString(), value->GetStringLength(), result))	{ status = 1; return result; }
 
 			status = 2;
 		}
@@ -1024,7 +1298,7 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 	}
 
 	template<typename T, typename Status, typename Index>
-	inline T getJSONValue(rapidjson::Value * value, T defaultVal, Status & status, Index const& jsonIndex,
+	inline T getJSONValue(JsonValue * value, T defaultVal, Status & status, Index const& jsonIndex,
 					   typename streams_boost::enable_if< typename streams_boost::mpl::or_<
 					   	   streams_boost::mpl::bool_< streams_boost::is_arithmetic<T>::value>,
 						   streams_boost::mpl::bool_< streams_boost::is_same<SPL::decimal32, T>::value>,
@@ -1054,14 +1328,13 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 			if( streams_boost::is_same<SPL::decimal128, T>::value)	return parseNumber<T>(value);
 		}
 		else if(value->IsString())	{
-			status = 1;
+			T result;
 
-			try {
-				return streams_boost::lexical_cast<T>(value->GetString());
-			}
-			catch(streams_boost::bad_lexical_cast const&) {
-				status = 2;
+			if(parseString(value->GetString(), value->GetStringLength(), result)) {
+				status = 1;
+				return result;
 			}
+			status = 2;
 		}
 		else
 			status = 2;
@@ -1070,7 +1343,7 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 	}
 
 	template<typename T, typename Status, typename Index>
-	inline T getJSONValue(rapidjson::Value * value, T const& defaultVal, Status & status, Index const& jsonIndex,
+	inline T getJSONValue(JsonValue * value, T const& defaultVal, Status & status, Index const& jsonIndex,
 					   typename streams_boost::enable_if< typename streams_boost::mpl::or_<
 					   	   streams_boost::mpl::bool_< streams_boost::is_base_of<SPL::RString, T>::value>,
 						   streams_boost::mpl::bool_< streams_boost::is_same<SPL::ustring, T>::value>
@@ -1110,8 +1383,48 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 		return defaultVal;
 	}
 
+	/*
+	 * A JSON object is mapped to a tuple by replaying the already parsed DOM
+	 * as SAX events into the EventHandler used by extractFromJSON, so the
+	 * mapping rules are the same and the JSON is not serialized and parsed again.
+	 * Attributes without a matching key keep the value of defaultVal, collection
+	 * attributes with a matching key are replaced instead of appended to.
+	 */
 	template<typename T, typename Status, typename Index>
-	inline SPL::list<T> getJSONValue(rapidjson::Value * value, SPL::list<T> const& defaultVal, Status & status, Index const& jsonIndex) {
+	inline T getJSONValue(JsonValue * value, T const& defaultVal, Status & status, Index const& jsonIndex,
+					   typename streams_boost::enable_if< streams_boost::is_base_of<SPL::Tuple, T>, void*>::type t = NULL) {
+
+		if(!value)					status = 4;
+		else if(value->IsNull())	status = 3;
+		else if(!value->IsObject())	status = 2;
+		else {
+			status = 0;
+
+			T result(defaultVal);
+			EventHandler handler(result, false, true);
+			value->Accept(handler);
+
+			return result;
+		}
+
+		return defaultVal;
+	}
+
+	/*
+	 * collection and optional overloads call getJSONValue for their element type,
+	 * so all of them have to be declared before the first definition
+	 */
+	template<typename T, typename Status, typename Index>
+	inline SPL::list<T> getJSONValue(JsonValue * value, SPL::list<T> const& defaultVal, Status & status, Index const& jsonIndex);
+
+	template<typename K, typename T, typename Status, typename Index>
+	inline SPL::map<K,T> getJSONValue(JsonValue * value, SPL::map<K,T> const& defaultVal, Status & status, Index const& jsonIndex);
+
+	template<typename T, typename Status, typename Index>
+	inline SPL::optional<T> getJSONValue(JsonValue * value, SPL::optional<T> const& defaultVal, Status & status, Index const& jsonIndex);
+
+	template<typename T, typename Status, typename Index>
+	inline SPL::list<T> getJSONValue(JsonValue * value, SPL::list<T> const& defaultVal, Status & status, Index const& jsonIndex) {
 
 		if(!value)					status = 4;
 		else if(value->IsNull())	status = 3;
@@ -1119,12 +1432,12 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 		else						status = 0;
 
 		if(status == 0) {
-			rapidjson::Value::Array arr = value->GetArray();
+			JsonValue::Array arr = value->GetArray();
 			SPL::list<T> result;
 			result.reserve(arr.Size());
 			Status valueStatus = 0;
 
-			for (rapidjson::Value::Array::ValueIterator it = arr.Begin(); it != arr.End(); ++it) {
+			for (JsonValue::Array::ValueIterator it = arr.Begin(); it != arr.End(); ++it) {
 				T val = getJSONValue(it, T(), valueStatus, jsonIndex);
 
 				if(valueStatus == 0)
@@ -1138,6 +1451,418 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 
 		return defaultVal;
 	}
+
+	/*
+	 * A JSON object is mapped to a map with string keys. Members with a value
+	 * not matching the map value type are skipped and reported in status
+	 * the same way as list elements.
+	 */
+	template<typename K, typename T, typename Status, typename Index>
+	inline SPL::map<K,T> getJSONValue(JsonValue * value, SPL::map<K,T> const& defaultVal, Status & status, Index const& jsonIndex) {
+
+		if(!value)					status = 4;
+		else if(value->IsNull())	status = 3;
+		else if(!value->IsObject())	status = 2;
+		else						status = 0;
+
+		if(status == 0) {
+			SPL::map<K,T> result;
+			Status valueStatus = 0;
+
+			for (JsonValue::MemberIterator it = value->MemberBegin(); it != value->MemberEnd(); ++it) {
+				T val = getJSONValue(&it->value, T(), valueStatus, jsonIndex);
+
+				if(valueStatus == 0)
+					result.insert(std::make_pair(K(it->name.GetString(), it->name.GetStringLength()), val));
+				else if(valueStatus > status)
+					status = valueStatus;
+			}
+
+			return result;
+		}
+
+		return defaultVal;
+	}
+
+	/*
+	 * A JSON null is returned as null optional (status FOUND_NULL),
+	 * otherwise the value is converted as for the non-optional type.
+	 */
+	template<typename T, typename Status, typename Index>
+	inline SPL::optional<T> getJSONValue(JsonValue * value, SPL::optional<T> const& defaultVal, Status & status, Index const& jsonIndex) {
+
+		if(!value) {
+			status = 4;
+			return defaultVal;
+		}
+		if(value->IsNull()) {
+			status = 3;
+			return SPL::optional<T>();
+		}
+
+		T val = getJSONValue(value, T(), status, jsonIndex);
+		if(status < 2)
+			return SPL::optional<T>(val);
+
+		return defaultVal;
+	}
+	/* Hash index of the members of a wide JSON object
+	 * slots		open addressing table holding member positions + 1, 0 marks an empty slot
+	 * mask			table capacity - 1, the capacity is a power of two of at least twice the member count
+	 *
+	 * The slots are allocated from the document allocator, so the index is released together
+	 * with the document. The DOM is not modified after parsing, which keeps the positions valid.
+	 */
+	struct MemberIndex {
+		rapidjson::SizeType * slots;
+		rapidjson::SizeType mask;
+	};
+
+	// FNV-1a
+	inline uint32_t hashMemberName(const char * name, rapidjson::SizeType length) {
+		uint32_t hash = 2166136261u;
+		for(rapidjson::SizeType i = 0; i < length; i++) {
+			hash ^= static_cast<unsigned char>(name[i]);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	/*
+	 * Builds the hash index of an object. For duplicate keys only the first member is indexed
+	 * to return the same member as a linear FindMember would.
+	 */
+	inline MemberIndex buildMemberIndex(JsonValue const& object, DocumentAllocator & allocator) {
+
+		rapidjson::SizeType capacity = 2;
+		while(capacity < object.MemberCount() * 2)
+			capacity <<= 1;
+
+		MemberIndex index;
+		index.mask = capacity - 1;
+		index.slots = static_cast<rapidjson::SizeType*>(allocator.Malloc(capacity * sizeof(rapidjson::SizeType)));
+		memset(index.slots, 0, capacity * sizeof(rapidjson::SizeType));
+
+		JsonValue::ConstMemberIterator members = object.MemberBegin();
+		for(rapidjson::SizeType m = 0; m < object.MemberCount(); m++) {
+			JsonValue const& name = members[m].name;
+			rapidjson::SizeType slot = hashMemberName(name.GetString(), name.GetStringLength()) & index.mask;
+
+			while(index.slots[slot]) {
+				JsonValue const& slotName = members[index.slots[slot] - 1].name;
+				if(slotName == name)
+					break;
+				slot = (slot + 1) & index.mask;
+			}
+
+			if(!index.slots[slot])
+				index.slots[slot] = m + 1;
+		}
+
+		return index;
+	}
+
+	/* Parsed JSON document together with the state needed to query it
+	 * poolMemory			chunks the memory pool allocated after the arena, they are freed by the next parse
+	 * stackMemory			parse stack of the document, it is freed after each parse
+	 * storage				arena, memory pool and document, created by the first parse,
+	 * 						so a context that does not parse holds no arena
+	 * storage->allocator	memory pool of the document, the first chunk is the arena buffer
+	 * 						which is reused by each parse
+	 * storage->document	JSON object parsed by the last parse call
+	 * scratch				copy of the JSON string, the document is parsed in-situ in this buffer
+	 * cursors				values positioned by cursor and element, a cursor handle is
+	 * 						the position in this vector, handle 0 is the document root.
+	 * 						A NULL entry is a cursor to a value not found.
+	 * 						The cursors refer into the document, so they are dropped by parse.
+	 * cursorHandles		handle of each value in cursors, a value gets one cursor only, so
+	 * 						repeated cursor and element calls do not grow the cursors
+	 * pointers				parsed JSON pointers by path, the cache is cleared when full
+	 * memberIndexThreshold	objects with more members get a hash index on first lookup (0 - disabled)
+	 * memberIndexes		hash indexes built for the objects of the document
+	 *
+	 * The functions with a JsonIndex parameter use one context per thread and index,
+	 * the functions with a context handle use a context of the handle table.
+	 * A context must not be used by more than one thread at the same time.
+	 */
+	class JsonContext {
+
+	public:
+		enum { ARENA_SIZE = 64 * 1024, STACK_CAPACITY = 1024, POINTER_CACHE_SIZE = 1024 };
+
+		JsonContext() : poolAllocator(&poolMemory), stackAllocator(&stackMemory), storage(NULL), memberIndexThreshold(0) {}
+
+		~JsonContext() {
+			delete storage;
+		}
+
+		JsonDocument & getDocument() {
+			return getStorage().document;
+		}
+
+		void setMemberIndexThreshold(uint32_t threshold) {
+			memberIndexThreshold = threshold;
+		}
+
+		ParseErrorLog & getParseErrors() {
+			return parseErrors;
+		}
+
+		JsonStatistics & getStatistics() {
+			return statistics;
+		}
+
+		/* memory held by the context and allocated since it was created, by name */
+		SPL::map<SPL::rstring, SPL::uint64> getMemory() const {
+			SPL::map<SPL::rstring, SPL::uint64> values;
+			values["arenaBytes"] = storage ? storage->arena.size() : 0;
+			values["scratchBytes"] = scratch.capacity();
+			values["documentUsedBytes"] = storage ? storage->allocator.Size() : 0;
+			poolMemory.toMap("documentChunk", values);
+			stackMemory.toMap("documentStack", values);
+			return values;
+		}
+
+		template<typename Status>
+		bool parse(SPL::rstring const& jsonString, Status & status, uint32_t & offset) {
+
+			FunctionLatency * latency = functionLatency().get();
+			SPL::uint64 start = statistics.enabled || latency ? nanoTime() : 0;
+
+			DocumentStorage & current = getStorage();
+			JsonDocument & document = current.document;
+
+			cursors.clear();
+			cursorHandles.clear();
+			memberIndexes.clear();
+			document.SetNull();
+			current.allocator.Clear();
+
+			scratch.assign(jsonString.c_str(), jsonString.c_str() + jsonString.size() + 1);
+			addCursor(&document);
+
+			bool parsed = !document.ParseInsitu<rapidjson::kParseStopWhenDoneFlag>(&scratch[0]).HasParseError();
+			if(!parsed) {
+				document.SetObject();
+				status = document.GetParseError();
+				offset = document.GetErrorOffset();
+				parseErrors.add(document.GetParseError(), document.GetErrorOffset());
+			}
+
+			if(statistics.enabled || latency) {
+				SPL::uint64 nanos = nanoTime() - start;
+				if(statistics.enabled)
+					statistics.addDocument(jsonString.size(), nanos);
+				if(latency)
+					latency->parseJSON.add(nanos, jsonString.c_str(), jsonString.size());
+			}
+			return parsed;
+		}
+
+		template<typename T, typename Status>
+		T query(uint32_t cursor, SPL::rstring const& jsonPath, T const& defaultVal, Status & status) {
+
+			JsonValue * base = getCursorValue(cursor);
+			JsonValue * value;
+
+			if(!base) {
+				status = 4;
+				countQuery(status);
+				return defaultVal;
+			}
+			else if(getPointerValue(*base, jsonPath, value, status)) {
+				T result(getJSONValue(value, defaultVal, status, *this));
+				countQuery(status);
+				return result;
+			}
+			else {
+				countQuery(status);
+				return defaultVal;
+			}
+		}
+
+		template<typename Status>
+		uint32_t cursor(uint32_t cursor, SPL::rstring const& jsonPath, Status & status) {
+
+			JsonValue * base = getCursorValue(cursor);
+			JsonValue * value = NULL;
+
+			if(!base)
+				status = 4;
+			else if(getPointerValue(*base, jsonPath, value, status)) {
+				if(!value)					status = 4;
+				else if(value->IsNull())	status = 3;
+				else						status = 0;
+			}
+
+			return addCursor(value);
+		}
+
+		template<typename Status>
+		uint32_t element(uint32_t cursor, uint32_t index, Status & status) {
+
+			JsonValue * base = getCursorValue(cursor);
+			JsonValue * value = NULL;
+
+			if(!base)							status = 4;
+			else if(!base->IsArray())			status = 2;
+			else if(index >= base->Size())		status = 4;
+			else {
+				value = &(*base)[index];
+				status = value->IsNull() ? 3 : 0;
+			}
+
+			return addCursor(value);
+		}
+
+		uint32_t arraySize(uint32_t cursor) {
+
+			JsonValue * value = getCursorValue(cursor);
+			return value && value->IsArray() ? value->Size() : 0;
+		}
+
+		uint32_t memberCount(uint32_t cursor) {
+
+			JsonValue * value = getCursorValue(cursor);
+			return value && value->IsObject() ? value->MemberCount() : 0;
+		}
+
+	private:
+		typedef std::map<std::string, JsonPointer> PointerCache;
+
+		struct DocumentStorage {
+			DocumentStorage(CountingAllocator * poolAllocator, CountingAllocator * stackAllocator) : arena(ARENA_SIZE),
+				allocator(&arena[0], arena.size(), ARENA_SIZE, poolAllocator), document(&allocator, STACK_CAPACITY, stackAllocator) {}
+
+			std::vector<char> arena;
+			DocumentAllocator allocator;
+			JsonDocument document;
+		};
+
+		// a context owns the arena used by its allocator
+		JsonContext(JsonContext const&);
+		JsonContext & operator=(JsonContext const&);
+
+		DocumentStorage & getStorage() {
+			if(!storage)
+				storage = new DocumentStorage(&poolAllocator, &stackAllocator);
+			return *storage;
+		}
+
+		JsonValue * getCursorValue(uint32_t cursor) {
+
+			if(cursors.empty())
+				THROW(SPL::SPLRuntimeOperator, "Invalid usage of 'queryJSON' function, 'parseJSON' function must be used before.");
+			if(cursor >= cursors.size())
+				THROW(SPL::SPLRuntimeOperator, "Invalid cursor, cursors are valid until the next 'parseJSON' call.");
+
+			return cursors[cursor];
+		}
+
+		template<typename Status>
+		void countQuery(Status const& status) {
+			if(statistics.enabled)
+				statistics.addQuery(status);
+		}
+
+		uint32_t addCursor(JsonValue * value) {
+
+			std::pair<std::map<const JsonValue*, uint32_t>::iterator, bool> entry =
+					cursorHandles.insert(std::make_pair(value, (uint32_t)cursors.size()));
+			if(entry.second)
+				cursors.push_back(value);
+			return entry.first->second;
+		}
+
+		JsonPointer const& getPointer(SPL::rstring const& jsonPath) {
+
+			PointerCache::iterator pointerIter = pointers.find(jsonPath);
+			if(pointerIter == pointers.end()) {
+				if(pointers.size() >= POINTER_CACHE_SIZE)
+					pointers.clear();
+				pointerIter = pointers.insert(std::make_pair(std::string(jsonPath), JsonPointer(jsonPath.c_str()))).first;
+			}
+
+			return pointerIter->second;
+		}
+
+		/*
+		 * Member lookup used when resolving JSON pointers. Objects up to the threshold
+		 * are scanned linearly, wider ones are looked up by their hash index.
+		 */
+		JsonValue * findMember(JsonValue & object, const char * name, rapidjson::SizeType length) {
+
+			if(!memberIndexThreshold || object.MemberCount() <= memberIndexThreshold) {
+				JsonValue::MemberIterator member = object.FindMember(JsonValue(rapidjson::StringRef(name, length)));
+				return member == object.MemberEnd() ? NULL : &member->value;
+			}
+
+			std::map<const JsonValue*, MemberIndex>::iterator indexIter = memberIndexes.find(&object);
+			if(indexIter == memberIndexes.end())
+				indexIter = memberIndexes.insert(std::make_pair(&object, buildMemberIndex(object, storage->allocator))).first;
+
+			MemberIndex const& index = indexIter->second;
+			JsonValue::MemberIterator members = object.MemberBegin();
+
+			for(rapidjson::SizeType slot = hashMemberName(name, length) & index.mask; index.slots[slot]; slot = (slot + 1) & index.mask) {
+				JsonValue::Member & member = members[index.slots[slot] - 1];
+				if(member.name.GetStringLength() == length && memcmp(member.name.GetString(), name, length) == 0)
+					return &member.value;
+			}
+
+			return NULL;
+		}
+
+		/*
+		 * Resolves a JSON pointer relative to the given value.
+		 * Returns false and sets the status to the shifted pointer error code if the path is invalid.
+		 */
+		template<typename Status>
+		bool getPointerValue(JsonValue & root, SPL::rstring const& jsonPath, JsonValue *& value, Status & status) {
+
+			JsonPointer const& pointer = getPointer(jsonPath);
+
+			if(!pointer.IsValid()) {
+				status = pointer.GetParseErrorCode() + 4; // Pointer error codes in SPL enum should be shifted by 4
+				value = NULL;
+				return false;
+			}
+
+			if(!memberIndexThreshold) {
+				value = pointer.Get(root);
+				return true;
+			}
+
+			// same walk as Pointer::Get, but with indexed member lookup
+			value = &root;
+			const JsonPointer::Token * tokens = pointer.GetTokens();
+
+			for(size_t t = 0; value && t < pointer.GetTokenCount(); t++) {
+				if(value->IsObject())
+					value = findMember(*value, tokens[t].name, tokens[t].length);
+				else if(value->IsArray() && tokens[t].index != rapidjson::kPointerInvalidIndex && tokens[t].index < value->Size())
+					value = &(*value)[tokens[t].index];
+				else
+					value = NULL;
+			}
+
+			return true;
+		}
+
+		AllocationStats poolMemory;
+		AllocationStats stackMemory;
+		CountingAllocator poolAllocator;
+		CountingAllocator stackAllocator;
+		DocumentStorage * storage;
+		std::vector<char> scratch;
+		std::vector<JsonValue*> cursors;
+		std::map<const JsonValue*, uint32_t> cursorHandles;
+		PointerCache pointers;
+		rapidjson::SizeType memberIndexThreshold;
+		std::map<const JsonValue*, MemberIndex> memberIndexes;
+		ParseErrorLog parseErrors;
+		JsonStatistics statistics;
+	};
 }}}}
 
 #endif
@@ -1147,63 +1872,172 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 	namespace { // this anonymous namespace will be defined for each operator separately
 
 		template<typename Index>
-		inline rapidjson::Document& getDocument() {
-			static streams_boost::thread_specific_ptr<rapidjson::Document> jsonPtr_;
+		inline JsonContext& getContext() {
+			static streams_boost::thread_specific_ptr<JsonContext> contextPtr_;
 
-			rapidjson::Document * jsonPtr = jsonPtr_.get();
-			if(!jsonPtr) {
-				jsonPtr_.reset(new rapidjson::Document());
-				jsonPtr = jsonPtr_.get();
+			JsonContext * contextPtr = contextPtr_.get();
+			if(!contextPtr) {
+				contextPtr_.reset(new JsonContext());
+				contextPtr = contextPtr_.get();
 			}
 
-			return *jsonPtr;
+			return *contextPtr;
 		}
 
-		template<typename Status, typename Index>
-		inline bool parseJSON(SPL::rstring const& jsonString, Status & status, uint32_t & offset, const Index & jsonIndex) {
-			rapidjson::Document & json = getDocument<Index>();
-			rapidjson::Document(rapidjson::kObjectType).Swap(json);
+		template<typename Index>
+		inline JsonDocument& getDocument() {
+			return getContext<Index>().getDocument();
+		}
 
-			if(json.Parse<rapidjson::kParseStopWhenDoneFlag>(jsonString.c_str()).HasParseError()) {
-				json.SetObject();
-				status = json.GetParseError();
-				offset = json.GetErrorOffset();
+		/*
+		 * A context handle refers to a context of the handle table of the processing element,
+		 * released, uninitialized and checkpointed handles are rejected. The contexts not
+		 * released are deleted when the processing element shuts down.
+		 */
+		inline JsonContext& getContext(SPL::uint64 context) {
 
-				return false;
-			}
-			return true;
+			JsonContext * contextPtr = HandleTable<JsonContext>::instance().get(context);
+			if(!contextPtr)
+				THROW(SPL::SPLRuntimeOperator, "Invalid JSON context, 'createJSONContext' function must be used before.");
+
+			return *contextPtr;
+		}
+
+		inline SPL::uint64 createJSONContext() {
+			SPL::uint64 context = HandleTable<JsonContext>::instance().add(new JsonContext());
+			if(!context)
+				THROW(SPL::SPLRuntimeOperator, "Too many JSON contexts, 'releaseJSONContext' function must be used to release them.");
+
+			return context;
 		}
 
+		inline void releaseJSONContext(SPL::uint64 context) {
+			if(!HandleTable<JsonContext>::instance().release(context))
+				THROW(SPL::SPLRuntimeOperator, "Invalid JSON context, 'createJSONContext' function must be used before.");
+		}
+
+		/*
+		 * Objects with more members than the threshold get a hash index on first
+		 * lookup by queryJSON/cursorJSON, 0 disables the index (default).
+		 */
 		template<typename Index>
-		inline uint32_t  parseJSON(SPL::rstring const& jsonString, const Index & jsonIndex) {
+		inline void setMemberIndexThreshold(uint32_t threshold, Index const& jsonIndex) {
+			getContext<Index>().setMemberIndexThreshold(threshold);
+		}
+
+		inline void setMemberIndexThreshold(uint32_t threshold, SPL::uint64 context) {
+			getContext(context).setMemberIndexThreshold(threshold);
+		}
+
+		/*
+		 * Memory of the context of an index on the calling thread or of a context handle:
+		 * the chunks and stack the document allocated, current and peak, and the buffers kept.
+		 * For an index the stack of the extractFromJSON reader of the thread is added.
+		 */
+		template<typename Index>
+		inline SPL::map<SPL::rstring, SPL::uint64> getJSONMemory(Index const& jsonIndex) {
+			SPL::map<SPL::rstring, SPL::uint64> values = getContext<Index>().getMemory();
+			extractReader().stackMemory.toMap("extractStack", values);
+			return values;
+		}
+
+		inline SPL::map<SPL::rstring, SPL::uint64> getJSONMemory(SPL::uint64 context) {
+			return getContext(context).getMemory();
+		}
+
+		/*
+		 * Profile of the keys extractFromJSON drops on the calling thread,
+		 * capacity is the number of keys kept per kind, 0 disables the profile
+		 */
+		inline void enableExtractProfile(uint32_t capacity) {
+			extractProfile().reset(capacity ? new ExtractProfile(capacity) : NULL);
+		}
+
+		inline SPL::map<SPL::rstring, SPL::uint64> getExtractProfile() {
+			ExtractProfile * profile = extractProfile().get();
+			return profile ? profile->toMap() : SPL::map<SPL::rstring, SPL::uint64>();
+		}
+
+		/*
+		 * Latency histograms of extractFromJSON and parseJSON on the calling thread,
+		 * with the given number of slowest documents, calling it again restarts them
+		 */
+		inline void enableLatencyProfile(uint32_t slowDocuments) {
+			functionLatency().reset(new FunctionLatency(slowDocuments));
+		}
+
+		/* profiles of the calling thread and of the operators in the processing element as JSON */
+		inline SPL::rstring dumpLatencyProfile() {
+			rapidjson::StringBuffer buffer;
+			LatencyWriter writer(buffer);
+
+			writer.StartObject();
+			FunctionLatency * latency = functionLatency().get();
+			if(latency) {
+				writer.Key("extractFromJSON");
+				latency->extractFromJSON.write(writer);
+				writer.Key("parseJSON");
+				latency->parseJSON.write(writer);
+			}
+			writer.Key("operators");
+			LatencyRegistry::instance().write(writer);
+			writer.EndObject();
+
+			return SPL::rstring(buffer.GetString(), buffer.GetSize());
+		}
+
+		/*
+		 * Statistics of the documents parsed and the queries of a context,
+		 * collected after enableJSONStatistics was called
+		 */
+		inline void enableJSONStatistics(SPL::uint64 context) {
+			getContext(context).getStatistics().enabled = true;
+		}
+
+		inline SPL::map<SPL::rstring, SPL::uint64> getJSONStatistics(SPL::uint64 context) {
+			JsonContext & jsonContext = getContext(context);
+			return jsonContext.getStatistics().toMap(jsonContext.getParseErrors());
+		}
+
+		template<typename Status, typename Index>
+		inline bool parseJSON(SPL::rstring const& jsonString, Status & status, uint32_t & offset, const Index & jsonIndex) {
+			return getContext<Index>().parse(jsonString, status, offset);
+		}
+
+		template<typename Status>
+		inline bool parseJSON(SPL::rstring const& jsonString, Status & status, uint32_t & offset, SPL::uint64 context) {
+			return getContext(context).parse(jsonString, status, offset);
+		}
+
+		inline uint32_t parseJSON(SPL::rstring const& jsonString, JsonContext & context) {
 
 			rapidjson::ParseErrorCode status = rapidjson::kParseErrorNone;
 			uint32_t offset = 0;
 
-			if(!parseJSON(jsonString, status, offset, jsonIndex))
-				SPLAPPTRC(L_ERROR, GetParseError_En(status), "PARSE_JSON");
+			// errors are counted by the context, only some of them are traced when every document fails
+			if(!context.parse(jsonString, status, offset) && context.getParseErrors().report())
+				SPLAPPTRC(L_ERROR, GetParseError_En(status) << " at offset " << offset << context.getParseErrors().summary(), "PARSE_JSON");
 
 			return (uint32_t)status;
 		}
 
-		template<typename T, typename Status, typename Index>
-		inline T queryJSON(SPL::rstring const& jsonPath, T const& defaultVal, Status & status, Index const& jsonIndex) {
+		template<typename Index>
+		inline uint32_t  parseJSON(SPL::rstring const& jsonString, const Index & jsonIndex) {
+			return parseJSON(jsonString, getContext<Index>());
+		}
 
-			rapidjson::Document & json = getDocument<Index>();
-			if(json.IsNull())
-				THROW(SPL::SPLRuntimeOperator, "Invalid usage of 'queryJSON' function, 'parseJSON' function must be used before.");
+		inline uint32_t parseJSON(SPL::rstring const& jsonString, SPL::uint64 context) {
+			return parseJSON(jsonString, getContext(context));
+		}
 
-			const rapidjson::Pointer & pointer = rapidjson::Pointer(jsonPath.c_str());
-			rapidjson::PointerParseErrorCode ec = pointer.GetParseErrorCode();
+		template<typename T, typename Status, typename Index>
+		inline T queryJSON(SPL::rstring const& jsonPath, T const& defaultVal, Status & status, Index const& jsonIndex) {
+			return getContext<Index>().query(0, jsonPath, defaultVal, status);
+		}
 
-			if(pointer.IsValid()) {
-				rapidjson::Value * value = pointer.Get(json);
-				return getJSONValue(value, defaultVal, status, jsonIndex);
-			}
-			else {
-				status = ec + 4; // Pointer error codes in SPL enum should be shifted by 4
-				return defaultVal;
-			}
+		template<typename T, typename Status>
+		inline T queryJSON(SPL::rstring const& jsonPath, T const& defaultVal, Status & status, SPL::uint64 context) {
+			return getContext(context).query(0, jsonPath, defaultVal, status);
 		}
 
 		template<typename T, typename Index>
@@ -1212,8 +2046,130 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 			 int status = 0;
 			 return queryJSON(jsonPath, defaultVal, status, jsonIndex);
 		}
+
+		template<typename T>
+		inline T queryJSON(SPL::rstring const& jsonPath, T const& defaultVal, SPL::uint64 context) {
+
+			 int status = 0;
+			 return queryJSON(jsonPath, defaultVal, status, context);
+		}
+
+		/*
+		 * Cursors allow to query a sub-tree of the document without walking the path
+		 * from the root again. A cursor handle is valid until the next parseJSON call
+		 * for the same index or context, handle 0 is always the document root.
+		 */
+		template<typename Status, typename Index>
+		inline uint32_t cursorJSON(uint32_t cursor, SPL::rstring const& jsonPath, Status & status, Index const& jsonIndex) {
+			return getContext<Index>().cursor(cursor, jsonPath, status);
+		}
+
+		template<typename Status>
+		inline uint32_t cursorJSON(uint32_t cursor, SPL::rstring const& jsonPath, Status & status, SPL::uint64 context) {
+			return getContext(context).cursor(cursor, jsonPath, status);
+		}
+
+		template<typename Index>
+		inline uint32_t cursorJSON(uint32_t cursor, SPL::rstring const& jsonPath, Index const& jsonIndex) {
+
+			int status = 0;
+			return cursorJSON(cursor, jsonPath, status, jsonIndex);
+		}
+
+		inline uint32_t cursorJSON(uint32_t cursor, SPL::rstring const& jsonPath, SPL::uint64 context) {
+
+			int status = 0;
+			return cursorJSON(cursor, jsonPath, status, context);
+		}
+
+		template<typename Status, typename Index>
+		inline uint32_t cursorJSON(SPL::rstring const& jsonPath, Status & status, Index const& jsonIndex) {
+			return cursorJSON(0, jsonPath, status, jsonIndex);
+		}
+
+		template<typename Status>
+		inline uint32_t cursorJSON(SPL::rstring const& jsonPath, Status & status, SPL::uint64 context) {
+			return cursorJSON(0, jsonPath, status, context);
+		}
+
+		template<typename Index>
+		inline uint32_t cursorJSON(SPL::rstring const& jsonPath, Index const& jsonIndex) {
+
+			int status = 0;
+			return cursorJSON(0, jsonPath, status, jsonIndex);
+		}
+
+		inline uint32_t cursorJSON(SPL::rstring const& jsonPath, SPL::uint64 context) {
+
+			int status = 0;
+			return cursorJSON(0, jsonPath, status, context);
+		}
+
+		template<typename Status, typename Index>
+		inline uint32_t elementJSON(uint32_t cursor, uint32_t index, Status & status, Index const& jsonIndex) {
+			return getContext<Index>().element(cursor, index, status);
+		}
+
+		template<typename Status>
+		inline uint32_t elementJSON(uint32_t cursor, uint32_t index, Status & status, SPL::uint64 context) {
+			return getContext(context).element(cursor, index, status);
+		}
+
+		template<typename Index>
+		inline uint32_t elementJSON(uint32_t cursor, uint32_t index, Index const& jsonIndex) {
+
+			int status = 0;
+			return elementJSON(cursor, index, status, jsonIndex);
+		}
+
+		inline uint32_t elementJSON(uint32_t cursor, uint32_t index, SPL::uint64 context) {
+
+			int status = 0;
+			return elementJSON(cursor, index, status, context);
+		}
+
+		template<typename Index>
+		inline uint32_t arraySizeJSON(uint32_t cursor, Index const& jsonIndex) {
+			return getContext<Index>().arraySize(cursor);
+		}
+
+		inline uint32_t arraySizeJSON(uint32_t cursor, SPL::uint64 context) {
+			return getContext(context).arraySize(cursor);
+		}
+
+		template<typename Index>
+		inline uint32_t memberCountJSON(uint32_t cursor, Index const& jsonIndex) {
+			return getContext<Index>().memberCount(cursor);
+		}
+
+		inline uint32_t memberCountJSON(uint32_t cursor, SPL::uint64 context) {
+			return getContext(context).memberCount(cursor);
+		}
+
+		template<typename T, typename Status, typename Index>
+		inline T queryJSON(uint32_t cursor, SPL::rstring const& jsonPath, T const& defaultVal, Status & status, Index const& jsonIndex) {
+			return getContext<Index>().query(cursor, jsonPath, defaultVal, status);
+		}
+
+		template<typename T, typename Status>
+		inline T queryJSON(uint32_t cursor, SPL::rstring const& jsonPath, T const& defaultVal, Status & status, SPL::uint64 context) {
+			return getContext(context).query(cursor, jsonPath, defaultVal, status);
+		}
+
+		template<typename T, typename Index>
+		inline T queryJSON(uint32_t cursor, SPL::rstring const& jsonPath, T const& defaultVal, Index const& jsonIndex) {
+
+			 int status = 0;
+			 return queryJSON(cursor, jsonPath, defaultVal, status, jsonIndex);
+		}
+
+		template<typename T>
+		inline T queryJSON(uint32_t cursor, SPL::rstring const& jsonPath, T const& defaultVal, SPL::uint64 context) {
+
+			 int status = 0;
+			 return queryJSON(cursor, jsonPath, defaultVal, status, context);
+		}
 	}
 }}}}
 
 /* JSON_READER_H_ */
-
@@ -0,0 +1,168 @@
+/*
+ * JsonTupleHandler.h
+ *
+ * Common part of the SAX handlers generated by the NativeJSONToTuple operator.
+ *
+ * The code generator numbers each value of the output schema the JSON document
+ * can be mapped to (tuples, collections, optionals and primitives) and creates a
+ * handler class with one switch over these numbers per rapidjson event. This header
+ * keeps the state that is the same for all schemas: the stack of open tuples and
+ * collections, the number of the value expected next and the nesting depth of
+ * skipped values.
+ */
+
+#ifndef JSON_TUPLE_HANDLER_H_
+#define JSON_TUPLE_HANDLER_H_
+
+#include "rapidjson/reader.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+
+
+namespace com { namespace ibm { namespace streamsx { namespace json {
+
+	/*
+	 * value type of an optional type, used by the generated code
+	 * to name the types of nested values
+	 */
+	template<typename T>
+	struct OptionalValue;
+
+	template<typename T>
+	struct OptionalValue<SPL::optional<T> > {
+		typedef T type;
+	};
+
+	/*
+	 * range of a numeric type, used by the generated code to drop the JSON numbers
+	 * the type cannot hold like values of another type. Doubles are truncated
+	 * when they are converted to integer types.
+	 */
+	template<typename T, bool Integer = std::numeric_limits<T>::is_integer>
+	struct NumberRange {
+		static bool contains(int num) { return contains(static_cast<int64_t>(num)); }
+		static bool contains(unsigned num) { return contains(static_cast<uint64_t>(num)); }
+
+		static bool contains(int64_t num) {
+			if(num < 0)
+				return std::numeric_limits<T>::is_signed && num >= static_cast<int64_t>(std::numeric_limits<T>::min());
+			return static_cast<uint64_t>(num) <= static_cast<uint64_t>(std::numeric_limits<T>::max());
+		}
+
+		static bool contains(uint64_t num) {
+			return num <= static_cast<uint64_t>(std::numeric_limits<T>::max());
+		}
+
+		static bool contains(double num) {
+			double truncated = num < 0 ? std::ceil(num) : std::floor(num);
+			double limit = std::ldexp(1.0, std::numeric_limits<T>::digits);
+			return truncated < limit && truncated >= (std::numeric_limits<T>::is_signed ? -limit : 0.0);
+		}
+	};
+
+	template<typename T>
+	struct NumberRange<T, false> {
+		template<typename N>
+		static bool contains(N) { return true; }
+
+		static bool contains(double num) {
+			return num >= -std::numeric_limits<T>::max() && num <= std::numeric_limits<T>::max();
+		}
+	};
+
+	template<typename Handler>
+	struct TupleHandlerBase : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, Handler> {
+
+		enum { NONE = -1 };
+
+		/*
+		 * an open tuple or collection, element is the value number of the collection elements
+		 * or NONE for tuples, where the value number is selected by the key
+		 */
+		struct Frame {
+			int node;
+			int element;
+			void * value;
+		};
+
+		TupleHandlerBase() : keysMatched(0), keysDropped(0), node(NONE), root(0), skipDepth(0) {}
+
+		void reset(int rootNode, void * rootValue) {
+			stack.clear();
+			node = rootNode;
+			root = rootValue;
+			skipDepth = 0;
+			keysMatched = 0;
+			keysDropped = 0;
+		}
+
+		bool Int(int i) { return static_cast<Handler*>(this)->Num(i); }
+		bool Uint(unsigned u) { return static_cast<Handler*>(this)->Num(u); }
+		bool Int64(int64_t i) { return static_cast<Handler*>(this)->Num(i); }
+		bool Uint64(uint64_t u) { return static_cast<Handler*>(this)->Num(u); }
+		bool Double(double d) { return static_cast<Handler*>(this)->Num(d); }
+
+		bool EndObject(rapidjson::SizeType) { return end(); }
+		bool EndArray(rapidjson::SizeType) { return end(); }
+
+		/* keys of the document read since the last reset, keys of skipped values are not counted */
+		SPL::uint64 keysMatched;
+		SPL::uint64 keysDropped;
+
+	protected:
+
+		void * top() { return stack.back().value; }
+
+		void push(int container, int element, void * value) {
+			Frame frame = { container, element, value };
+			stack.push_back(frame);
+			node = element;
+		}
+
+		/*
+		 * Values without matching attribute or element type are dropped, objects and arrays
+		 * as a whole. At the root level they are an error, the JSON is expected to match
+		 * the root type.
+		 */
+		bool drop() {
+			return !stack.empty();
+		}
+
+		bool dropContainer() {
+			if(stack.empty())
+				return false;
+
+			skipDepth++;
+			return true;
+		}
+
+		bool end() {
+			if(skipDepth) {
+				if(--skipDepth == 0)
+					node = stack.back().element;
+				return true;
+			}
+
+			int container = stack.back().node;
+			stack.pop_back();
+			if(!stack.empty()) {
+				node = stack.back().element;
+				static_cast<Handler*>(this)->Completed(container);
+			}
+			return true;
+		}
+
+		std::vector<Frame> stack;
+		int node;
+		void * root;
+		rapidjson::SizeType skipDepth;
+		SPL::rstring key;
+	};
+}}}}
+
+#endif /* JSON_TUPLE_HANDLER_H_ */
@@ -337,6 +337,114 @@ namespace com { namespace ibm { namespace streamsx { namespace json {
 	}
 
 
+	/*
+	 * Typed variants of writeAny used by the code generated for the NativeTupleToJSON operator.
+	 * The overload is selected at compile time by the SPL type of the value, so primitive values
+	 * and collections of them are written without a value handle and meta type dispatch.
+	 * Types without a typed variant (tuples in collections, bounded types, decimals, enums, ...)
+	 * fall back to writeAny, which removes the prefixToIgnore from the attribute names of the
+	 * tuples. The primitive variants do not use the prefixToIgnore.
+	 */
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::boolean value, SPL::rstring const&) { writer.Bool(value); }
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::int8 value, SPL::rstring const&) { writer.Int(value); }
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::int16 value, SPL::rstring const&) { writer.Int(value); }
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::int32 value, SPL::rstring const&) { writer.Int(value); }
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::int64 value, SPL::rstring const&) { writer.Int64(value); }
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::uint8 value, SPL::rstring const&) { writer.Uint(value); }
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::uint16 value, SPL::rstring const&) { writer.Uint(value); }
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::uint32 value, SPL::rstring const&) { writer.Uint(value); }
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::uint64 value, SPL::rstring const&) { writer.Uint64(value); }
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::float32 value, SPL::rstring const&) { writer.Double(value); }
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::float64 value, SPL::rstring const&) { writer.Double(value); }
+
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::rstring const& value, SPL::rstring const&) {
+		writer.String(value.c_str(), static_cast<rapidjson::SizeType>(value.size()));
+	}
+
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::ustring const& value, SPL::rstring const& prefixToIgnore) {
+		writeValue(writer, SPL::spl_cast<SPL::rstring,SPL::ustring>::cast(value), prefixToIgnore);
+	}
+
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::timestamp const& value, SPL::rstring const& prefixToIgnore) {
+		writeValue(writer, SPL::Functions::Time::ctime(value), prefixToIgnore);
+	}
+
+	/* map keys are written as strings, keys of other types are converted like by the SPL string cast */
+	inline void writeKey(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::rstring const& key) {
+		writer.Key(key.c_str(), static_cast<rapidjson::SizeType>(key.size()));
+	}
+
+	inline void writeKey(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::ustring const& key) {
+		writeKey(writer, SPL::spl_cast<SPL::rstring,SPL::ustring>::cast(key));
+	}
+
+	template<typename K>
+	inline void writeKey(rapidjson::Writer<rapidjson::StringBuffer> & writer, K const& key) {
+		writeKey(writer, SPL::spl_cast<SPL::rstring,K>::cast(key));
+	}
+
+	// collection variants call writeValue for their element type, so all of them have to be declared first
+	template<typename T>
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, T const& value, SPL::rstring const& prefixToIgnore);
+
+	template<typename T>
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::list<T> const& value, SPL::rstring const& prefixToIgnore);
+
+	template<typename T>
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::set<T> const& value, SPL::rstring const& prefixToIgnore);
+
+	template<typename K, typename T>
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::map<K,T> const& value, SPL::rstring const& prefixToIgnore);
+
+	template<typename T>
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::optional<T> const& value, SPL::rstring const& prefixToIgnore);
+
+	template<typename T>
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, T const& value, SPL::rstring const& prefixToIgnore) {
+		writeAny(writer, SPL::ConstValueHandle(value), prefixToIgnore);
+	}
+
+	template<typename T>
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::list<T> const& value, SPL::rstring const& prefixToIgnore) {
+
+		writer.StartArray();
+		for(typename SPL::list<T>::const_iterator it = value.begin(); it != value.end(); ++it) {
+			writeValue(writer, *it, prefixToIgnore);
+		}
+		writer.EndArray();
+	}
+
+	template<typename T>
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::set<T> const& value, SPL::rstring const& prefixToIgnore) {
+
+		writer.StartArray();
+		for(typename SPL::set<T>::const_iterator it = value.begin(); it != value.end(); ++it) {
+			writeValue(writer, *it, prefixToIgnore);
+		}
+		writer.EndArray();
+	}
+
+	template<typename K, typename T>
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::map<K,T> const& value, SPL::rstring const& prefixToIgnore) {
+
+		writer.StartObject();
+		for(typename SPL::map<K,T>::const_iterator it = value.begin(); it != value.end(); ++it) {
+			writeKey(writer, it->first);
+			writeValue(writer, it->second, prefixToIgnore);
+		}
+		writer.EndObject();
+	}
+
+	template<typename T>
+	inline void writeValue(rapidjson::Writer<rapidjson::StringBuffer> & writer, SPL::optional<T> const& value, SPL::rstring const& prefixToIgnore) {
+
+		if(value.isPresent())
+			writeValue(writer, value.value(), prefixToIgnore);
+		else
+			writer.Null();
+	}
+
+
 	inline SPL::rstring tupleToJSON(SPL::Tuple const& tuple, SPL::rstring prefixToIgnore = "") {
 
 	    rapidjson::StringBuffer s;
@@ -0,0 +1,376 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_INTERNAL_SIMD_H_
+#define RAPIDJSON_INTERNAL_SIMD_H_
+
+#include "../rapidjson.h"
+
+#ifdef RAPIDJSON_SIMD_DISPATCH
+#include <immintrin.h>
+
+//! Compiles a function for an instruction set, without enabling it for the rest of the translation unit.
+#define RAPIDJSON_SIMD_TARGET(isa) __attribute__((target(isa)))
+
+//! Excludes a null-terminated kernel from AddressSanitizer, whose aligned loads read past the terminator.
+#if defined(__SANITIZE_ADDRESS__)
+#define RAPIDJSON_SIMD_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define RAPIDJSON_SIMD_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#endif
+#endif
+#ifndef RAPIDJSON_SIMD_NO_SANITIZE_ADDRESS
+#define RAPIDJSON_SIMD_NO_SANITIZE_ADDRESS
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+namespace internal {
+
+//! Instruction sets of the SIMD kernels, in order of preference.
+enum SimdLevel {
+    kSimdScalar = 0,    //!< Portable C++
+    kSimdSSE2,          //!< 16 bytes at a time
+    kSimdSSE42,         //!< 16 bytes at a time with pcmpistri/pcmpestri
+    kSimdAVX2           //!< 32 bytes at a time
+};
+
+inline bool IsWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+//! Characters that end an unescaped span of a string: quotation mark, backslash and control characters.
+inline bool IsStringSpecial(char c) {
+    return c == '\"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scalar kernels
+
+inline const char* SkipWhitespaceScalar(const char* p) {
+    while (IsWhitespace(*p))
+        ++p;
+    return p;
+}
+
+inline const char* SkipWhitespaceScalar(const char* p, const char* end) {
+    while (p != end && IsWhitespace(*p))
+        ++p;
+    return p;
+}
+
+inline const char* ScanUnescapedScalar(const char* p) {
+    while (!IsStringSpecial(*p))
+        ++p;
+    return p;
+}
+
+inline const char* ScanUnescapedScalar(const char* p, const char* end) {
+    while (p != end && !IsStringSpecial(*p))
+        ++p;
+    return p;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SSE2 kernels
+//
+// The null-terminated kernels scan one by one until alignment, then load whole
+// aligned blocks of 16 (AVX2: 32) bytes. The block of the terminator may extend
+// past the end of the buffer, but an aligned block never crosses a page boundary
+// and the terminator is in the block, so the block is in a mapped page and the
+// load cannot fault. The bytes after the terminator are never matched because the
+// terminator ends the scan first. AddressSanitizer reports these reads, so the
+// kernels are not instrumented.
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline unsigned WhitespaceMaskSSE2(__m128i s) {
+    const __m128i x = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(s, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(s, _mm_set1_epi8('\n'))),
+        _mm_or_si128(_mm_cmpeq_epi8(s, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(s, _mm_set1_epi8('\t'))));
+    return ~static_cast<unsigned>(_mm_movemask_epi8(x)) & 0xFFFFu;
+}
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline unsigned StringSpecialMaskSSE2(__m128i s) {
+    const __m128i sp = _mm_set1_epi8(0x1F);
+    const __m128i x = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(s, _mm_set1_epi8('\"')), _mm_cmpeq_epi8(s, _mm_set1_epi8('\\'))),
+        _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp)); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+    return static_cast<unsigned>(_mm_movemask_epi8(x));
+}
+
+RAPIDJSON_SIMD_TARGET("sse2") RAPIDJSON_SIMD_NO_SANITIZE_ADDRESS
+inline const char* SkipWhitespaceSSE2(const char* p) {
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+    for (; p != nextAligned; ++p)
+        if (!IsWhitespace(*p))
+            return p;
+
+    for (;; p += 16) {
+        unsigned r = WhitespaceMaskSSE2(_mm_load_si128(reinterpret_cast<const __m128i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline const char* SkipWhitespaceSSE2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        unsigned r = WhitespaceMaskSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+    return SkipWhitespaceScalar(p, end);
+}
+
+RAPIDJSON_SIMD_TARGET("sse2") RAPIDJSON_SIMD_NO_SANITIZE_ADDRESS
+inline const char* ScanUnescapedSSE2(const char* p) {
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+    for (; p != nextAligned; ++p)
+        if (IsStringSpecial(*p))
+            return p;
+
+    for (;; p += 16) {
+        unsigned r = StringSpecialMaskSSE2(_mm_load_si128(reinterpret_cast<const __m128i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline const char* ScanUnescapedSSE2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        unsigned r = StringSpecialMaskSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+    return ScanUnescapedScalar(p, end);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SSE4.2 kernels
+//
+// pcmpistri/pcmpestri match the whitespace set in one instruction. For the
+// three tests of the string scan they are slower than the SSE2 compares on
+// most cores, so the SSE4.2 level keeps the SSE2 string kernels.
+
+RAPIDJSON_SIMD_TARGET("sse4.2") RAPIDJSON_SIMD_NO_SANITIZE_ADDRESS
+inline const char* SkipWhitespaceSSE42(const char* p) {
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+    for (; p != nextAligned; ++p)
+        if (!IsWhitespace(*p))
+            return p;
+
+    static const char whitespace[16] = " \n\r\t";
+    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespace[0]));
+
+    for (;; p += 16) {
+        const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
+        const int r = _mm_cmpistri(w, s, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT | _SIDD_NEGATIVE_POLARITY);
+        if (r != 16)    // some of characters is non-whitespace
+            return p + r;
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("sse4.2")
+inline const char* SkipWhitespaceSSE42(const char* p, const char* end) {
+    static const char whitespace[16] = " \n\r\t";
+    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespace[0]));
+
+    for (; end - p >= 16; p += 16) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const int r = _mm_cmpestri(w, 4, s, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT | _SIDD_NEGATIVE_POLARITY);
+        if (r != 16)    // some of characters is non-whitespace
+            return p + r;
+    }
+    return SkipWhitespaceScalar(p, end);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX2 kernels
+
+#ifdef RAPIDJSON_SIMD_AVX2
+RAPIDJSON_SIMD_TARGET("avx2")
+inline unsigned WhitespaceMaskAVX2(__m256i s) {
+    const __m256i x = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(s, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\n'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(s, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\t'))));
+    return ~static_cast<unsigned>(_mm256_movemask_epi8(x));
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline unsigned StringSpecialMaskAVX2(__m256i s) {
+    const __m256i sp = _mm256_set1_epi8(0x1F);
+    const __m256i x = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(s, _mm256_set1_epi8('\"')), _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\\'))),
+        _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp)); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+    return static_cast<unsigned>(_mm256_movemask_epi8(x));
+}
+
+RAPIDJSON_SIMD_TARGET("avx2") RAPIDJSON_SIMD_NO_SANITIZE_ADDRESS
+inline const char* SkipWhitespaceAVX2(const char* p) {
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 31) & static_cast<size_t>(~31));
+    for (; p != nextAligned; ++p)
+        if (!IsWhitespace(*p))
+            return p;
+
+    for (;; p += 32) {
+        unsigned r = WhitespaceMaskAVX2(_mm256_load_si256(reinterpret_cast<const __m256i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline const char* SkipWhitespaceAVX2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        unsigned r = WhitespaceMaskAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+    return SkipWhitespaceScalar(p, end);
+}
+
+RAPIDJSON_SIMD_TARGET("avx2") RAPIDJSON_SIMD_NO_SANITIZE_ADDRESS
+inline const char* ScanUnescapedAVX2(const char* p) {
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 31) & static_cast<size_t>(~31));
+    for (; p != nextAligned; ++p)
+        if (IsStringSpecial(*p))
+            return p;
+
+    for (;; p += 32) {
+        unsigned r = StringSpecialMaskAVX2(_mm256_load_si256(reinterpret_cast<const __m256i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline const char* ScanUnescapedAVX2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        unsigned r = StringSpecialMaskAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+    return ScanUnescapedSSE2(p, end);
+}
+#endif // RAPIDJSON_SIMD_AVX2
+
+///////////////////////////////////////////////////////////////////////////////
+// Dispatch
+
+//! Kernels of one instruction set.
+struct SimdKernels {
+    SimdLevel level;
+    //! Returns the first non-whitespace character of a null-terminated string.
+    const char* (*skipWhitespace)(const char* p);
+    //! Returns the first non-whitespace character in [p, end), or end.
+    const char* (*skipWhitespaceN)(const char* p, const char* end);
+    //! Returns the first quotation mark, backslash or control character of a null-terminated string.
+    const char* (*scanUnescaped)(const char* p);
+    //! Returns the first quotation mark, backslash or control character in [p, end), or end.
+    const char* (*scanUnescapedN)(const char* p, const char* end);
+};
+
+//! Kernels of a level, the level must be supported by the CPU.
+inline const SimdKernels& GetSimdKernels(SimdLevel level) {
+    static const SimdKernels kernels[] = {
+        { kSimdScalar, SkipWhitespaceScalar, SkipWhitespaceScalar, ScanUnescapedScalar, ScanUnescapedScalar },
+        { kSimdSSE2, SkipWhitespaceSSE2, SkipWhitespaceSSE2, ScanUnescapedSSE2, ScanUnescapedSSE2 },
+        { kSimdSSE42, SkipWhitespaceSSE42, SkipWhitespaceSSE42, ScanUnescapedSSE2, ScanUnescapedSSE2 },
+#ifdef RAPIDJSON_SIMD_AVX2
+        { kSimdAVX2, SkipWhitespaceAVX2, SkipWhitespaceAVX2, ScanUnescapedAVX2, ScanUnescapedAVX2 }
+#endif
+    };
+    return kernels[level];
+}
+
+//! Best level supported by the CPU and by the compiler.
+inline SimdLevel GetSupportedSimdLevel() {
+    __builtin_cpu_init();
+#ifdef RAPIDJSON_SIMD_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        return kSimdAVX2;
+#endif
+    if (__builtin_cpu_supports("sse4.2"))
+        return kSimdSSE42;
+    if (__builtin_cpu_supports("sse2"))
+        return kSimdSSE2;
+    return kSimdScalar;
+}
+
+//! Kernels used by the reader and the writer, selected at the first use.
+inline const SimdKernels*& ActiveSimdKernels() {
+    static const SimdKernels* kernels = &GetSimdKernels(GetSupportedSimdLevel());
+    return kernels;
+}
+
+//! Level of the kernels used by the reader and the writer.
+inline SimdLevel GetSimdLevel() {
+    return ActiveSimdKernels()->level;
+}
+
+//! Selects the kernels of a level, for tests and benchmarks.
+/*! \param level Requested level, lowered to the best supported one.
+    \return The selected level.
+    \note Not thread-safe, it must not be called while other threads parse or write.
+*/
+inline SimdLevel SetSimdLevel(SimdLevel level) {
+    const SimdLevel supported = GetSupportedSimdLevel();
+    ActiveSimdKernels() = &GetSimdKernels(level < supported ? level : supported);
+    return GetSimdLevel();
+}
+
+inline const char* GetSimdLevelName(SimdLevel level) {
+    static const char* const names[] = { "scalar", "sse2", "sse4.2", "avx2" };
+    return names[level];
+}
+
+//! Skip whitespace with the selected kernel.
+/*! Compact JSON has no or a single whitespace between the tokens, they are
+    skipped inline and the kernel is called for the longer runs only.
+*/
+inline const char* SkipWhitespaceDispatch(const char* p) {
+    if (!IsWhitespace(*p))
+        return p;
+    if (!IsWhitespace(*++p))
+        return p;
+    return ActiveSimdKernels()->skipWhitespace(p);
+}
+
+inline const char* SkipWhitespaceDispatch(const char* p, const char* end) {
+    if (p == end || !IsWhitespace(*p))
+        return p;
+    if (++p == end || !IsWhitespace(*p))
+        return p;
+    return ActiveSimdKernels()->skipWhitespaceN(p, end);
+}
+
+//! Scan the unescaped span of a null-terminated string with the selected kernel.
+/*! Keys and short values end within a few characters, they are scanned
+    inline and the kernel is called for the longer spans only.
+*/
+inline const char* ScanUnescapedDispatch(const char* p) {
+    for (const char* prefixEnd = p + 8; p != prefixEnd; ++p)
+        if (IsStringSpecial(*p))
+            return p;
+    return ActiveSimdKernels()->scanUnescaped(p);
+}
+
+} // namespace internal
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_SIMD_DISPATCH
+
+#endif // RAPIDJSON_INTERNAL_SIMD_H_
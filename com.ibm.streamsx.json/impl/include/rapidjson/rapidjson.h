@@ -349,6 +349,29 @@
 #define RAPIDJSON_SIMD
 #endif
 
+///////////////////////////////////////////////////////////////////////////////
+// RAPIDJSON_SIMD_DISPATCH
+
+/*! \def RAPIDJSON_SIMD_DISPATCH
+    \ingroup RAPIDJSON_CONFIG
+    \brief Select the SIMD kernels at runtime.
+
+    The kernels of the optimized parsing and writing operations are compiled
+    for SSE2, SSE4.2 and AVX2 with function target attributes, and the best
+    one supported by the CPU is selected at the first use. A single binary
+    thus runs on every x86 host without \c -msse4.2 or \c -mavx2.
+
+    It is defined by default with GCC 4.9 or later and clang on x86, unless
+    \c RAPIDJSON_SSE2 or \c RAPIDJSON_SSE42 selects the kernels at compile
+    time. Define \c RAPIDJSON_NO_SIMD_DISPATCH to disable it.
+*/
+#if !defined(RAPIDJSON_SIMD) && !defined(RAPIDJSON_NO_SIMD_DISPATCH) \
+    && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define RAPIDJSON_SIMD_DISPATCH
+#define RAPIDJSON_SIMD_AVX2
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // RAPIDJSON_NO_SIZETYPEDEFINE
 
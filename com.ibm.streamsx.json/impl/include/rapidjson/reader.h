@@ -23,7 +23,9 @@
 #include "internal/meta.h"
 #include "internal/stack.h"
 #include "internal/strtod.h"
+#include "internal/simd.h"
 #include <limits>
+#include <cstring>  // memcpy, memmove
 
 #if defined(RAPIDJSON_SIMD) && defined(_MSC_VER)
 #include <intrin.h>
@@ -443,6 +445,22 @@ template<> inline void SkipWhitespace(EncodedInputStream<UTF8<>, MemoryStream>&
 }
 #endif // RAPIDJSON_SIMD
 
+#ifdef RAPIDJSON_SIMD_DISPATCH
+//! Template function specialization for InsituStringStream, the kernel is selected at runtime
+template<> inline void SkipWhitespace(InsituStringStream& is) {
+    is.src_ = const_cast<char*>(internal::SkipWhitespaceDispatch(is.src_));
+}
+
+//! Template function specialization for StringStream, the kernel is selected at runtime
+template<> inline void SkipWhitespace(StringStream& is) {
+    is.src_ = internal::SkipWhitespaceDispatch(is.src_);
+}
+
+template<> inline void SkipWhitespace(EncodedInputStream<UTF8<>, MemoryStream>& is) {
+    is.is_.src_ = internal::SkipWhitespaceDispatch(is.is_.src_, is.is_.end_);
+}
+#endif // RAPIDJSON_SIMD_DISPATCH
+
 ///////////////////////////////////////////////////////////////////////////////
 // GenericReader
 
@@ -1064,6 +1082,30 @@ private:
 
         is.src_ = is.dst_ = p;
     }
+#elif defined(RAPIDJSON_SIMD_DISPATCH)
+    // StringStream -> StackStream<char>, the span is found by the kernel selected at runtime and copied at once
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
+        const char* p = is.src_;
+        const char* q = internal::ScanUnescapedDispatch(p);
+        const SizeType length = static_cast<SizeType>(q - p);
+        if (length != 0)
+            std::memcpy(os.Push(length), p, length);
+        is.src_ = q;
+    }
+
+    // InsituStringStream -> InsituStringStream
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InsituStringStream& is, InsituStringStream& os) {
+        RAPIDJSON_ASSERT(&is == &os);
+        (void)os;
+
+        char* p = is.src_;
+        const size_t length = static_cast<size_t>(internal::ScanUnescapedDispatch(p) - p);
+        // When read/write pointers are the same, the span is skipped
+        if (is.dst_ != p)
+            std::memmove(is.dst_, p, length);
+        is.src_ = p + length;
+        is.dst_ += length;
+    }
 #endif
 
     template<typename InputStream, bool backup, bool pushOnTake>
@@ -20,8 +20,10 @@
 #include "internal/strfunc.h"
 #include "internal/dtoa.h"
 #include "internal/itoa.h"
+#include "internal/simd.h"
 #include "stringbuffer.h"
 #include <new>      // placement new
+#include <cstring>  // memcpy
 
 #if defined(RAPIDJSON_SIMD) && defined(_MSC_VER)
 #include <intrin.h>
@@ -597,6 +599,24 @@ inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, siz
 }
 #endif // defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
 
+#ifdef RAPIDJSON_SIMD_DISPATCH
+template<>
+inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, size_t length) {
+    const char* p = is.src_;
+    const char* end = is.head_ + length;
+    if (end - p < 16)   // short spans are copied by the generic loop
+        return RAPIDJSON_LIKELY(p != end);
+
+    // Find the next character to escape with the kernel selected at runtime and copy the span before it
+    const char* q = internal::ActiveSimdKernels()->scanUnescapedN(p, end);
+    const size_t len = static_cast<size_t>(q - p);
+    std::memcpy(os_->PushUnsafe(len), p, len);
+
+    is.src_ = q;
+    return RAPIDJSON_LIKELY(q != end);
+}
+#endif // RAPIDJSON_SIMD_DISPATCH
+
 RAPIDJSON_NAMESPACE_END
 
 #ifdef _MSC_VER
@@ -0,0 +1,37 @@
+//
+// *******************************************************************************
+// * Copyright (C)2016, International Business Machines Corporation and *
+// * others. All Rights Reserved. *
+// *******************************************************************************
+//
+package com.ibm.streamsx.json;
+
+import com.ibm.streams.operator.metrics.Metric;
+
+/**
+ * Custom metrics of the documents an operator converts, shared by the
+ * operators that parse and create JSON strings. The metrics are set by
+ * the custom metric setters of the operator before it is initialized.
+ */
+class DocumentMetrics {
+
+	Metric documents;
+	Metric bytes;
+	Metric maxDocumentSize;
+	Metric avgDocumentSize;
+	Metric time;
+
+	/**
+	 * Counts a document, synchronized as the operators may convert on several threads.
+	 * @param size Size of the document in bytes.
+	 * @param nanos Time spent converting the document.
+	 */
+	synchronized void addDocument(long size, long nanos) {
+		documents.increment();
+		bytes.incrementValue(size);
+		time.incrementValue(nanos);
+		if(size > maxDocumentSize.getValue())
+			maxDocumentSize.setValue(size);
+		avgDocumentSize.setValue(bytes.getValue() / documents.getValue());
+	}
+}
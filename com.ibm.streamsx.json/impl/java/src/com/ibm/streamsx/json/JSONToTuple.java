@@ -6,19 +6,22 @@
 //
 package com.ibm.streamsx.json;
 
+import java.nio.charset.Charset;
+import java.util.ArrayDeque;
 import java.util.Arrays;
 import java.util.List;
-import java.util.Map;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Semaphore;
 import java.util.logging.Logger;
 
-import com.ibm.json.java.JSONArray;
-import com.ibm.json.java.JSONObject;
 import com.ibm.streams.operator.AbstractOperator;
 import com.ibm.streams.operator.OperatorContext;
 import com.ibm.streams.operator.OperatorContext.ContextCheck;
 import com.ibm.streams.operator.OutputTuple;
 import com.ibm.streams.operator.StreamSchema;
 import com.ibm.streams.operator.StreamingInput;
+import com.ibm.streams.operator.StreamingData.Punctuation;
 import com.ibm.streams.operator.StreamingOutput;
 import com.ibm.streams.operator.Tuple;
 import com.ibm.streams.operator.TupleAttribute;
@@ -26,7 +29,8 @@ import com.ibm.streams.operator.Type;
 import com.ibm.streams.operator.Type.MetaType;
 import com.ibm.streams.operator.compile.OperatorContextChecker;
 import com.ibm.streams.operator.logging.TraceLevel;
-import com.ibm.streams.operator.meta.TupleType;
+import com.ibm.streams.operator.metrics.Metric;
+import com.ibm.streams.operator.model.CustomMetric;
 import com.ibm.streams.operator.model.InputPortSet;
 import com.ibm.streams.operator.model.InputPorts;
 import com.ibm.streams.operator.model.Libraries;
@@ -34,6 +38,10 @@ import com.ibm.streams.operator.model.OutputPortSet;
 import com.ibm.streams.operator.model.OutputPorts;
 import com.ibm.streams.operator.model.Parameter;
 import com.ibm.streams.operator.model.PrimitiveOperator;
+import com.ibm.streams.operator.types.Blob;
+import com.ibm.streams.operator.types.RString;
+import com.ibm.streamsx.json.converters.ConversionErrorLog;
+import com.ibm.streamsx.json.converters.JSONParseException;
 import com.ibm.streamsx.json.converters.JSONToTupleConverter;
 import com.ibm.streamsx.json.converters.TupleTypeVerifier;
 
@@ -48,6 +56,9 @@ public class JSONToTuple extends AbstractOperator
 	private String jsonStringAttribute = null;
 	private static final String INPUT_JSON_ATTRIBUTE_PARAM="inputAttribute"; //$NON-NLS-1$
 	private static final String defaultJsonStringAttribute = "jsonString"; //$NON-NLS-1$
+	private static final Charset UTF8 = Charset.forName("UTF-8"); //$NON-NLS-1$
+	/* characters of a ustring or bytes of an rstring or blob logged with a conversion error */
+	private static final int LOG_PREFIX_LENGTH = 64;
 	private Logger l = Logger.getLogger(JSONToTuple.class.getCanonicalName());
 	boolean ignoreParsingError = false;
 	private String jsonStringOutputAttribute = null;
@@ -55,17 +66,38 @@ public class JSONToTuple extends AbstractOperator
 	private Type targetAttrType;
 	private boolean wasTargetSpecified = false;
 	private boolean hasOptionalOut = false;
-	private TupleAttribute<Tuple,String> inputJsonAttribute = null;
+	private TupleAttribute<Tuple,?> inputJsonAttribute = null;
+	private int jsonInputIndex;
+	private boolean copyRString = false;
 	private boolean wasPrefixToIgnoreSpecified = false;
 	private String prefixToIgnore = null;
+	// converters hold the tokenizer state, each thread calling process() gets its own one
+	private ThreadLocal<JSONToTupleConverter> converter = null;
+	private int threads = 1;
+	// conversions that run or wait for submission in input order, only used with more than one thread
+	private ExecutorService workers = null;
+	private final ArrayDeque<Conversion> pending = new ArrayDeque<Conversion>();
+	private final Object submitLock = new Object();
+	private Semaphore pendingPermits = null;
+	private int maxPending = 0;
+	private volatile Throwable failure = null;
+	// errors are counted, only some of them are logged when every tuple fails
+	private ConversionErrorLog errors = null;
+	private long errorLogInterval = ConversionErrorLog.DEFAULT_INTERVAL_MILLIS;
+
+	private final DocumentMetrics metrics = new DocumentMetrics();
+	private Metric keysMatched;
+	private Metric keysDropped;
+	private Metric parseErrors;
+	private Metric conversionErrors;
 	
-	@Parameter(name=INPUT_JSON_ATTRIBUTE_PARAM,optional=true, description="The input stream attribute (not the name of the attribute) which contains the input JSON string. This attribute must be of `rstring` or `ustring` type. Default is the sole input attribute when the schema has one attribute otherwise `jsonString`. Replaces parameter `jsonStringAttribute`.")
-	public void setInputJson(TupleAttribute<Tuple,String> in) {
+	@Parameter(name=INPUT_JSON_ATTRIBUTE_PARAM,optional=true, description="The input stream attribute (not the name of the attribute) which contains the input JSON string. This attribute must be of `rstring`, `ustring` or `blob` type, a `blob` contains the UTF-8 encoded JSON string. Default is the sole input attribute when the schema has one attribute otherwise `jsonString`. Replaces parameter `jsonStringAttribute`.")
+	public void setInputJson(TupleAttribute<Tuple,?> in) {
 		inputJsonAttribute = in;
 	}
 	
 	@Parameter(optional=true, description="Deprecated.  Use `"+INPUT_JSON_ATTRIBUTE_PARAM+"` instead. Name of the input stream attribute which contains the JSON string. " +
-			"This attribute must be of `rstring` or `ustring` type. Default is the sole input attribute when the schema has one attribute otherwise `jsonString`.")
+			"This attribute must be of `rstring`, `ustring` or `blob` type. Default is the sole input attribute when the schema has one attribute otherwise `jsonString`.")
 	public void setJsonStringAttribute(String value) {
 		this.jsonStringAttribute = value;
 	}
@@ -110,7 +142,72 @@ public class JSONToTuple extends AbstractOperator
 		this.prefixToIgnore = value;
 		wasPrefixToIgnoreSpecified=true;
 	}	
+
+	@Parameter(optional=true, description=
+			"Number of threads that parse and convert the JSON strings. " +
+			"With more than one thread, the JSON strings of consecutive tuples are converted in parallel " +
+			"and the output tuples are submitted in the order of the input tuples. " +
+			"Tuples with JSON that cannot be parsed are submitted on the optional output port in the same order. " +
+			"Default is 1, where the JSON string is converted on the thread that delivers the input tuple.")
+	public void setThreads(int value) {
+		this.threads = value;
+	}
+
+	@Parameter(optional=true, description=
+			"Minimum time in milliseconds between two logged conversion errors. " +
+			"The first JSON string that cannot be converted is logged, further errors within the interval are counted " +
+			"by kind and the counts are logged with the next error after the interval. " +
+			"A logged error shows the first 64 characters of the JSON string and the position of a parse error. " +
+			"Use 0 to log every error. Default is 10000.")
+	public void setErrorLogInterval(long value) {
+		this.errorLogInterval = value;
+	}
 	
+	@CustomMetric(name="nDocuments", kind=Metric.Kind.COUNTER, description="Number of JSON strings converted.")
+	public void setDocumentsMetric(Metric metric) {
+		metrics.documents = metric;
+	}
+
+	@CustomMetric(name="nBytesIn", kind=Metric.Kind.COUNTER, description="Number of bytes of the JSON strings converted, characters for `ustring` input.")
+	public void setBytesInMetric(Metric metric) {
+		metrics.bytes = metric;
+	}
+
+	@CustomMetric(name="maxDocumentSize", kind=Metric.Kind.GAUGE, description="Size of the largest JSON string converted.")
+	public void setMaxDocumentSizeMetric(Metric metric) {
+		metrics.maxDocumentSize = metric;
+	}
+
+	@CustomMetric(name="avgDocumentSize", kind=Metric.Kind.GAUGE, description="Average size of the JSON strings converted.")
+	public void setAvgDocumentSizeMetric(Metric metric) {
+		metrics.avgDocumentSize = metric;
+	}
+
+	@CustomMetric(name="parseTimeNanos", kind=Metric.Kind.TIME, description="Time in nanoseconds spent converting the JSON strings into tuples.")
+	public void setParseTimeMetric(Metric metric) {
+		metrics.time = metric;
+	}
+
+	@CustomMetric(name="nKeysMatched", kind=Metric.Kind.COUNTER, description="Number of JSON object keys with a matching attribute.")
+	public void setKeysMatchedMetric(Metric metric) {
+		keysMatched = metric;
+	}
+
+	@CustomMetric(name="nKeysDropped", kind=Metric.Kind.COUNTER, description="Number of JSON object keys without matching attribute, their values are ignored.")
+	public void setKeysDroppedMetric(Metric metric) {
+		keysDropped = metric;
+	}
+
+	@CustomMetric(name="nParseErrors", kind=Metric.Kind.COUNTER, description="Number of JSON strings that are not valid JSON.")
+	public void setParseErrorsMetric(Metric metric) {
+		parseErrors = metric;
+	}
+
+	@CustomMetric(name="nConversionErrors", kind=Metric.Kind.COUNTER, description="Number of valid JSON strings with values that cannot be converted to the attribute types.")
+	public void setConversionErrorsMetric(Metric metric) {
+		conversionErrors = metric;
+	}
+
 	@ContextCheck
 	public static boolean checkOptionalPortSchema(OperatorContextChecker checker) {
 		if(checker.getOperatorContext().getNumberOfStreamingOutputs() == 2) {
@@ -140,11 +237,16 @@ public class JSONToTuple extends AbstractOperator
 				jsonStringAttribute = defaultJsonStringAttribute;
 			}
 		}
-		if (inputJsonAttribute == null) {
-			TupleTypeVerifier.verifyAttributeType(ssIp0, jsonStringAttribute, types).getMetaType();
+		if (inputJsonAttribute != null) {
+			jsonStringAttribute = inputJsonAttribute.getAttribute().getName();
 		}
+		// rstring and blob input is parsed from its UTF-8 bytes
+		MetaType inputType = TupleTypeVerifier.verifyAttributeType(ssIp0, jsonStringAttribute, 
+				Arrays.asList(MetaType.RSTRING, MetaType.USTRING, MetaType.BLOB)).getMetaType();
+		jsonInputIndex = ssIp0.getAttribute(jsonStringAttribute).getIndex();
 		if(jsonStringOutputAttribute!=null) {
-			TupleTypeVerifier.verifyAttributeType(ssOp0, jsonStringOutputAttribute, types).getMetaType();
+			MetaType outputType = TupleTypeVerifier.verifyAttributeType(ssOp0, jsonStringOutputAttribute, types).getMetaType();
+			copyRString = (inputType == MetaType.RSTRING && outputType == MetaType.RSTRING);
 		}
 
 		if(wasTargetSpecified) {
@@ -152,66 +254,236 @@ public class JSONToTuple extends AbstractOperator
 	 					Arrays.asList(MetaType.TUPLE, MetaType.LIST, MetaType.BLIST, MetaType.SET, MetaType.BSET));
 			l.log(TraceLevel.INFO, "Will populate target field: " + targetAttribute); //$NON-NLS-1$
 		}
-		if (wasPrefixToIgnoreSpecified) {
-			JSONToTupleConverter.setPrefixToIgnore(this.prefixToIgnore);
+		final String prefix = wasPrefixToIgnoreSpecified ? prefixToIgnore : null;
+		converter = new ThreadLocal<JSONToTupleConverter>() {
+			@Override
+			protected JSONToTupleConverter initialValue() {
+				return new JSONToTupleConverter(prefix);
+			}
+		};
+
+		errors = new ConversionErrorLog(errorLogInterval);
+
+		if(threads < 1) {
+			throw new Exception("Parameter threads must be at least 1: " + threads); //$NON-NLS-1$
+		}
+		if(threads > 1) {
+			// up to four tuples per thread are in flight, process() blocks when all are used
+			maxPending = threads * 4;
+			pendingPermits = new Semaphore(maxPending);
+			workers = Executors.newFixedThreadPool(threads, op.getThreadFactory());
+			l.log(TraceLevel.INFO, "Converting JSON with threads: " + threads); //$NON-NLS-1$
 		}
 	}
 
 	public void process(StreamingInput<Tuple> stream, Tuple tuple) throws Exception {
-		String jsonInput;
-		if (inputJsonAttribute != null) {
-			jsonInput = inputJsonAttribute.getValue(tuple);
+		// String, RString or Blob, depending on the attribute type
+		Object jsonInput = tuple.getObject(jsonInputIndex);
+
+		if(workers == null) {
+			OutputTuple op = null;
+			Exception error = null;
+			try {
+				op = convert(tuple, jsonInput);
+			} catch(Exception e) {
+				error = e;
+			}
+			submit(tuple, jsonInput, op, error);
+			return;
 		}
-		else {
-			jsonInput = tuple.getString(jsonStringAttribute);
+
+		checkFailure();
+		pendingPermits.acquire();
+		Conversion conversion = new Conversion(tuple, jsonInput);
+		synchronized(pending) {
+			pending.addLast(conversion);
+		}
+		workers.execute(conversion);
+	}
+
+	/**
+	 * Window punctuation and the final marker are forwarded after all
+	 * tuples received before them are submitted.
+	 */
+	@Override
+	public void processPunctuation(StreamingInput<Tuple> stream, Punctuation mark) throws Exception {
+		if(workers != null) {
+			pendingPermits.acquire(maxPending);
+			pendingPermits.release(maxPending);
+			checkFailure();
+		}
+		super.processPunctuation(stream, mark);
+	}
+
+	@Override
+	public void shutdown() throws Exception {
+		if(workers != null) {
+			workers.shutdownNow();
 		}
-		StreamingOutput<OutputTuple> ops = getOutput(0);
-		OutputTuple op = ops.newTuple();
+		super.shutdown();
+	}
+
+	private OutputTuple convert(Tuple tuple, Object jsonInput) throws Exception {
+		OutputTuple op = getOutput(0).newTuple();
 		op.assign(tuple);//copy over any relevant attributes
 
 		if(l.isLoggable(TraceLevel.DEBUG))
-			l.log(TraceLevel.DEBUG, "Converting JSON: " + jsonInput); //$NON-NLS-1$
+			l.log(TraceLevel.DEBUG, "Converting JSON: " + jsonText(jsonInput)); //$NON-NLS-1$
 
+		JSONToTupleConverter jtc = converter.get();
+		long start = System.nanoTime();
 		try {
-			if( targetAttribute != null &&  targetAttrType.getMetaType() != MetaType.TUPLE) {
-				//in this mode, the incoming json string is expected to be an array
-				JSONArray jsonArr = JSONArray.parse(jsonInput);
-				Object collectionObj = JSONToTupleConverter.jsonToAttribute(targetAttribute, targetAttrType, jsonArr, null);
-				if(collectionObj != null)
-					op.setObject(targetAttribute, collectionObj);
+			if(jsonInput instanceof RString) {
+				byte[] data = ((RString)jsonInput).getData();
+				jtc.convert(data, 0, data.length, op, targetAttribute);
+			}
+			else if(jsonInput instanceof Blob) {
+				byte[] data = ((Blob)jsonInput).getData();
+				jtc.convert(data, 0, data.length, op, targetAttribute);
 			}
 			else {
-				JSONObject jsonObj = JSONObject.parse(jsonInput);
-				if(targetAttribute == null) {
-					final Map<String, Object> attributeMap = JSONToTupleConverter.jsonToAtributeMap(jsonObj, op.getStreamSchema());
-					if (!attributeMap.isEmpty())
-					    for (String name : attributeMap.keySet())
-					    	op.setObject(name, attributeMap.get(name));
+				jtc.convert((String)jsonInput, op, targetAttribute);
+			}
+		} finally {
+			// documents that cannot be converted are counted as well, like by NativeJSONToTuple
+			metrics.addDocument(sizeOf(jsonInput), System.nanoTime() - start);
+			keysMatched.incrementValue(jtc.getKeysMatched());
+			keysDropped.incrementValue(jtc.getKeysDropped());
+		}
+
+		if(jsonStringOutputAttribute!= null) {
+			if(copyRString)
+				op.setObject(jsonStringOutputAttribute, jsonInput);
+			else
+				op.setString(jsonStringOutputAttribute, jsonText(jsonInput));
+		}
+		return op;
+	}
+
+	/*
+	 * The JSON string for logging and for the JSON string output attribute
+	 */
+	private static String jsonText(Object jsonInput) {
+		if(jsonInput instanceof Blob)
+			return new String(((Blob)jsonInput).getData(), UTF8);
+		return jsonInput.toString();
+	}
+
+	/*
+	 * Start of the JSON string for the error log, the whole string may be large or sensitive
+	 */
+	private static String logPrefix(Object jsonInput) {
+		String prefix;
+		if(jsonInput instanceof RString || jsonInput instanceof Blob) {
+			byte[] data = jsonInput instanceof RString ? ((RString)jsonInput).getData() : ((Blob)jsonInput).getData();
+			prefix = new String(data, 0, Math.min(data.length, LOG_PREFIX_LENGTH), UTF8);
+		}
+		else {
+			String text = (String)jsonInput;
+			prefix = text.substring(0, Math.min(text.length(), LOG_PREFIX_LENGTH));
+		}
+		return sizeOf(jsonInput) > LOG_PREFIX_LENGTH ? prefix + "..." : prefix; //$NON-NLS-1$
+	}
+
+	/*
+	 * Size of the JSON string for the metrics, bytes of rstring and blob, characters of ustring
+	 */
+	private static long sizeOf(Object jsonInput) {
+		if(jsonInput instanceof RString)
+			return ((RString)jsonInput).getLength();
+		if(jsonInput instanceof Blob)
+			return ((Blob)jsonInput).getLength();
+		return ((String)jsonInput).length();
+	}
+
+	private void submit(Tuple tuple, Object jsonInput, OutputTuple op, Exception error) throws Exception {
+		if(error == null) {
+			getOutput(0).submit(op);
+			return;
+		}
+		if(error instanceof JSONParseException)
+			parseErrors.increment();
+		else
+			conversionErrors.increment();
+		if(errors.add(error)) {
+			String position = error instanceof JSONParseException ? " at position " + ((JSONParseException)error).getPosition() : ""; //$NON-NLS-1$ //$NON-NLS-2$
+			l.log(TraceLevel.ERROR, "Error Converting String of length " + sizeOf(jsonInput) + " starting with " + logPrefix(jsonInput) //$NON-NLS-1$ //$NON-NLS-2$
+					+ ", " + ConversionErrorLog.kindOf(error) + position + errors.summary(), error); //$NON-NLS-1$
+		}
+		if(!hasOptionalOut && !ignoreParsingError)
+			throw error;
+		if(hasOptionalOut) {
+			StreamingOutput<OutputTuple> op1 = getOutput(1);
+			op1.submit(tuple);
+		}
+	}
+
+	/*
+	 * Errors that fail the operator are thrown on the input port thread, like without worker threads
+	 */
+	private void checkFailure() throws Exception {
+		Throwable f = failure;
+		if(f instanceof Error)
+			throw (Error)f;
+		if(f != null)
+			throw (Exception)f;
+	}
+
+	/*
+	 * Submits the completed conversions at the head of the pending queue. Called by the worker
+	 * that completed a conversion, the submit lock keeps the order when workers complete at the same time.
+	 */
+	private void submitCompleted() {
+		synchronized(submitLock) {
+			for(;;) {
+				Conversion head;
+				synchronized(pending) {
+					head = pending.peekFirst();
+					if(head == null || !head.done)
+						return;
+					pending.removeFirst();
 				}
-				else {
-					Tuple tup = JSONToTupleConverter.jsonToTuple(jsonObj, ((TupleType)targetAttrType).getTupleSchema());
-					if(tup!=null)
-						op.setTuple(targetAttribute, tup);
+				try {
+					if(failure == null)
+						submit(head.tuple, head.jsonInput, head.output, head.error);
+				} catch(Throwable t) {
+					failure = t;
+				} finally {
+					pendingPermits.release();
 				}
 			}
-			
-			
-			if(jsonStringOutputAttribute!= null) {
-				op.setString(jsonStringOutputAttribute, jsonInput);
-			}
+		}
+	}
+
+	private final class Conversion implements Runnable {
+		final Tuple tuple;
+		final Object jsonInput;
+		OutputTuple output;
+		Exception error;
+		volatile boolean done = false;
+
+		Conversion(Tuple tuple, Object jsonInput) {
+			this.tuple = tuple;
+			this.jsonInput = jsonInput;
+		}
 
-			
-		} catch(Exception e) {
-			l.log(TraceLevel.ERROR, "Error Converting String: " + jsonInput, e); //$NON-NLS-1$
-			if(!hasOptionalOut && !ignoreParsingError)
-				throw e;
-			if(hasOptionalOut) {
-				StreamingOutput<OutputTuple> op1 = getOutput(1);
-				op1.submit(tuple);
+		/*
+		 * An Error of the conversion fails the operator, the conversion is completed
+		 * nevertheless so that the input port thread does not wait for it
+		 */
+		public void run() {
+			try {
+				output = convert(tuple, jsonInput);
+			} catch(Exception e) {
+				error = e;
+			} catch(Throwable t) {
+				if(failure == null)
+					failure = t;
+			} finally {
+				done = true;
+				submitCompleted();
 			}
-                        return;
 		}
-        	ops.submit(op);
 	}
 
 	static final String DESC = 
@@ -20,6 +20,8 @@ import com.ibm.streams.operator.TupleAttribute;
 import com.ibm.streams.operator.Type;
 import com.ibm.streams.operator.Type.MetaType;
 import com.ibm.streams.operator.logging.TraceLevel;
+import com.ibm.streams.operator.metrics.Metric;
+import com.ibm.streams.operator.model.CustomMetric;
 import com.ibm.streams.operator.model.InputPortSet;
 import com.ibm.streams.operator.model.InputPorts;
 import com.ibm.streams.operator.model.Libraries;
@@ -27,6 +29,7 @@ import com.ibm.streams.operator.model.OutputPortSet;
 import com.ibm.streams.operator.model.OutputPorts;
 import com.ibm.streams.operator.model.Parameter;
 import com.ibm.streams.operator.model.PrimitiveOperator;
+import com.ibm.streamsx.json.converters.JSONByteWriter;
 import com.ibm.streamsx.json.converters.TupleToJSONConverter;
 import com.ibm.streamsx.json.converters.TupleTypeVerifier;
 
@@ -44,6 +47,18 @@ public class TupleToJSON extends AbstractOperator {
 	private Type rootAttributeType =null;
 	private boolean wasPrefixToIgnoreSpecified = false;
 	private String prefixToIgnore = null;
+	private TupleToJSONConverter converter = null;
+	private int jsonStringIndex;
+	private MetaType jsonStringType;
+	// reused buffer for the JSON text, one per thread calling process
+	private final ThreadLocal<JSONByteWriter> writer = new ThreadLocal<JSONByteWriter>() {
+		@Override
+		protected JSONByteWriter initialValue() {
+			return new JSONByteWriter();
+		}
+	};
+	
+	private final DocumentMetrics metrics = new DocumentMetrics();
 	
 	private static Logger l = Logger.getLogger(TupleToJSON.class.getCanonicalName());
 
@@ -55,7 +70,7 @@ public class TupleToJSON extends AbstractOperator {
 	}
 	
 	@Parameter(optional=true, 
-			description="Name of the output stream attribute where the JSON string will be populated. Default is `jsonString`.")
+			description="Name of the output stream attribute where the JSON string will be populated. Required type is `rstring`, `ustring` or `blob`, a `blob` attribute is set to the UTF-8 encoded JSON string. Default is `jsonString`.")
 	public void setJsonStringAttribute(String value) {
 		this.jsonStringAttribute = value;
 	}
@@ -84,6 +99,31 @@ public class TupleToJSON extends AbstractOperator {
 		wasPrefixToIgnoreSpecified=true;
 	}
 	
+	@CustomMetric(name="nDocuments", kind=Metric.Kind.COUNTER, description="Number of JSON strings created.")
+	public void setDocumentsMetric(Metric metric) {
+		metrics.documents = metric;
+	}
+
+	@CustomMetric(name="nBytesOut", kind=Metric.Kind.COUNTER, description="Number of UTF-8 bytes of the JSON strings created.")
+	public void setBytesOutMetric(Metric metric) {
+		metrics.bytes = metric;
+	}
+
+	@CustomMetric(name="maxDocumentSize", kind=Metric.Kind.GAUGE, description="Size in UTF-8 bytes of the largest JSON string created.")
+	public void setMaxDocumentSizeMetric(Metric metric) {
+		metrics.maxDocumentSize = metric;
+	}
+
+	@CustomMetric(name="avgDocumentSize", kind=Metric.Kind.GAUGE, description="Average size in UTF-8 bytes of the JSON strings created.")
+	public void setAvgDocumentSizeMetric(Metric metric) {
+		metrics.avgDocumentSize = metric;
+	}
+
+	@CustomMetric(name="serializeTimeNanos", kind=Metric.Kind.TIME, description="Time in nanoseconds spent serializing the tuples into JSON strings.")
+	public void setSerializeTimeMetric(Metric metric) {
+		metrics.time = metric;
+	}
+
 	@Override
 	public void initialize(OperatorContext op) throws Exception {
 		super.initialize(op);
@@ -100,8 +140,9 @@ public class TupleToJSON extends AbstractOperator {
 				jsonStringAttribute = ssop.getAttribute(0).getName();
 			}
 		}
-		TupleTypeVerifier.verifyAttributeType(ssop, jsonStringAttribute, 
-				Arrays.asList(MetaType.RSTRING, MetaType.USTRING));
+		jsonStringType = TupleTypeVerifier.verifyAttributeType(ssop, jsonStringAttribute, 
+				Arrays.asList(MetaType.RSTRING, MetaType.USTRING, MetaType.BLOB)).getMetaType();
+		jsonStringIndex = ssop.getAttribute(jsonStringAttribute).getIndex();
 
 		StreamSchema ssip = getInput(0).getStreamSchema();
 	
@@ -114,22 +155,37 @@ public class TupleToJSON extends AbstractOperator {
 					Arrays.asList(MetaType.TUPLE, MetaType.LIST, MetaType.BLIST, MetaType.SET, MetaType.BSET));
 			l.log(TraceLevel.INFO, "Will use source attribute: " + rootAttribute); //$NON-NLS-1$
 		}
+		converter = new TupleToJSONConverter(wasPrefixToIgnoreSpecified ? prefixToIgnore : null);
 	}
 
 	public void process(StreamingInput<Tuple> stream, Tuple tuple) throws Exception 	{
 		StreamingOutput<OutputTuple> ops = getOutput(0);
-		final String jsonData;
+		JSONByteWriter out = writer.get();
+		long start = System.nanoTime();
+		out.reset();
 		if(rootAttribute == null) 
-			jsonData = TupleToJSONConverter.convertTuple(tuple);
+			converter.encode(tuple, out);
 		else {
 			if(rootAttributeType.getMetaType() == MetaType.TUPLE)
-				jsonData = TupleToJSONConverter.convertTuple(tuple.getTuple(rootAttribute));
+				converter.encode(tuple.getTuple(rootAttribute), out);
 			else 
-				jsonData = TupleToJSONConverter.convertArray(tuple, rootAttribute);
+				converter.encodeAttribute(tuple, rootAttribute, out);
 		}
+		metrics.addDocument(out.size(), System.nanoTime() - start);
 		OutputTuple op = ops.newTuple();
 		op.assign(tuple);//copy over all relevant attributes form the source tuple
-		op.setString(jsonStringAttribute, ((wasPrefixToIgnoreSpecified) ? jsonData.replaceAll("\""+this.prefixToIgnore, "\"") : jsonData));
+		// rstring and blob are set from the UTF-8 bytes without decoding them
+		switch(jsonStringType) {
+		case RSTRING:
+			op.setObject(jsonStringIndex, out.toRString());
+			break;
+		case BLOB:
+			op.setBlob(jsonStringIndex, out.toBlob());
+			break;
+		default:
+			op.setString(jsonStringIndex, out.toString());
+			break;
+		}
 		ops.submit(op);
 	}
 
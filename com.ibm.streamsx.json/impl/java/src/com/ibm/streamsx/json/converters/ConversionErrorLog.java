@@ -0,0 +1,141 @@
+package com.ibm.streamsx.json.converters;
+
+import java.util.Map;
+import java.util.TreeMap;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Counts the JSON strings that cannot be converted and limits how often they are logged.
+ * <p>
+ * When a producer sends malformed JSON, every tuple fails and logging each of them with
+ * its JSON string and stack trace slows the operator down far more than the conversion.
+ * The first error is logged, and further errors at most once per interval, together with
+ * the number of errors that were not logged since and the counts by kind of error, like
+ * the ParseErrorLog of the native functions. The kind of an invalid JSON string is the reason
+ * of the {@link JSONParseException}, the kind of another error its exception class. The counts
+ * are kept for the lifetime of the instance. Instances are thread safe.
+ */
+public final class ConversionErrorLog {
+
+	/** Default minimum time between two logged errors */
+	public static final long DEFAULT_INTERVAL_MILLIS = 10000;
+
+	private final long intervalNanos;
+	private long errors = 0;
+	private long invalidJSON = 0;
+	private final Map<String, Long> counts = new TreeMap<String, Long>();
+	private long notLogged = 0;
+	private int firstPosition = -1;
+	private int lastPosition = -1;
+	private boolean logged = false;
+	private long lastLogged;
+
+	/**
+	 * Creates an error log that logs at most one error per {@link #DEFAULT_INTERVAL_MILLIS}.
+	 */
+	public ConversionErrorLog() {
+		this(DEFAULT_INTERVAL_MILLIS);
+	}
+
+	/**
+	 * @param intervalMillis Minimum time between two logged errors, 0 logs all errors.
+	 */
+	public ConversionErrorLog(long intervalMillis) {
+		this.intervalNanos = TimeUnit.MILLISECONDS.toNanos(intervalMillis);
+	}
+
+	/**
+	 * Counts a conversion error.
+	 * @param error The exception thrown by the conversion.
+	 * @return {@code true} if the error is to be logged, with {@link #summary()} appended to the message.
+	 */
+	public synchronized boolean add(Exception error) {
+		errors++;
+		String kind = kindOf(error);
+		Long count = counts.get(kind);
+		counts.put(kind, count == null ? 1 : count + 1);
+		if(error instanceof JSONParseException) {
+			invalidJSON++;
+			int position = ((JSONParseException)error).getPosition();
+			if(firstPosition < 0)
+				firstPosition = position;
+			lastPosition = position;
+		}
+
+		long now = System.nanoTime();
+		if(logged && now - lastLogged < intervalNanos) {
+			notLogged++;
+			return false;
+		}
+		logged = true;
+		lastLogged = now;
+		return true;
+	}
+
+	/**
+	 * Returns the counts of the errors since the last logged error and resets them.
+	 * @return Text to append to the logged error, empty if all errors were logged.
+	 */
+	public synchronized String summary() {
+		if(notLogged == 0)
+			return ""; //$NON-NLS-1$
+
+		StringBuilder summary = new StringBuilder();
+		summary.append(" (").append(notLogged).append(" errors not logged since the last logged error, ") //$NON-NLS-1$ //$NON-NLS-2$
+				.append(errors).append(" errors in total:"); //$NON-NLS-1$
+		for(Map.Entry<String, Long> count : counts.entrySet())
+			summary.append(' ').append(count.getKey()).append('=').append(count.getValue());
+		if(firstPosition >= 0)
+			summary.append(", first at position ").append(firstPosition).append(", last at position ").append(lastPosition); //$NON-NLS-1$ //$NON-NLS-2$
+		summary.append(')');
+		notLogged = 0;
+		return summary.toString();
+	}
+
+	/**
+	 * @param error The exception thrown by the conversion.
+	 * @return The kind of the error the errors are counted by.
+	 */
+	public static String kindOf(Exception error) {
+		if(error instanceof JSONParseException)
+			return ((JSONParseException)error).getReason();
+		return error.getClass().getSimpleName();
+	}
+
+	/**
+	 * @return The number of errors.
+	 */
+	public synchronized long getErrorCount() {
+		return errors;
+	}
+
+	/**
+	 * @return The number of errors caused by invalid JSON, the other errors are caused by values that cannot be converted.
+	 */
+	public synchronized long getInvalidJSONCount() {
+		return invalidJSON;
+	}
+
+	/**
+	 * @param kind Kind of error, see {@link #kindOf(Exception)}.
+	 * @return The number of errors of this kind.
+	 */
+	public synchronized long getCount(String kind) {
+		Long count = counts.get(kind);
+		return count == null ? 0 : count;
+	}
+
+	/**
+	 * @return The position of the error in the first invalid JSON string, -1 if there was none.
+	 */
+	public synchronized int getFirstPosition() {
+		return firstPosition;
+	}
+
+	/**
+	 * @return The position of the error in the last invalid JSON string, -1 if there was none.
+	 */
+	public synchronized int getLastPosition() {
+		return lastPosition;
+	}
+}
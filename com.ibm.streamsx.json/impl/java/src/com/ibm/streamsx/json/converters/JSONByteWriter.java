@@ -0,0 +1,248 @@
+package com.ibm.streamsx.json.converters;
+
+import java.nio.charset.Charset;
+import java.util.Arrays;
+
+import com.ibm.streams.operator.types.Blob;
+import com.ibm.streams.operator.types.RString;
+import com.ibm.streams.operator.types.ValueFactory;
+
+/**
+ * Reusable buffer that JSON text is written to as UTF-8 bytes.
+ * <p>
+ * Numbers, literals and the UTF-8 bytes of rstring values are written without
+ * creating objects. The buffer grows as needed and is kept across {@link #reset()}.
+ * A writer instance is not thread safe.
+ */
+public final class JSONByteWriter {
+
+	private static final Charset UTF8 = Charset.forName("UTF-8"); //$NON-NLS-1$
+	private static final byte[] HEX = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
+	private static final byte[] TRUE = { 't', 'r', 'u', 'e' };
+	private static final byte[] FALSE = { 'f', 'a', 'l', 's', 'e' };
+	private static final byte[] NULL = { 'n', 'u', 'l', 'l' };
+
+	private byte[] buffer = new byte[1024];
+	private int size;
+	// digits of a number in reverse order
+	private final byte[] digits = new byte[20];
+
+	/**
+	 * Discards the written JSON text.
+	 */
+	public void reset() {
+		size = 0;
+	}
+
+	/**
+	 * @return The number of bytes written.
+	 */
+	public int size() {
+		return size;
+	}
+
+	/**
+	 * @return The JSON text as rstring.
+	 */
+	public RString toRString() {
+		return new RString(Arrays.copyOf(buffer, size));
+	}
+
+	/**
+	 * @return The JSON text as blob.
+	 */
+	public Blob toBlob() {
+		return ValueFactory.newBlob(buffer, 0, size);
+	}
+
+	@Override
+	public String toString() {
+		return new String(buffer, 0, size, UTF8);
+	}
+
+	private void ensure(int length) {
+		if(size + length > buffer.length)
+			buffer = Arrays.copyOf(buffer, Math.max(size + length, buffer.length * 2));
+	}
+
+	public void write(byte b) {
+		ensure(1);
+		buffer[size++] = b;
+	}
+
+	public void write(byte[] bytes) {
+		ensure(bytes.length);
+		System.arraycopy(bytes, 0, buffer, size, bytes.length);
+		size += bytes.length;
+	}
+
+	/**
+	 * Writes JSON text that is already serialized, like keys or values encoded by JSONEncoding.
+	 */
+	public void writeRaw(String json) {
+		write(json.getBytes(UTF8));
+	}
+
+	public void writeNull() {
+		write(NULL);
+	}
+
+	public void writeBoolean(boolean value) {
+		write(value ? TRUE : FALSE);
+	}
+
+	public void writeLong(long value) {
+		if(value < 0) {
+			write((byte)'-');
+			if(value == Long.MIN_VALUE) {
+				writeUnsignedLong(value);
+				return;
+			}
+			value = -value;
+		}
+		writeUnsignedLong(value);
+	}
+
+	/**
+	 * Writes the value as unsigned 64 bit integer.
+	 */
+	public void writeUnsignedLong(long value) {
+		int n = 0;
+		// the first digit of values above Long.MAX_VALUE is computed unsigned
+		if(value < 0) {
+			long quotient = (value >>> 1) / 5;
+			digits[n++] = (byte)('0' + (value - quotient * 10));
+			value = quotient;
+		}
+		do {
+			digits[n++] = (byte)('0' + (value % 10));
+			value /= 10;
+		} while(value != 0);
+
+		ensure(n);
+		while(n > 0)
+			buffer[size++] = digits[--n];
+	}
+
+	/**
+	 * Writes the value like {@link Float#toString(float)}, NaN and infinity as null
+	 * because JSON has no literal for them.
+	 */
+	public void writeFloat(float value) {
+		if(Float.isNaN(value) || Float.isInfinite(value))
+			writeNull();
+		else
+			writeAscii(Float.toString(value));
+	}
+
+	/**
+	 * Writes the value like {@link Double#toString(double)}, NaN and infinity as null
+	 * because JSON has no literal for them.
+	 */
+	public void writeDouble(double value) {
+		if(Double.isNaN(value) || Double.isInfinite(value))
+			writeNull();
+		else
+			writeAscii(Double.toString(value));
+	}
+
+	private void writeAscii(String s) {
+		int length = s.length();
+		ensure(length);
+		for(int i = 0; i < length; i++)
+			buffer[size++] = (byte)s.charAt(i);
+	}
+
+	/**
+	 * Writes a JSON string, the characters are encoded as UTF-8.
+	 */
+	public void writeString(String s) {
+		int length = s.length();
+		// at most 3 bytes per char, a surrogate pair is 4 bytes for 2 chars
+		ensure(length * 3 + 2);
+		buffer[size++] = '"';
+		for(int i = 0; i < length; i++) {
+			char c = s.charAt(i);
+			if(c < 0x80) {
+				if(c < 0x20 || c == '"' || c == '\\') {
+					writeEscape(c);
+					ensure((length - i) * 3 + 1);
+				}
+				else {
+					buffer[size++] = (byte)c;
+				}
+			}
+			else if(c < 0x800) {
+				buffer[size++] = (byte)(0xc0 | (c >> 6));
+				buffer[size++] = (byte)(0x80 | (c & 0x3f));
+			}
+			else if(Character.isHighSurrogate(c) && i + 1 < length && Character.isLowSurrogate(s.charAt(i + 1))) {
+				int cp = Character.toCodePoint(c, s.charAt(++i));
+				buffer[size++] = (byte)(0xf0 | (cp >> 18));
+				buffer[size++] = (byte)(0x80 | ((cp >> 12) & 0x3f));
+				buffer[size++] = (byte)(0x80 | ((cp >> 6) & 0x3f));
+				buffer[size++] = (byte)(0x80 | (cp & 0x3f));
+			}
+			else {
+				buffer[size++] = (byte)(0xe0 | (c >> 12));
+				buffer[size++] = (byte)(0x80 | ((c >> 6) & 0x3f));
+				buffer[size++] = (byte)(0x80 | (c & 0x3f));
+			}
+		}
+		buffer[size++] = '"';
+	}
+
+	/**
+	 * Writes a JSON string from UTF-8 bytes, like the data of an rstring.
+	 */
+	public void writeString(byte[] utf8) {
+		int length = utf8.length;
+		ensure(length + 2);
+		buffer[size++] = '"';
+		for(int i = 0; i < length; i++) {
+			byte b = utf8[i];
+			// bytes of multi-byte sequences are negative and copied
+			if(b >= 0 && (b < 0x20 || b == '"' || b == '\\')) {
+				writeEscape((char)b);
+				ensure(length - i + 1);
+			}
+			else {
+				buffer[size++] = b;
+			}
+		}
+		buffer[size++] = '"';
+	}
+
+	private void writeEscape(char c) {
+		ensure(6);
+		buffer[size++] = '\\';
+		switch(c) {
+		case '"':
+		case '\\':
+			buffer[size++] = (byte)c;
+			break;
+		case '\b':
+			buffer[size++] = 'b';
+			break;
+		case '\f':
+			buffer[size++] = 'f';
+			break;
+		case '\n':
+			buffer[size++] = 'n';
+			break;
+		case '\r':
+			buffer[size++] = 'r';
+			break;
+		case '\t':
+			buffer[size++] = 't';
+			break;
+		default:
+			buffer[size++] = 'u';
+			buffer[size++] = '0';
+			buffer[size++] = '0';
+			buffer[size++] = HEX[c >> 4];
+			buffer[size++] = HEX[c & 0xf];
+			break;
+		}
+	}
+}
@@ -0,0 +1,761 @@
+package com.ibm.streamsx.json.converters;
+
+import java.io.IOException;
+import java.math.BigDecimal;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collection;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.logging.Logger;
+
+import com.ibm.streams.operator.Attribute;
+import com.ibm.streams.operator.OutputTuple;
+import com.ibm.streams.operator.StreamSchema;
+import com.ibm.streams.operator.Tuple;
+import com.ibm.streams.operator.Type;
+import com.ibm.streams.operator.Type.MetaType;
+import com.ibm.streams.operator.logging.LogLevel;
+import com.ibm.streams.operator.logging.TraceLevel;
+import com.ibm.streams.operator.meta.CollectionType;
+import com.ibm.streams.operator.meta.OptionalType;
+import com.ibm.streams.operator.meta.TupleType;
+import com.ibm.streams.operator.types.RString;
+import com.ibm.streams.operator.types.Timestamp;
+import com.ibm.streamsx.json.converters.Messages;
+
+/**
+ * Converts JSON strings to SPL tuples with a conversion plan that is precompiled from the
+ * output schema.
+ * <p>
+ * The JSON string is read with a {@link JSONTokenizer} and each value is converted by the
+ * plan of the attribute or element it belongs to, without building a JSON object tree first.
+ * Primitive attributes are written directly into the output tuple, lists of primitive types
+ * are collected in primitive arrays and values without a matching attribute are skipped.
+ * <p>
+ * The conversion gives the same results as the static methods of {@link JSONToTupleConverter},
+ * plans are created and cached by {@link JSONToTupleConverter#getPlan(StreamSchema, String)}.
+ * Instances are not thread safe, each thread needs its own plan.
+ */
+public class JSONConversionPlan {
+
+	private static Logger l = Logger.getLogger(JSONConversionPlan.class.getCanonicalName());
+
+	private final TuplePlan root;
+	private final ValuePlan target;
+	private final int targetIndex;
+	private final boolean targetIsTuple;
+
+	/**
+	 * Creates the plan for the conversion to tuples with the specified schema.
+	 *
+	 * @param schema Schema of the output tuples.
+	 * @param targetAttribute Name of the attribute the JSON value is converted to, {@code null} to convert a JSON object to the whole tuple.
+	 * @param prefixToIgnore Prefix of attribute names that is not part of the JSON keys, {@code null} if there is none.
+	 */
+	public JSONConversionPlan(StreamSchema schema, String targetAttribute, String prefixToIgnore) {
+		if(targetAttribute == null) {
+			root = new TuplePlan("", schema, prefixToIgnore); //$NON-NLS-1$
+			target = null;
+			targetIndex = -1;
+			targetIsTuple = true;
+		}
+		else {
+			Attribute attr = schema.getAttribute(targetAttribute);
+			root = null;
+			target = createPlan(attr.getName(), attr.getType(), false, prefixToIgnore);
+			targetIndex = attr.getIndex();
+			targetIsTuple = (attr.getType().getMetaType() == MetaType.TUPLE);
+		}
+	}
+
+	/**
+	 * Converts a JSON string and sets the converted attributes in the output tuple.
+	 * Attributes that are not contained in the JSON string are not modified.
+	 *
+	 * @param tokenizer Tokenizer used for the JSON string.
+	 * @param json JSON object, or JSON array if the target attribute is a collection.
+	 * @param tuple Output tuple.
+	 * @throws Exception If the JSON is invalid or cannot be converted. The output tuple may be modified partially in that case.
+	 */
+	public void convert(JSONTokenizer tokenizer, String json, OutputTuple tuple) throws Exception {
+		tokenizer.reset(json);
+		convert(tokenizer, tuple);
+	}
+
+	/**
+	 * Converts a UTF-8 encoded JSON string and sets the converted attributes in the output tuple.
+	 * Attributes that are not contained in the JSON string are not modified.
+	 *
+	 * @param tokenizer Tokenizer used for the JSON string.
+	 * @param utf8 Buffer containing the JSON object, or JSON array if the target attribute is a collection.
+	 * @param offset Offset of the JSON string in the buffer.
+	 * @param length Number of bytes of the JSON string.
+	 * @param tuple Output tuple.
+	 * @throws Exception If the JSON is invalid or cannot be converted. The output tuple may be modified partially in that case.
+	 */
+	public void convert(JSONTokenizer tokenizer, byte[] utf8, int offset, int length, OutputTuple tuple) throws Exception {
+		tokenizer.reset(utf8, offset, length);
+		convert(tokenizer, tuple);
+	}
+
+	private void convert(JSONTokenizer tokenizer, OutputTuple tuple) throws Exception {
+		int token = tokenizer.next();
+
+		if(root != null) {
+			expect(tokenizer, token, JSONTokenizer.OBJECT_START, root);
+			root.readInto(tokenizer, tuple);
+		}
+		else {
+			expect(tokenizer, token, targetIsTuple ? JSONTokenizer.OBJECT_START : JSONTokenizer.ARRAY_START, target);
+			Object value = target.read(tokenizer, token);
+			if(value != null) {
+				if(targetIsTuple)
+					tuple.setTuple(targetIndex, (Tuple)value);
+				else
+					tuple.setObject(targetIndex, value);
+			}
+		}
+
+		tokenizer.next();
+	}
+
+	private static void expect(JSONTokenizer t, int token, int expected, ValuePlan plan) throws IOException {
+		if(token != expected)
+			throw new IOException("JSON " + (expected == JSONTokenizer.OBJECT_START ? "object" : "array") + " expected for " + plan.name); //$NON-NLS-1$ //$NON-NLS-2$ //$NON-NLS-3$ //$NON-NLS-4$
+	}
+
+	/*
+	 * Plans follow the type mapping of JSONToTupleConverter.jsonToAttribute(). Lists with
+	 * elements that are no collections are converted like arrayToSPLArray() unless they are
+	 * collection elements themselves, all other collections like arrayToCollection().
+	 */
+	private static ValuePlan createPlan(String name, Type type, boolean inCollection, String prefixToIgnore) {
+		boolean optional = false;
+		if(type.getMetaType() == MetaType.OPTIONAL) {
+			type = ((OptionalType)type).getValueType();
+			optional = true;
+		}
+
+		switch(type.getMetaType()) {
+		case BOOLEAN:
+		case INT8:
+		case UINT8:
+		case INT16:
+		case UINT16:
+		case INT32:
+		case UINT32:
+		case INT64:
+		case UINT64:
+		case FLOAT32:
+		case FLOAT64:
+		case DECIMAL32:
+		case DECIMAL64:
+		case DECIMAL128:
+		case USTRING:
+		case BSTRING:
+		case RSTRING:
+		case TIMESTAMP:
+			return new PrimitivePlan(name, type.getMetaType(), optional);
+
+		case LIST:
+		case BLIST:
+		{
+			Type elementType = ((CollectionType)type).getElementType();
+			ValuePlan element = createPlan("List: " + name, elementType, true, prefixToIgnore); //$NON-NLS-1$
+			if(!elementType.getMetaType().isCollectionType() && !inCollection)
+				return new ArrayPlan(name, elementType, element);
+			return new CollectionPlan(name, false, element);
+		}
+
+		case SET:
+		case BSET:
+			return new CollectionPlan(name, true, createPlan("HashSet: " + name, ((CollectionType)type).getElementType(), true, prefixToIgnore)); //$NON-NLS-1$
+
+		case TUPLE:
+			return new TuplePlan(name, ((TupleType)type).getTupleSchema(), prefixToIgnore);
+
+		default:
+			if(l.isLoggable(TraceLevel.DEBUG))
+				l.log(TraceLevel.DEBUG, "Ignoring unsupported field: " + name + ", of type: " + type); //$NON-NLS-1$ //$NON-NLS-2$
+			return new ValuePlan(name);
+		}
+	}
+
+	/**
+	 * Conversion of a JSON value. The base class skips the value.
+	 */
+	private static class ValuePlan {
+
+		final String name;
+
+		ValuePlan(String name) {
+			this.name = name;
+		}
+
+		/**
+		 * Reads the value that starts with {@code token}, which is not {@link JSONTokenizer#NULL}.
+		 * @return The converted value or {@code null} if it is ignored.
+		 */
+		Object read(JSONTokenizer t, int token) throws Exception {
+			t.skipValue(token);
+			return null;
+		}
+
+		/**
+		 * Reads the value that starts with {@code token} and sets the attribute with {@code index}.
+		 */
+		void readInto(JSONTokenizer t, int token, OutputTuple tuple, int index) throws Exception {
+			Object value = read(t, token);
+			if(value != null)
+				tuple.setObject(index, value);
+		}
+	}
+
+	private static final class PrimitivePlan extends ValuePlan {
+
+		private final MetaType type;
+		private final boolean optional;
+
+		PrimitivePlan(String name, MetaType type, boolean optional) {
+			super(name);
+			this.type = type;
+			this.optional = optional;
+		}
+
+		@Override
+		Object read(JSONTokenizer t, int token) throws Exception {
+			switch(type) {
+			case BOOLEAN:
+				return Boolean.valueOf(booleanValue(t, token));
+			case INT8:
+			case UINT8:
+				return Byte.valueOf(byteValue(t, token));
+			case INT16:
+			case UINT16:
+				return Short.valueOf(shortValue(t, token));
+			case INT32:
+			case UINT32:
+				return Integer.valueOf(intValue(t, token));
+			case INT64:
+			case UINT64:
+				return Long.valueOf(longValue(t, token));
+			case FLOAT32:
+				return Float.valueOf(floatValue(t, token));
+			case FLOAT64:
+				return Double.valueOf(doubleValue(t, token));
+			case DECIMAL32:
+			case DECIMAL64:
+			case DECIMAL128:
+			{
+				if(token == JSONTokenizer.NUMBER)
+					return t.decimalValue();
+				String s = numberText(t, token);
+				return s.isEmpty() ? new BigDecimal(0) : new BigDecimal(s);
+			}
+			case USTRING:
+				return stringValue(t, token);
+			case TIMESTAMP:
+				return Timestamp.getTimestamp(doubleValue(t, token));
+			default:
+				return new RString(stringValue(t, token));
+			}
+		}
+
+		@Override
+		void readInto(JSONTokenizer t, int token, OutputTuple tuple, int index) throws Exception {
+			if(optional) {
+				super.readInto(t, token, tuple, index);
+				return;
+			}
+			switch(type) {
+			case BOOLEAN:
+				tuple.setBoolean(index, booleanValue(t, token));
+				break;
+			case INT8:
+			case UINT8:
+				tuple.setByte(index, byteValue(t, token));
+				break;
+			case INT16:
+			case UINT16:
+				tuple.setShort(index, shortValue(t, token));
+				break;
+			case INT32:
+			case UINT32:
+				tuple.setInt(index, intValue(t, token));
+				break;
+			case INT64:
+			case UINT64:
+				tuple.setLong(index, longValue(t, token));
+				break;
+			case FLOAT32:
+				tuple.setFloat(index, floatValue(t, token));
+				break;
+			case FLOAT64:
+				tuple.setDouble(index, doubleValue(t, token));
+				break;
+			default:
+				super.readInto(t, token, tuple, index);
+				break;
+			}
+		}
+
+		/*
+		 * Strings are converted to booleans like Boolean.parseBoolean(), all other values except true are false
+		 */
+		boolean booleanValue(JSONTokenizer t, int token) throws IOException {
+			switch(token) {
+			case JSONTokenizer.TRUE:
+				return true;
+			case JSONTokenizer.STRING:
+				return t.stringEqualsIgnoreCase("true"); //$NON-NLS-1$
+			default:
+				t.skipValue(token);
+				return false;
+			}
+		}
+
+		/*
+		 * Numbers are narrowed like Number.byteValue() etc., strings are parsed and
+		 * empty strings are 0. All other values can't be converted.
+		 */
+		byte byteValue(JSONTokenizer t, int token) throws IOException {
+			if(token == JSONTokenizer.NUMBER)
+				return (byte)t.intValue();
+			String s = numberText(t, token);
+			return s.isEmpty() ? 0 : Byte.parseByte(s);
+		}
+
+		short shortValue(JSONTokenizer t, int token) throws IOException {
+			if(token == JSONTokenizer.NUMBER)
+				return (short)t.intValue();
+			String s = numberText(t, token);
+			return s.isEmpty() ? 0 : Short.parseShort(s);
+		}
+
+		int intValue(JSONTokenizer t, int token) throws IOException {
+			if(token == JSONTokenizer.NUMBER)
+				return t.intValue();
+			String s = numberText(t, token);
+			return s.isEmpty() ? 0 : Integer.parseInt(s);
+		}
+
+		long longValue(JSONTokenizer t, int token) throws IOException {
+			if(token == JSONTokenizer.NUMBER)
+				return t.longValue();
+			String s = numberText(t, token);
+			return s.isEmpty() ? 0 : Long.parseLong(s);
+		}
+
+		float floatValue(JSONTokenizer t, int token) throws IOException {
+			if(token == JSONTokenizer.NUMBER)
+				return t.isLong() ? (float)t.longValue() : (float)t.doubleValue();
+			String s = numberText(t, token);
+			return s.isEmpty() ? 0 : Float.parseFloat(s);
+		}
+
+		double doubleValue(JSONTokenizer t, int token) throws IOException {
+			if(token == JSONTokenizer.NUMBER)
+				return t.doubleValue();
+			String s = numberText(t, token);
+			return s.isEmpty() ? 0 : Double.parseDouble(s);
+		}
+
+		/*
+		 * Text of a non-numeric value that is parsed as number, which only succeeds for strings
+		 */
+		private String numberText(JSONTokenizer t, int token) throws IOException {
+			if(token == JSONTokenizer.STRING)
+				return t.getString();
+			String s = stringValue(t, token);
+			throw new NumberFormatException("For input string: \"" + s + "\""); //$NON-NLS-1$ //$NON-NLS-2$
+		}
+
+		/*
+		 * Numbers and literals as Java converts them to strings, objects and arrays as JSON text
+		 */
+		String stringValue(JSONTokenizer t, int token) throws IOException {
+			switch(token) {
+			case JSONTokenizer.STRING:
+				return t.getString();
+			case JSONTokenizer.NUMBER:
+				return t.numberString();
+			case JSONTokenizer.TRUE:
+				return "true"; //$NON-NLS-1$
+			case JSONTokenizer.FALSE:
+				return "false"; //$NON-NLS-1$
+			default:
+				return t.valueText(token);
+			}
+		}
+	}
+
+	/**
+	 * Sets and lists that are converted to collections, null values are dropped.
+	 */
+	private static final class CollectionPlan extends ValuePlan {
+
+		private final boolean set;
+		private final ValuePlan element;
+
+		CollectionPlan(String name, boolean set, ValuePlan element) {
+			super(name);
+			this.set = set;
+			this.element = element;
+		}
+
+		@Override
+		Object read(JSONTokenizer t, int token) throws Exception {
+			expect(t, token, JSONTokenizer.ARRAY_START, this);
+			Collection<Object> lst = set ? new HashSet<Object>() : new ArrayList<Object>();
+			while((token = t.next()) != JSONTokenizer.ARRAY_END) {
+				if(token == JSONTokenizer.NULL)
+					continue;
+				Object obj = element.read(t, token);
+				if(obj != null)
+					lst.add(obj);
+			}
+			return lst;
+		}
+	}
+
+	/**
+	 * Lists that are converted to Java arrays if the element type has a primitive
+	 * representation, otherwise to lists that keep null values of optional elements.
+	 */
+	private static final class ArrayPlan extends ValuePlan {
+
+		private final MetaType elementType;
+		private final boolean optional;
+		private final ValuePlan element;
+
+		// reused for the primitive elements, copied to an array of the list size
+		private byte[] bytes;
+		private short[] shorts;
+		private int[] ints;
+		private long[] longs;
+		private boolean[] booleans;
+		private float[] floats;
+		private double[] doubles;
+
+		ArrayPlan(String name, Type elementType, ValuePlan element) {
+			super(name);
+			this.optional = (elementType.getMetaType() == MetaType.OPTIONAL);
+			this.elementType = optional ? ((OptionalType)elementType).getValueType().getMetaType() : elementType.getMetaType();
+			this.element = element;
+		}
+
+		@Override
+		Object read(JSONTokenizer t, int token) throws Exception {
+			expect(t, token, JSONTokenizer.ARRAY_START, this);
+			if(l.isLoggable(TraceLevel.DEBUG)) {
+				l.log(TraceLevel.DEBUG, "Creating Array: " + name); //$NON-NLS-1$
+			}
+			if(!optional) {
+				switch(elementType) {
+				case INT8:
+					return readBytes(t);
+				case INT16:
+					return readShorts(t);
+				case INT32:
+					return readInts(t);
+				case INT64:
+					return readLongs(t);
+				case BOOLEAN:
+					return readBooleans(t);
+				case FLOAT32:
+					return readFloats(t);
+				case FLOAT64:
+					return readDoubles(t);
+				case USTRING:
+				{
+					List<Object> lst = readList(t);
+					return lst.toArray(new String[lst.size()]);
+				}
+				default:
+					break;
+				}
+			}
+			switch(elementType) {
+			case BLOB:
+			case MAP:
+			case BMAP:
+			case COMPLEX32:
+			case COMPLEX64:
+			case ENUM:
+			case XML:
+				l.log(LogLevel.ERROR, Messages.getString("UNHANDLED_ARRAY_TYPE"), new Object[]{elementType});	//$NON-NLS-1$
+				throw new Exception("CDIST0953E Unhandled array type: " + elementType); //$NON-NLS-1$
+			default:
+				return readList(t);
+			}
+		}
+
+		private List<Object> readList(JSONTokenizer t) throws Exception {
+			List<Object> lst = new ArrayList<Object>();
+			int token;
+			while((token = t.next()) != JSONTokenizer.ARRAY_END) {
+				/* as JSON array has to be seen as ordered elements
+				 * existing null values in array have to be kept and not
+				 * silently suppressed as without optionalType
+				 */
+				Object obj = (token == JSONTokenizer.NULL) ? null : element.read(t, token);
+				if(obj != null || optional)
+					lst.add(obj);
+			}
+			return lst;
+		}
+
+		private byte[] readBytes(JSONTokenizer t) throws Exception {
+			PrimitivePlan p = (PrimitivePlan)element;
+			if(bytes == null)
+				bytes = new byte[16];
+			int n = 0;
+			int token;
+			while((token = t.next()) != JSONTokenizer.ARRAY_END) {
+				if(token == JSONTokenizer.NULL)
+					continue;
+				if(n == bytes.length)
+					bytes = Arrays.copyOf(bytes, n * 2);
+				bytes[n++] = p.byteValue(t, token);
+			}
+			return Arrays.copyOf(bytes, n);
+		}
+
+		private short[] readShorts(JSONTokenizer t) throws Exception {
+			PrimitivePlan p = (PrimitivePlan)element;
+			if(shorts == null)
+				shorts = new short[16];
+			int n = 0;
+			int token;
+			while((token = t.next()) != JSONTokenizer.ARRAY_END) {
+				if(token == JSONTokenizer.NULL)
+					continue;
+				if(n == shorts.length)
+					shorts = Arrays.copyOf(shorts, n * 2);
+				shorts[n++] = p.shortValue(t, token);
+			}
+			return Arrays.copyOf(shorts, n);
+		}
+
+		private int[] readInts(JSONTokenizer t) throws Exception {
+			PrimitivePlan p = (PrimitivePlan)element;
+			if(ints == null)
+				ints = new int[16];
+			int n = 0;
+			int token;
+			while((token = t.next()) != JSONTokenizer.ARRAY_END) {
+				if(token == JSONTokenizer.NULL)
+					continue;
+				if(n == ints.length)
+					ints = Arrays.copyOf(ints, n * 2);
+				ints[n++] = p.intValue(t, token);
+			}
+			return Arrays.copyOf(ints, n);
+		}
+
+		private long[] readLongs(JSONTokenizer t) throws Exception {
+			PrimitivePlan p = (PrimitivePlan)element;
+			if(longs == null)
+				longs = new long[16];
+			int n = 0;
+			int token;
+			while((token = t.next()) != JSONTokenizer.ARRAY_END) {
+				if(token == JSONTokenizer.NULL)
+					continue;
+				if(n == longs.length)
+					longs = Arrays.copyOf(longs, n * 2);
+				longs[n++] = p.longValue(t, token);
+			}
+			return Arrays.copyOf(longs, n);
+		}
+
+		private boolean[] readBooleans(JSONTokenizer t) throws Exception {
+			PrimitivePlan p = (PrimitivePlan)element;
+			if(booleans == null)
+				booleans = new boolean[16];
+			int n = 0;
+			int token;
+			while((token = t.next()) != JSONTokenizer.ARRAY_END) {
+				if(token == JSONTokenizer.NULL)
+					continue;
+				if(n == booleans.length)
+					booleans = Arrays.copyOf(booleans, n * 2);
+				booleans[n++] = p.booleanValue(t, token);
+			}
+			return Arrays.copyOf(booleans, n);
+		}
+
+		private float[] readFloats(JSONTokenizer t) throws Exception {
+			PrimitivePlan p = (PrimitivePlan)element;
+			if(floats == null)
+				floats = new float[16];
+			int n = 0;
+			int token;
+			while((token = t.next()) != JSONTokenizer.ARRAY_END) {
+				if(token == JSONTokenizer.NULL)
+					continue;
+				if(n == floats.length)
+					floats = Arrays.copyOf(floats, n * 2);
+				floats[n++] = p.floatValue(t, token);
+			}
+			return Arrays.copyOf(floats, n);
+		}
+
+		private double[] readDoubles(JSONTokenizer t) throws Exception {
+			PrimitivePlan p = (PrimitivePlan)element;
+			if(doubles == null)
+				doubles = new double[16];
+			int n = 0;
+			int token;
+			while((token = t.next()) != JSONTokenizer.ARRAY_END) {
+				if(token == JSONTokenizer.NULL)
+					continue;
+				if(n == doubles.length)
+					doubles = Arrays.copyOf(doubles, n * 2);
+				doubles[n++] = p.doubleValue(t, token);
+			}
+			return Arrays.copyOf(doubles, n);
+		}
+	}
+
+	/**
+	 * Tuples, the attributes are found by the JSON key in an open addressing hash table.
+	 */
+	private static final class TuplePlan extends ValuePlan {
+
+		private static final class Field {
+			final char[] key;
+			final int hash;
+			final String name;
+			final int index;
+			final ValuePlan plan;
+			// attributes with the same key after the prefix is removed
+			Field same;
+
+			Field(String key, Attribute attr, ValuePlan plan) {
+				this.key = key.toCharArray();
+				this.hash = key.hashCode();
+				this.name = attr.getName();
+				this.index = attr.getIndex();
+				this.plan = plan;
+			}
+		}
+
+		private final StreamSchema schema;
+		private final Field[] fields;
+		private final Map<String, Object> values = new HashMap<String, Object>();
+
+		TuplePlan(String name, StreamSchema schema, String prefixToIgnore) {
+			super(name);
+			this.schema = schema;
+
+			int size = 2;
+			while(size < schema.getAttributeCount() * 2)
+				size <<= 1;
+			fields = new Field[size];
+
+			for(Attribute attr : schema) {
+				String key = attr.getName();
+				if ((prefixToIgnore != null) && (key.startsWith(prefixToIgnore))) {
+					key = key.substring(prefixToIgnore.length());
+				}
+				Field field = new Field(key, attr, createPlan(attr.getName(), attr.getType(), false, prefixToIgnore));
+
+				int i = field.hash & (size - 1);
+				while(fields[i] != null && !Arrays.equals(fields[i].key, field.key))
+					i = (i + 1) & (size - 1);
+				if(fields[i] == null) {
+					fields[i] = field;
+				}
+				else {
+					Field last = fields[i];
+					while(last.same != null)
+						last = last.same;
+					last.same = field;
+				}
+			}
+		}
+
+		private Field find(JSONTokenizer t) {
+			int hash = t.getStringHash();
+			for(int i = hash & (fields.length - 1); ; i = (i + 1) & (fields.length - 1)) {
+				Field field = fields[i];
+				if(field == null || (field.hash == hash && t.stringEquals(field.key)))
+					return field;
+			}
+		}
+
+		@Override
+		Object read(JSONTokenizer t, int token) throws Exception {
+			expect(t, token, JSONTokenizer.OBJECT_START, this);
+			values.clear();
+			while(t.next() == JSONTokenizer.KEY) {
+				Field field = find(t);
+				if(field == null)
+					t.keysDropped++;
+				else
+					t.keysMatched++;
+				token = t.next();
+				if(field == null || token == JSONTokenizer.NULL) {
+					t.skipValue(token);
+					continue;
+				}
+				try {
+					Object obj = field.plan.read(t, token);
+					if(obj != null) {
+						for(Field f = field; f != null; f = f.same)
+							values.put(f.name, obj);
+					}
+				} catch(Exception e) {
+					// the error is logged once by the caller, not on every nesting level
+					if(l.isLoggable(TraceLevel.DEBUG))
+						l.log(TraceLevel.DEBUG, "Error converting object: " + field.name, e); //$NON-NLS-1$
+					throw e;
+				}
+			}
+			return schema.getTuple(values);
+		}
+
+		/**
+		 * Reads the JSON object that was started and sets the attributes of the output tuple.
+		 */
+		void readInto(JSONTokenizer t, OutputTuple tuple) throws Exception {
+			while(t.next() == JSONTokenizer.KEY) {
+				Field field = find(t);
+				if(field == null) {
+					t.keysDropped++;
+					if(l.isLoggable(TraceLevel.DEBUG))
+						l.log(TraceLevel.DEBUG, "Not Found: " + t.getString()); //$NON-NLS-1$
+				}
+				else {
+					t.keysMatched++;
+				}
+				int token = t.next();
+				if(field == null || token == JSONTokenizer.NULL) {
+					t.skipValue(token);
+					continue;
+				}
+				try {
+					if(field.same == null) {
+						field.plan.readInto(t, token, tuple, field.index);
+					}
+					else {
+						Object obj = field.plan.read(t, token);
+						if(obj != null) {
+							for(Field f = field; f != null; f = f.same)
+								tuple.setObject(f.index, obj);
+						}
+					}
+				} catch(Exception e) {
+					// the error is logged once by the caller, not on every nesting level
+					if(l.isLoggable(TraceLevel.DEBUG))
+						l.log(TraceLevel.DEBUG, "Error converting object: " + field.name, e); //$NON-NLS-1$
+					throw e;
+				}
+			}
+		}
+	}
+}
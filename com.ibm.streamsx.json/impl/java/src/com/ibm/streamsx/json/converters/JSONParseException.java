@@ -0,0 +1,38 @@
+package com.ibm.streamsx.json.converters;
+
+import java.io.IOException;
+
+/**
+ * Thrown by {@link JSONTokenizer} for JSON text that is not valid.
+ */
+public class JSONParseException extends IOException {
+
+	private static final long serialVersionUID = 1L;
+
+	private final int position;
+	private final String reason;
+
+	/**
+	 * @param position Position of the invalid character in the JSON text.
+	 * @param message Description of the error.
+	 */
+	public JSONParseException(int position, String message) {
+		super("Invalid JSON at position " + position + ": " + message); //$NON-NLS-1$ //$NON-NLS-2$
+		this.position = position;
+		this.reason = message;
+	}
+
+	/**
+	 * @return The position of the invalid character in the JSON text.
+	 */
+	public int getPosition() {
+		return position;
+	}
+
+	/**
+	 * @return The description of the error without the position, e.g. "value expected".
+	 */
+	public String getReason() {
+		return reason;
+	}
+}
@@ -13,6 +13,7 @@ import java.util.logging.Logger;
 import com.ibm.json.java.JSONArray;
 import com.ibm.json.java.JSONObject;
 import com.ibm.streams.operator.Attribute;
+import com.ibm.streams.operator.OutputTuple;
 import com.ibm.streams.operator.StreamSchema;
 import com.ibm.streams.operator.Tuple;
 import com.ibm.streams.operator.Type;
@@ -28,6 +29,12 @@ import com.ibm.streamsx.json.converters.Messages;
 
 /**
  * Converts JSON values to SPL tuples and SPL tuple attributes. 
+ * <p>
+ * An instance holds the prefix to ignore, the conversion plans of the schemas it converted
+ * JSON strings to and the tokenizer buffers, so operators with different prefixes can be
+ * fused into one PE. Instances are not thread safe, each thread needs its own converter.
+ * The static methods use the prefix set with {@link #setPrefixToIgnore(String)}, which is
+ * shared by all users of the class in the JVM.
  */
 public class JSONToTupleConverter {
 
@@ -35,9 +42,126 @@ public class JSONToTupleConverter {
 	
 	private static String prefixToIgnore = null; // null means prefixToIgnore is disabled
 	
+	/**
+	 * Sets the prefix to ignore of the static conversion methods.
+	 * @param value The prefix, {@code null} to disable it.
+	 * @deprecated The prefix applies to all users of the static methods in the PE,
+	 * use an instance created with {@link #JSONToTupleConverter(String)} instead.
+	 */
+	@Deprecated
 	public static void setPrefixToIgnore (String value) {
 		prefixToIgnore = value;
 	}
+
+	private final String prefix; // null means prefixToIgnore is disabled
+	private final JSONTokenizer tokenizer = new JSONTokenizer();
+	private final Map<StreamSchema, Map<String, JSONConversionPlan>> plans = new HashMap<StreamSchema, Map<String, JSONConversionPlan>>();
+	// last used plan, looked up without the maps as long as the schema and target don't change
+	private StreamSchema lastSchema = null;
+	private String lastTarget = null;
+	private JSONConversionPlan lastPlan = null;
+
+	/**
+	 * Creates a converter.
+	 * @param prefixToIgnore Prefix of attribute names that is not part of the JSON keys, {@code null} if there is none.
+	 */
+	public JSONToTupleConverter(String prefixToIgnore) {
+		this.prefix = prefixToIgnore;
+	}
+
+	/**
+	 * Converts a JSON string and sets the converted attributes in the output tuple.
+	 * Attributes that are not contained in the JSON string are not modified.
+	 *
+	 * @param json JSON object, or JSON array if the target attribute is a collection.
+	 * @param tuple Output tuple.
+	 * @param targetAttribute Name of the attribute the JSON value is converted to, {@code null} to convert a JSON object to the whole tuple.
+	 * @throws Exception If the JSON is invalid or cannot be converted. The output tuple may be modified partially in that case.
+	 */
+	public void convert(String json, OutputTuple tuple, String targetAttribute) throws Exception {
+		getPlan(tuple.getStreamSchema(), targetAttribute).convert(tokenizer, json, tuple);
+	}
+
+	/**
+	 * Converts a UTF-8 encoded JSON string, like the data of an rstring or blob, and sets
+	 * the converted attributes in the output tuple. The bytes are parsed without decoding
+	 * them into a String first. Attributes that are not contained in the JSON string are not modified.
+	 *
+	 * @param utf8 Buffer containing the JSON object, or JSON array if the target attribute is a collection.
+	 * @param offset Offset of the JSON string in the buffer.
+	 * @param length Number of bytes of the JSON string.
+	 * @param tuple Output tuple.
+	 * @param targetAttribute Name of the attribute the JSON value is converted to, {@code null} to convert a JSON object to the whole tuple.
+	 * @throws Exception If the JSON is invalid or cannot be converted. The output tuple may be modified partially in that case.
+	 */
+	public void convert(byte[] utf8, int offset, int length, OutputTuple tuple, String targetAttribute) throws Exception {
+		getPlan(tuple.getStreamSchema(), targetAttribute).convert(tokenizer, utf8, offset, length, tuple);
+	}
+
+	/**
+	 * @return The number of JSON object keys of the last converted string that were converted to an attribute.
+	 */
+	public int getKeysMatched() {
+		return tokenizer.getKeysMatched();
+	}
+
+	/**
+	 * @return The number of JSON object keys of the last converted string without matching attribute, their values are ignored.
+	 */
+	public int getKeysDropped() {
+		return tokenizer.getKeysDropped();
+	}
+
+	/**
+	 * Returns the conversion plan for the schema and target attribute, the plan is created on first use.
+	 * @param schema Schema of the output tuples.
+	 * @param targetAttribute Name of the attribute the JSON value is converted to, {@code null} to convert a JSON object to the whole tuple.
+	 * @return The conversion plan.
+	 */
+	public JSONConversionPlan getPlan(StreamSchema schema, String targetAttribute) {
+		if(schema == lastSchema && (targetAttribute == null ? lastTarget == null : targetAttribute.equals(lastTarget)))
+			return lastPlan;
+
+		Map<String, JSONConversionPlan> schemaPlans = plans.get(schema);
+		if(schemaPlans == null) {
+			schemaPlans = new HashMap<String, JSONConversionPlan>();
+			plans.put(schema, schemaPlans);
+		}
+		JSONConversionPlan plan = schemaPlans.get(targetAttribute);
+		if(plan == null) {
+			plan = new JSONConversionPlan(schema, targetAttribute, prefix);
+			schemaPlans.put(targetAttribute, plan);
+		}
+
+		lastSchema = schema;
+		lastTarget = targetAttribute;
+		lastPlan = plan;
+		return plan;
+	}
+
+	/**
+	 * Convert JSON value to an SPL tuple attribute value with the prefix of this converter.
+	 * @see #jsonToAttribute(String, Type, Object, Type)
+	 */
+	public Object toAttribute(String name, Type type, Object jsonObj, Type parentType) throws Exception {
+		return jsonToAttribute(name, type, jsonObj, parentType, prefix);
+	}
+
+	/**
+	 * Convert a JSONObject to an SPL tuple with the prefix of this converter.
+	 * @see #jsonToTuple(JSONObject, StreamSchema)
+	 */
+	public Tuple toTuple(JSONObject jbase, StreamSchema schema) throws Exception {
+		return jsonToTuple(jbase, schema, prefix);
+	}
+
+	/**
+	 * Convert a JSONObject to a Map with the prefix of this converter.
+	 * @see #jsonToAtributeMap(JSONObject, StreamSchema)
+	 */
+	public Map<String, Object> toAttributeMap(JSONObject jbase, StreamSchema schema) throws Exception {
+		return jsonToAtributeMap(jbase, schema, prefix);
+	}
 	
 	/**
 	 * Convert JSON value to an SPL tuple attribute value. 
@@ -50,6 +174,10 @@ public class JSONToTupleConverter {
 	 * @throws Exception If there was a problem converting the JSON.
 	 */
 	public static Object jsonToAttribute (String name, Type type, Object jsonObj, Type parentType) throws Exception {
+		return jsonToAttribute(name, type, jsonObj, parentType, prefixToIgnore);
+	}
+
+	private static Object jsonToAttribute (String name, Type type, Object jsonObj, Type parentType, String prefix) throws Exception {
 
 		if (jsonObj == null) return null;
 		if (l.isLoggable(TraceLevel.DEBUG)) {
@@ -122,11 +250,11 @@ public class JSONToTupleConverter {
 				if (!isOptional) {
 					if(!(((CollectionType)type).getElementType()).getMetaType().isCollectionType() &&
 							(parentType == null || !parentType.getMetaType().isCollectionType())) {
-						return arrayToSPLArray(name, (JSONArray) jsonObj, type);
+						return arrayToSPLArray(name, (JSONArray) jsonObj, type, prefix);
 					}
 					else {
 						List<Object> lst = new ArrayList<Object>();
-						arrayToCollection(name, lst, (JSONArray) jsonObj, type);
+						arrayToCollection(name, lst, (JSONArray) jsonObj, type, prefix);
 						return lst;
 					}
 				}
@@ -134,11 +262,11 @@ public class JSONToTupleConverter {
 					Type optionalBaseType = ((OptionalType)type).getValueType();
 					if (!((CollectionType)optionalBaseType).getElementType().getMetaType().isCollectionType() &&
 							(parentType == null || !parentType.getMetaType().isCollectionType())) {
-						return arrayToSPLArray(name, (JSONArray) jsonObj, optionalBaseType);
+						return arrayToSPLArray(name, (JSONArray) jsonObj, optionalBaseType, prefix);
 					}
 					else {
 						List<Object> lst = new ArrayList<Object>();
-						arrayToCollection(name, lst, (JSONArray) jsonObj, optionalBaseType);
+						arrayToCollection(name, lst, (JSONArray) jsonObj, optionalBaseType, prefix);
 						return lst;
 					}
 				}
@@ -152,22 +280,22 @@ public class JSONToTupleConverter {
 				 * getting its List BaseType.
 				 */
 				if (!isOptional) {
-					arrayToCollection(name, lst, (JSONArray) jsonObj, type);
+					arrayToCollection(name, lst, (JSONArray) jsonObj, type, prefix);
 				}
 				else {
 					Type optionalBaseType = ((OptionalType)type).getValueType();
-					arrayToCollection(name, lst, (JSONArray) jsonObj, optionalBaseType);
+					arrayToCollection(name, lst, (JSONArray) jsonObj, optionalBaseType, prefix);
 				}
 				return lst;
 			}
 
 			case TUPLE:
 				if (!isOptional) {
-					return jsonToTuple((JSONObject)jsonObj, ((TupleType)type).getTupleSchema());
+					return jsonToTuple((JSONObject)jsonObj, ((TupleType)type).getTupleSchema(), prefix);
 				}
 				else {
 					Type optionalBaseType = ((OptionalType)type).getValueType();
-					return jsonToTuple((JSONObject)jsonObj, ((TupleType)optionalBaseType).getTupleSchema());
+					return jsonToTuple((JSONObject)jsonObj, ((TupleType)optionalBaseType).getTupleSchema(), prefix);
 				}
 
 			case TIMESTAMP:
@@ -189,18 +317,20 @@ public class JSONToTupleConverter {
 				break;
 			}
 		}catch(Exception e) {
-			l.log(TraceLevel.ERROR, "Error converting attribute: Exception: " + e); //$NON-NLS-1$
+			// the error is logged once by the caller, not on every nesting level
+			if(l.isLoggable(TraceLevel.DEBUG))
+				l.log(TraceLevel.DEBUG, "Error converting attribute: Exception: " + e); //$NON-NLS-1$
 			throw e;
 		}
 		return null;
 	}
 
 	//this is used when a JSON array maps to a SPL collection 
-	private static void arrayToCollection(String name, Collection<Object>lst, JSONArray jarr, Type ptype) throws Exception {
+	private static void arrayToCollection(String name, Collection<Object>lst, JSONArray jarr, Type ptype, String prefix) throws Exception {
 		CollectionType ctype = (CollectionType) ptype;
 		String cname = lst.getClass().getSimpleName() + ": " + name; //$NON-NLS-1$
 		for(Object jsonObj : jarr) {
-			Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+			Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 			if(obj!=null)
 				lst.add(obj);
 		}
@@ -208,7 +338,7 @@ public class JSONToTupleConverter {
 
 
 	//this is used when a JSON array maps to a Java array 
-	private static Object arrayToSPLArray(String name, JSONArray jarr, Type ptype) throws Exception {
+	private static Object arrayToSPLArray(String name, JSONArray jarr, Type ptype, String prefix) throws Exception {
 		if(l.isLoggable(TraceLevel.DEBUG)) {
 			l.log(TraceLevel.DEBUG, "Creating Array: " + name); //$NON-NLS-1$
 		}
@@ -233,7 +363,7 @@ public class JSONToTupleConverter {
 		{
 			List<Object> lst = new ArrayList<Object>();
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj!=null) 
 					lst.add(obj);
 				else 
@@ -272,7 +402,7 @@ public class JSONToTupleConverter {
 		{
 			List<Object> lst = new ArrayList<Object>();
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj!=null) 
 					lst.add(obj);
 				else 
@@ -312,7 +442,7 @@ public class JSONToTupleConverter {
 		{
 			List<Object> lst = new ArrayList<Object>();
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj!=null) 
 					lst.add(obj);
 				else 
@@ -352,7 +482,7 @@ public class JSONToTupleConverter {
 		{
 			List<Object> lst = new ArrayList<Object>();
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj!=null) 
 					lst.add(obj);
 				else 
@@ -392,7 +522,7 @@ public class JSONToTupleConverter {
 		{
 			List<Object> lst = new ArrayList<Object>();
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj!=null) 
 					lst.add(obj);
 				else 
@@ -420,7 +550,7 @@ public class JSONToTupleConverter {
 		{
 			List<Object> lst = new ArrayList<Object>();
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj!=null) 
 					lst.add(obj);
 				else 
@@ -451,7 +581,7 @@ public class JSONToTupleConverter {
 		{
 			List<Object> lst = new ArrayList<Object>();
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj!=null) 
 					lst.add(obj);
 				else 
@@ -481,7 +611,7 @@ public class JSONToTupleConverter {
 		{
 			List<String> lst =  new ArrayList<String>();
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj != null) 
 					lst.add((String)obj);
 				else 
@@ -508,7 +638,7 @@ public class JSONToTupleConverter {
 		{
 			List<RString> lst = new ArrayList<RString>();
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj != null)  
 					lst.add((RString)obj);
 				else 
@@ -526,7 +656,7 @@ public class JSONToTupleConverter {
 		{
 			List<Tuple> lst = new ArrayList<Tuple>(); 
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj != null) 
 					lst.add((Tuple)obj);
 				else 
@@ -545,7 +675,7 @@ public class JSONToTupleConverter {
 		{
 			List<Object> lst = new ArrayList<Object>(); 
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj != null) 
 					lst.add(obj);
 				else 
@@ -563,7 +693,7 @@ public class JSONToTupleConverter {
 		{
 			Set<Object> lst = new HashSet<Object>(); 
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 
 				/*
 				 * For Set it doesn't make sense to add null values as they are unordered.
@@ -588,7 +718,7 @@ public class JSONToTupleConverter {
 		{
 			List<BigDecimal> lst = new ArrayList<BigDecimal>(); 
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj != null) 
 					lst.add((BigDecimal)obj);
 				else 
@@ -605,7 +735,7 @@ public class JSONToTupleConverter {
 		{
 			List<Timestamp> lst = new ArrayList<Timestamp>(); 
 			for(Object jsonObj : jarr) {
-				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype);
+				Object obj =jsonToAttribute(cname, ctype.getElementType(), jsonObj, ptype, prefix);
 				if(obj != null) 
 					lst.add((Timestamp)obj);
 				else 
@@ -647,7 +777,11 @@ public class JSONToTupleConverter {
 	 * @throws Exception If there was a problem converting the JSONObject.
 	 */
 	public static Tuple jsonToTuple(JSONObject jbase, StreamSchema schema) throws Exception {		
-		return schema.getTuple(jsonToAtributeMap(jbase, schema));
+		return jsonToTuple(jbase, schema, prefixToIgnore);
+	}
+
+	private static Tuple jsonToTuple(JSONObject jbase, StreamSchema schema, String prefix) throws Exception {
+		return schema.getTuple(jsonToAtributeMap(jbase, schema, prefix));
 	}
 	
 	/**
@@ -662,11 +796,15 @@ public class JSONToTupleConverter {
 	 * @throws Exception If there was a problem converting the JSONObject.
 	 */
 	public static Map<String, Object> jsonToAtributeMap(JSONObject jbase, StreamSchema schema) throws Exception {
+		return jsonToAtributeMap(jbase, schema, prefixToIgnore);
+	}
+
+	private static Map<String, Object> jsonToAtributeMap(JSONObject jbase, StreamSchema schema, String prefix) throws Exception {
 		Map<String, Object> attrmap = new HashMap<String, Object>();
 		for(Attribute attr : schema) {
 			String nameToSearch = attr.getName();
-			if ((prefixToIgnore != null) && (attr.getName().startsWith(prefixToIgnore))) {
-				nameToSearch = attr.getName().substring(prefixToIgnore.length());
+			if ((prefix != null) && (attr.getName().startsWith(prefix))) {
+				nameToSearch = attr.getName().substring(prefix.length());
 			}
 			try {
 				if(l.isLoggable(TraceLevel.DEBUG)) {
@@ -679,11 +817,12 @@ public class JSONToTupleConverter {
 					}
 					continue;
 				}
-				Object obj = jsonToAttribute(attr.getName(), attr.getType(), childobj, null);
+				Object obj = jsonToAttribute(attr.getName(), attr.getType(), childobj, null, prefix);
 				if(obj!=null)
 					attrmap.put(attr.getName(), obj);
 			} catch(Exception e) {
-				l.log(TraceLevel.ERROR, "Error converting object: " + attr.getName(), e); //$NON-NLS-1$
+				if(l.isLoggable(TraceLevel.DEBUG))
+					l.log(TraceLevel.DEBUG, "Error converting object: " + attr.getName(), e); //$NON-NLS-1$
 				throw e;
 			}
 		}
@@ -0,0 +1,625 @@
+package com.ibm.streamsx.json.converters;
+
+import java.io.IOException;
+import java.math.BigDecimal;
+
+/**
+ * Pull tokenizer for JSON text.
+ * <p>
+ * The tokenizer returns one token per call of {@link #next()} and keeps the text of the
+ * current key or string in a reusable buffer. Numbers are converted on demand from the
+ * input without creating objects. After the tokenizer was reset with a new document, keys
+ * can be matched and values skipped without any allocation.
+ * <p>
+ * A tokenizer instance is not thread safe.
+ */
+public final class JSONTokenizer {
+
+	/** End of the document */
+	public static final int END = 0;
+	/** Start of an object, '{' */
+	public static final int OBJECT_START = 1;
+	/** End of an object, '}' */
+	public static final int OBJECT_END = 2;
+	/** Start of an array, '[' */
+	public static final int ARRAY_START = 3;
+	/** End of an array, ']' */
+	public static final int ARRAY_END = 4;
+	/** Key of an object member, the value follows as next token */
+	public static final int KEY = 5;
+	/** String value */
+	public static final int STRING = 6;
+	/** Number value */
+	public static final int NUMBER = 7;
+	/** Literal true */
+	public static final int TRUE = 8;
+	/** Literal false */
+	public static final int FALSE = 9;
+	/** Literal null */
+	public static final int NULL = 10;
+
+	// what is expected next in the current container
+	private static final int VALUE = 0;
+	private static final int VALUE_OR_END = 1;
+	private static final int MEMBER = 2;
+	private static final int MEMBER_OR_END = 3;
+	private static final int SEPARATOR = 4;
+
+	private static final char REPLACEMENT = '\uFFFD';
+
+	private static final double[] POW10 = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	private char[] input = new char[1024];
+	private int end;
+	private int pos;
+	private int tokenStart;
+
+	private int state;
+	private boolean[] inObject = new boolean[32];
+	private int depth;
+
+	// decoded key or string
+	private char[] text = new char[256];
+	private int textLength;
+	private int textHash;
+
+	// number, as long if it is an integer within range, and as decimal mantissa and exponent
+	private int numberStart;
+	private boolean numberIsLong;
+	private long numberLong;
+	private boolean numberNegative;
+	private long numberMantissa;
+	private int numberExponent;
+	private boolean numberTruncated;
+
+	// keys of the document with and without matching attribute, counted by the conversion plan
+	int keysMatched;
+	int keysDropped;
+
+	/**
+	 * Starts tokenizing a new document.
+	 * @param json JSON text
+	 */
+	public void reset(String json) {
+		int length = json.length();
+		ensureInput(length);
+		json.getChars(0, length, input, 0);
+		start(length);
+	}
+
+	/**
+	 * Starts tokenizing a new document that is encoded as UTF-8, like the data of an rstring or blob.
+	 * The bytes are decoded into the reused input buffer without creating a String. Malformed
+	 * sequences are replaced by U+FFFD like the String decoder does.
+	 * @param utf8 Buffer containing the JSON text
+	 * @param offset Offset of the JSON text in the buffer
+	 * @param length Number of bytes of the JSON text
+	 */
+	public void reset(byte[] utf8, int offset, int length) {
+		// UTF-8 never needs more chars than bytes
+		ensureInput(length);
+		char[] chars = input;
+		int n = 0;
+		int i = offset;
+		int limit = offset + length;
+		while(i < limit) {
+			int b = utf8[i++];
+			if(b >= 0) {
+				chars[n++] = (char)b;
+				continue;
+			}
+
+			int cp;
+			int trailing;
+			int min;
+			if((b & 0xe0) == 0xc0) {
+				cp = b & 0x1f;
+				trailing = 1;
+				min = 0x80;
+			}
+			else if((b & 0xf0) == 0xe0) {
+				cp = b & 0x0f;
+				trailing = 2;
+				min = 0x800;
+			}
+			else if((b & 0xf8) == 0xf0) {
+				cp = b & 0x07;
+				trailing = 3;
+				min = 0x10000;
+			}
+			else {
+				chars[n++] = REPLACEMENT;
+				continue;
+			}
+			for(; trailing > 0 && i < limit && (utf8[i] & 0xc0) == 0x80; trailing--)
+				cp = (cp << 6) | (utf8[i++] & 0x3f);
+
+			if(trailing != 0 || cp < min || cp > Character.MAX_CODE_POINT || (cp >= Character.MIN_SURROGATE && cp <= Character.MAX_SURROGATE)) {
+				chars[n++] = REPLACEMENT;
+			}
+			else if(cp >= Character.MIN_SUPPLEMENTARY_CODE_POINT) {
+				chars[n++] = Character.highSurrogate(cp);
+				chars[n++] = Character.lowSurrogate(cp);
+			}
+			else {
+				chars[n++] = (char)cp;
+			}
+		}
+		start(n);
+	}
+
+	private void ensureInput(int length) {
+		if(input.length < length)
+			input = new char[Math.max(length, input.length * 2)];
+	}
+
+	private void start(int length) {
+		end = length;
+		pos = 0;
+		tokenStart = 0;
+		state = VALUE;
+		depth = 0;
+		keysMatched = 0;
+		keysDropped = 0;
+	}
+
+	/**
+	 * @return The number of object keys of the current document that were converted to an attribute.
+	 */
+	public int getKeysMatched() {
+		return keysMatched;
+	}
+
+	/**
+	 * @return The number of object keys of the current document without matching attribute,
+	 * keys within their values are not counted.
+	 */
+	public int getKeysDropped() {
+		return keysDropped;
+	}
+
+	/**
+	 * Returns the next token.
+	 * @return The token, {@link #END} once the root value is complete.
+	 * @throws IOException If the JSON text is invalid.
+	 */
+	public int next() throws IOException {
+		for(;;) {
+			skipWhitespace();
+
+			if(state == SEPARATOR) {
+				if(depth == 0) {
+					if(pos != end)
+						throw error("unexpected content after the root value"); //$NON-NLS-1$
+					return END;
+				}
+				char c = nextChar();
+				if(c == ',') {
+					state = inObject[depth - 1] ? MEMBER : VALUE;
+					continue;
+				}
+				if(c == (inObject[depth - 1] ? '}' : ']')) {
+					depth--;
+					return inObject[depth] ? OBJECT_END : ARRAY_END;
+				}
+				pos--;
+				throw error("',' or end of " + (inObject[depth - 1] ? "object" : "array") + " expected"); //$NON-NLS-1$ //$NON-NLS-2$ //$NON-NLS-3$ //$NON-NLS-4$
+			}
+
+			tokenStart = pos;
+			char c = nextChar();
+
+			if(state == MEMBER || state == MEMBER_OR_END) {
+				if(c == '}' && state == MEMBER_OR_END) {
+					depth--;
+					state = SEPARATOR;
+					return OBJECT_END;
+				}
+				if(c != '"') {
+					pos--;
+					throw error("key expected"); //$NON-NLS-1$
+				}
+				readString();
+				skipWhitespace();
+				if(pos == end || input[pos] != ':')
+					throw error("':' expected"); //$NON-NLS-1$
+				pos++;
+				state = VALUE;
+				return KEY;
+			}
+
+			if(c == ']' && state == VALUE_OR_END) {
+				depth--;
+				state = SEPARATOR;
+				return ARRAY_END;
+			}
+
+			switch(c) {
+			case '{':
+				push(true);
+				state = MEMBER_OR_END;
+				return OBJECT_START;
+			case '[':
+				push(false);
+				state = VALUE_OR_END;
+				return ARRAY_START;
+			case '"':
+				readString();
+				state = SEPARATOR;
+				return STRING;
+			case 't':
+				readLiteral("rue"); //$NON-NLS-1$
+				state = SEPARATOR;
+				return TRUE;
+			case 'f':
+				readLiteral("alse"); //$NON-NLS-1$
+				state = SEPARATOR;
+				return FALSE;
+			case 'n':
+				readLiteral("ull"); //$NON-NLS-1$
+				state = SEPARATOR;
+				return NULL;
+			default:
+				if(c == '-' || (c >= '0' && c <= '9')) {
+					pos--;
+					readNumber();
+					state = SEPARATOR;
+					return NUMBER;
+				}
+				pos--;
+				throw error("value expected"); //$NON-NLS-1$
+			}
+		}
+	}
+
+	/**
+	 * Skips the value that starts with {@code token}, objects and arrays as a whole.
+	 * @param token The first token of the value.
+	 * @throws IOException If the JSON text is invalid.
+	 */
+	public void skipValue(int token) throws IOException {
+		if(token != OBJECT_START && token != ARRAY_START)
+			return;
+
+		int outer = depth - 1;
+		while(depth > outer) {
+			if(state == MEMBER || state == MEMBER_OR_END || state == VALUE || state == VALUE_OR_END) {
+				// strings are not decoded while skipping
+				skipWhitespace();
+				if(pos != end && input[pos] == '"') {
+					tokenStart = pos++;
+					skipString();
+					if(state == MEMBER || state == MEMBER_OR_END) {
+						skipWhitespace();
+						if(pos == end || input[pos] != ':')
+							throw error("':' expected"); //$NON-NLS-1$
+						pos++;
+						state = VALUE;
+					}
+					else {
+						state = SEPARATOR;
+					}
+					continue;
+				}
+			}
+			next();
+		}
+	}
+
+	/**
+	 * Skips the value that starts with {@code token} and returns its JSON text.
+	 * @param token The first token of the value.
+	 * @return The JSON text of the value.
+	 * @throws IOException If the JSON text is invalid.
+	 */
+	public String valueText(int token) throws IOException {
+		int start = tokenStart;
+		skipValue(token);
+		return new String(input, start, pos - start);
+	}
+
+	/**
+	 * @return The current key or string.
+	 */
+	public String getString() {
+		return new String(text, 0, textLength);
+	}
+
+	/**
+	 * @return The length of the current key or string.
+	 */
+	public int getStringLength() {
+		return textLength;
+	}
+
+	/**
+	 * @return The hash code of the current key or string, the same as {@link String#hashCode()} of it.
+	 */
+	public int getStringHash() {
+		return textHash;
+	}
+
+	/**
+	 * @param chars Characters to compare with.
+	 * @return Whether the current key or string consists of {@code chars}.
+	 */
+	public boolean stringEquals(char[] chars) {
+		if(chars.length != textLength)
+			return false;
+		for(int i = 0; i < textLength; i++) {
+			if(chars[i] != text[i])
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @param lowerCase Lower case ASCII string to compare with.
+	 * @return Whether the current key or string equals {@code lowerCase} ignoring case.
+	 */
+	public boolean stringEqualsIgnoreCase(String lowerCase) {
+		if(lowerCase.length() != textLength)
+			return false;
+		for(int i = 0; i < textLength; i++) {
+			if(Character.toLowerCase(text[i]) != lowerCase.charAt(i))
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @return Whether the current number is an integer in the range of {@code long}.
+	 */
+	public boolean isLong() {
+		return numberIsLong;
+	}
+
+	/**
+	 * @return The current number, numbers with fraction or exponent are cast like a {@code double}.
+	 */
+	public long longValue() {
+		return numberIsLong ? numberLong : (long)doubleValue();
+	}
+
+	/**
+	 * @return The current number, casts like {@link Number#intValue()}.
+	 */
+	public int intValue() {
+		return numberIsLong ? (int)numberLong : (int)doubleValue();
+	}
+
+	/**
+	 * @return The current number.
+	 */
+	public double doubleValue() {
+		if(numberIsLong)
+			return numberLong;
+		if(numberMantissa == 0)
+			return numberNegative ? -0.0 : 0.0;
+
+		// exact with one multiplication or division if mantissa and power of ten are exact doubles
+		if(!numberTruncated && numberMantissa <= (1L << 53) && numberExponent >= -22 && numberExponent <= 22) {
+			double d = numberMantissa;
+			d = numberExponent < 0 ? d / POW10[-numberExponent] : d * POW10[numberExponent];
+			return numberNegative ? -d : d;
+		}
+		return Double.parseDouble(new String(input, numberStart, pos - numberStart));
+	}
+
+	/**
+	 * @return The current number with the digits of the JSON text.
+	 */
+	public BigDecimal decimalValue() {
+		return new BigDecimal(input, numberStart, pos - numberStart);
+	}
+
+	/**
+	 * @return The current number as {@code Long} or {@code Double} would convert it to a string.
+	 */
+	public String numberString() {
+		return numberIsLong ? Long.toString(numberLong) : Double.toString(doubleValue());
+	}
+
+	private void push(boolean object) {
+		if(depth == inObject.length) {
+			boolean[] grown = new boolean[depth * 2];
+			System.arraycopy(inObject, 0, grown, 0, depth);
+			inObject = grown;
+		}
+		inObject[depth++] = object;
+	}
+
+	private char nextChar() throws IOException {
+		if(pos == end)
+			throw error("unexpected end"); //$NON-NLS-1$
+		return input[pos++];
+	}
+
+	private void skipWhitespace() {
+		while(pos != end) {
+			char c = input[pos];
+			if(c != ' ' && c != '\n' && c != '\r' && c != '\t')
+				return;
+			pos++;
+		}
+	}
+
+	private void readLiteral(String rest) throws IOException {
+		int length = rest.length();
+		if(end - pos < length)
+			throw error("invalid literal"); //$NON-NLS-1$
+		for(int i = 0; i < length; i++) {
+			if(input[pos + i] != rest.charAt(i))
+				throw error("invalid literal"); //$NON-NLS-1$
+		}
+		pos += length;
+	}
+
+	private void readString() throws IOException {
+		int length = 0;
+		int hash = 0;
+		char[] buffer = text;
+
+		for(;;) {
+			char c = nextChar();
+			if(c == '"')
+				break;
+			if(c == '\\')
+				c = readEscape();
+			if(length == buffer.length) {
+				char[] grown = new char[length * 2];
+				System.arraycopy(buffer, 0, grown, 0, length);
+				buffer = text = grown;
+			}
+			buffer[length++] = c;
+			hash = 31 * hash + c;
+		}
+		textLength = length;
+		textHash = hash;
+	}
+
+	private void skipString() throws IOException {
+		for(;;) {
+			char c = nextChar();
+			if(c == '"')
+				return;
+			if(c == '\\')
+				readEscape();
+		}
+	}
+
+	private char readEscape() throws IOException {
+		char c = nextChar();
+		switch(c) {
+		case '"':
+		case '\\':
+		case '/':
+			return c;
+		case 'b':
+			return '\b';
+		case 'f':
+			return '\f';
+		case 'n':
+			return '\n';
+		case 'r':
+			return '\r';
+		case 't':
+			return '\t';
+		case 'u':
+			// surrogate pairs are two escapes and result in two chars like in Java strings
+			int code = 0;
+			for(int i = 0; i < 4; i++) {
+				int digit = Character.digit(nextChar(), 16);
+				if(digit < 0)
+					throw error("invalid unicode escape"); //$NON-NLS-1$
+				code = (code << 4) | digit;
+			}
+			return (char)code;
+		default:
+			throw error("invalid escape"); //$NON-NLS-1$
+		}
+	}
+
+	private void readNumber() throws IOException {
+		numberStart = pos;
+		numberNegative = false;
+		numberMantissa = 0;
+		numberExponent = 0;
+		numberTruncated = false;
+
+		// up to 18 significant digits are accumulated, the remaining ones are dropped
+		int significant = 0;
+		boolean integer = true;
+
+		if(input[pos] == '-') {
+			numberNegative = true;
+			pos++;
+		}
+
+		int digits = pos;
+		if(pos != end && input[pos] == '0') {
+			pos++;
+		}
+		else {
+			for(; pos != end && input[pos] >= '0' && input[pos] <= '9'; pos++) {
+				if(significant < 18) {
+					numberMantissa = numberMantissa * 10 + (input[pos] - '0');
+					significant++;
+				}
+				else {
+					numberExponent++;
+					numberTruncated = true;
+				}
+			}
+		}
+		if(pos == digits)
+			throw error("invalid number"); //$NON-NLS-1$
+		int integerEnd = pos;
+
+		if(pos != end && input[pos] == '.') {
+			integer = false;
+			int fraction = ++pos;
+			for(; pos != end && input[pos] >= '0' && input[pos] <= '9'; pos++) {
+				if(numberMantissa == 0 && input[pos] == '0') {
+					numberExponent--;
+				}
+				else if(significant < 18) {
+					numberMantissa = numberMantissa * 10 + (input[pos] - '0');
+					numberExponent--;
+					significant++;
+				}
+				else {
+					numberTruncated = true;
+				}
+			}
+			if(pos == fraction)
+				throw error("invalid number"); //$NON-NLS-1$
+		}
+
+		if(pos != end && (input[pos] == 'e' || input[pos] == 'E')) {
+			integer = false;
+			pos++;
+			boolean negativeExponent = false;
+			if(pos != end && (input[pos] == '-' || input[pos] == '+'))
+				negativeExponent = (input[pos++] == '-');
+			int exponentStart = pos;
+			int exponent = 0;
+			for(; pos != end && input[pos] >= '0' && input[pos] <= '9'; pos++) {
+				if(exponent < 100000)
+					exponent = exponent * 10 + (input[pos] - '0');
+			}
+			if(pos == exponentStart)
+				throw error("invalid number"); //$NON-NLS-1$
+			numberExponent += negativeExponent ? -exponent : exponent;
+		}
+
+		numberIsLong = integer;
+		if(integer) {
+			if(!numberTruncated) {
+				numberLong = numberNegative ? -numberMantissa : numberMantissa;
+			}
+			else {
+				// 19 digits and more, accumulate negative to include Long.MIN_VALUE
+				long value = 0;
+				for(int i = digits; i < integerEnd && numberIsLong; i++) {
+					int digit = input[i] - '0';
+					if(value < (Long.MIN_VALUE + digit) / 10)
+						numberIsLong = false;
+					value = value * 10 - digit;
+				}
+				if(numberIsLong && !numberNegative) {
+					numberIsLong = (value != Long.MIN_VALUE);
+					value = -value;
+				}
+				numberLong = value;
+			}
+		}
+	}
+
+	private IOException error(String message) {
+		return new JSONParseException(pos, message);
+	}
+}
@@ -1,18 +1,599 @@
 package com.ibm.streamsx.json.converters;
 
 import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
 
 import com.ibm.json.java.JSONArray;
+import com.ibm.json.java.JSONArtifact;
 import com.ibm.json.java.JSONObject;
+import com.ibm.streams.operator.Attribute;
+import com.ibm.streams.operator.StreamSchema;
 import com.ibm.streams.operator.Tuple;
+import com.ibm.streams.operator.Type;
+import com.ibm.streams.operator.Type.MetaType;
 import com.ibm.streams.operator.encoding.EncodingFactory;
 import com.ibm.streams.operator.encoding.JSONEncoding;
+import com.ibm.streams.operator.meta.CollectionType;
+import com.ibm.streams.operator.meta.MapType;
+import com.ibm.streams.operator.meta.OptionalType;
+import com.ibm.streams.operator.meta.TupleType;
+import com.ibm.streams.operator.types.RString;
 
 /**
  * Converts SPL tuples and SPL tuple attributes to String representations of JSON values.  
+ * <p>
+ * An instance removes a prefix from the attribute names. The keys are computed once per
+ * schema and replace the attribute names in the encoded JSON object before it is serialized,
+ * so string values and map keys are not changed. Instances are thread safe.
+ * <p>
+ * The encode methods write the JSON text as UTF-8 bytes into a {@link JSONByteWriter}. They
+ * use an encoder per schema that writes the keys from precomputed bytes and primitive,
+ * string, tuple, list and set values directly from the tuple. Attributes of other types
+ * are encoded by JSONEncoding.
  */
 public class TupleToJSONConverter { 
 
+	// attribute types whose JSON values have no keys to rename
+	private static final Renaming NONE = new Renaming();
+
+	private final String prefixToIgnore;
+	// renamings by attribute type and by tuple schema
+	private final Map<Object, Renaming> renamings = new ConcurrentHashMap<Object, Renaming>();
+	// encoders by attribute type and by tuple schema
+	private final Map<Object, Encoder> encoders = new ConcurrentHashMap<Object, Encoder>();
+
+	/**
+	 * Creates a converter.
+	 * @param prefixToIgnore Prefix that is removed from attribute names, {@code null} if there is none.
+	 */
+	public TupleToJSONConverter(String prefixToIgnore) {
+		this.prefixToIgnore = prefixToIgnore;
+	}
+
+	/**
+	 * Converts an SPL tuple to a String representation of a JSONObject, with
+	 * the prefix removed from the attribute names.
+	 * @param tuple Tuple to be converted
+	 * @return String representation of a JSONObject
+	 * @throws IOException If there was a problem converting the SPL tuple
+	 */
+	public String toJSON(Tuple tuple) throws IOException {
+		Renaming renaming = getTupleRenaming(tuple.getStreamSchema());
+		if(renaming == NONE)
+			return convertTuple(tuple);
+
+		JSONEncoding<JSONObject, JSONArray> je = EncodingFactory.getJSONEncoding();
+		JSONObject json = je.encodeTuple(tuple);
+		renaming.rename(json);
+		return json.serialize();
+	}
+
+	/**
+	 * Converts an SPL tuple attribute (that must be a list) to a String representation of a JSONArray,
+	 * with the prefix removed from the attribute names of tuple elements.
+	 * @param tuple Tuple containing the attribute to be converted
+	 * @param attrName Name of the attribute to convert
+	 * @return String representation of a JSON array
+	 * @throws IOException If there was a problem converting the SPL tuple attribute
+	 */
+	public String arrayToJSON(Tuple tuple, String attrName) throws IOException {
+		JSONEncoding<JSONObject, JSONArray> je = EncodingFactory.getJSONEncoding();
+		JSONArray json = (JSONArray)je.getAttributeObject(tuple, attrName);
+		getRenaming(tuple.getStreamSchema().getAttribute(attrName).getType()).rename(json);
+		return json.serialize();
+	}
+
+	/**
+	 * Writes an SPL tuple as JSON object, with the prefix removed from the attribute names.
+	 * @param tuple Tuple to be converted
+	 * @param out Writer the JSON text is appended to
+	 * @throws IOException If there was a problem converting the SPL tuple
+	 */
+	public void encode(Tuple tuple, JSONByteWriter out) throws IOException {
+		getTupleEncoder(tuple.getStreamSchema()).encodeValue(tuple, out);
+	}
+
+	/**
+	 * Writes an SPL tuple attribute as JSON value, with the prefix removed from the attribute names of tuples.
+	 * @param tuple Tuple containing the attribute to be converted
+	 * @param attrName Name of the attribute to convert
+	 * @param out Writer the JSON text is appended to
+	 * @throws IOException If there was a problem converting the SPL tuple attribute
+	 */
+	public void encodeAttribute(Tuple tuple, String attrName, JSONByteWriter out) throws IOException {
+		Attribute attr = tuple.getStreamSchema().getAttribute(attrName);
+		createAttributeEncoder(attr).encodeAttribute(tuple, attr.getIndex(), out);
+	}
+
+	private Encoder getTupleEncoder(StreamSchema schema) {
+		Encoder encoder = encoders.get(schema);
+		if(encoder == null) {
+			Encoder[] attributes = new Encoder[schema.getAttributeCount()];
+			byte[][] keys = new byte[schema.getAttributeCount()][];
+			JSONByteWriter key = new JSONByteWriter();
+			for(Attribute attr : schema) {
+				String name = attr.getName();
+				if(prefixToIgnore != null && name.startsWith(prefixToIgnore))
+					name = name.substring(prefixToIgnore.length());
+				key.reset();
+				if(attr.getIndex() != 0)
+					key.write((byte)',');
+				key.writeString(name);
+				key.write((byte)':');
+				keys[attr.getIndex()] = key.toRString().getData();
+				attributes[attr.getIndex()] = createAttributeEncoder(attr);
+			}
+			encoder = new TupleEncoder(keys, attributes);
+			encoders.put(schema, encoder);
+		}
+		return encoder;
+	}
+
+	private Encoder createAttributeEncoder(Attribute attr) {
+		Encoder encoder = getEncoder(attr.getType());
+		if(encoder == null)
+			encoder = new FallbackEncoder(attr.getName(), getRenaming(attr.getType()));
+		return encoder;
+	}
+
+	/*
+	 * Encoder for values of the type, null if they are encoded by JSONEncoding
+	 */
+	private Encoder getEncoder(Type type) {
+		switch(type.getMetaType()) {
+		case BOOLEAN:
+		case INT8:
+		case INT16:
+		case INT32:
+		case INT64:
+		case UINT8:
+		case UINT16:
+		case UINT32:
+		case UINT64:
+		case FLOAT32:
+		case FLOAT64:
+		case RSTRING:
+		case USTRING:
+			break;
+		case LIST:
+		case BLIST:
+		case SET:
+		case BSET:
+			if(getEncoder(((CollectionType)type).getElementType()) == null)
+				return null;
+			break;
+		case TUPLE:
+			return getTupleEncoder(((TupleType)type).getTupleSchema());
+		default:
+			return null;
+		}
+
+		Encoder encoder = encoders.get(type);
+		if(encoder == null) {
+			if(type.getMetaType().isCollectionType())
+				encoder = new CollectionEncoder(getEncoder(((CollectionType)type).getElementType()));
+			else
+				encoder = new PrimitiveEncoder(type.getMetaType());
+			encoders.put(type, encoder);
+		}
+		return encoder;
+	}
+
+	private Renaming getRenaming(Type type) {
+		Renaming renaming = renamings.get(type);
+		if(renaming == null) {
+			renaming = createRenaming(type);
+			renamings.put(type, renaming);
+		}
+		return renaming;
+	}
+
+	private Renaming getTupleRenaming(StreamSchema schema) {
+		Renaming renaming = renamings.get(schema);
+		if(renaming == null) {
+			renaming = createTupleRenaming(schema);
+			renamings.put(schema, renaming);
+		}
+		return renaming;
+	}
+
+	private Renaming createRenaming(Type type) {
+		if(prefixToIgnore == null)
+			return NONE;
+
+		switch(type.getMetaType()) {
+		case OPTIONAL:
+			return createRenaming(((OptionalType)type).getValueType());
+
+		case LIST:
+		case BLIST:
+		case SET:
+		case BSET:
+		{
+			Renaming element = createRenaming(((CollectionType)type).getElementType());
+			return element == NONE ? NONE : new CollectionRenaming(element);
+		}
+
+		case MAP:
+		case BMAP:
+		{
+			Renaming value = createRenaming(((MapType)type).getValueType());
+			return value == NONE ? NONE : new MapRenaming(value);
+		}
+
+		case TUPLE:
+			return getTupleRenaming(((TupleType)type).getTupleSchema());
+
+		default:
+			return NONE;
+		}
+	}
+
+	private Renaming createTupleRenaming(StreamSchema schema) {
+		if(prefixToIgnore == null)
+			return NONE;
+
+		List<String> names = new ArrayList<String>();
+		List<String> keys = new ArrayList<String>();
+		List<String> children = new ArrayList<String>();
+		List<Renaming> childRenamings = new ArrayList<Renaming>();
+
+		for(Attribute attr : schema) {
+			String name = attr.getName();
+			if(name.startsWith(prefixToIgnore)) {
+				names.add(name);
+				keys.add(name.substring(prefixToIgnore.length()));
+			}
+			Renaming child = getRenaming(attr.getType());
+			if(child != NONE) {
+				children.add(name);
+				childRenamings.add(child);
+			}
+		}
+		if(names.isEmpty() && children.isEmpty())
+			return NONE;
+		return new TupleRenaming(names.toArray(new String[names.size()]), keys.toArray(new String[keys.size()]),
+				children.toArray(new String[children.size()]), childRenamings.toArray(new Renaming[childRenamings.size()]));
+	}
+
+	/**
+	 * Renames the keys of an encoded value, the base class leaves it unchanged.
+	 */
+	private static class Renaming {
+		void rename(Object json) {
+		}
+	}
+
+	private static final class TupleRenaming extends Renaming {
+		private final String[] names;
+		private final String[] keys;
+		private final String[] children;
+		private final Renaming[] childRenamings;
+
+		TupleRenaming(String[] names, String[] keys, String[] children, Renaming[] childRenamings) {
+			this.names = names;
+			this.keys = keys;
+			this.children = children;
+			this.childRenamings = childRenamings;
+		}
+
+		@Override
+		void rename(Object json) {
+			JSONObject obj = (JSONObject)json;
+			for(int i = 0; i < children.length; i++) {
+				Object value = obj.get(children[i]);
+				if(value != null)
+					childRenamings[i].rename(value);
+			}
+			for(int i = 0; i < names.length; i++) {
+				if(obj.containsKey(names[i]))
+					obj.put(keys[i], obj.remove(names[i]));
+			}
+		}
+	}
+
+	private static final class CollectionRenaming extends Renaming {
+		private final Renaming element;
+
+		CollectionRenaming(Renaming element) {
+			this.element = element;
+		}
+
+		@Override
+		void rename(Object json) {
+			for(Object value : (JSONArray)json) {
+				if(value != null)
+					element.rename(value);
+			}
+		}
+	}
+
+	private static final class MapRenaming extends Renaming {
+		private final Renaming value;
+
+		MapRenaming(Renaming value) {
+			this.value = value;
+		}
+
+		@Override
+		void rename(Object json) {
+			if(!(json instanceof Map))
+				return;
+			for(Object v : ((Map<?, ?>)json).values()) {
+				if(v != null)
+					value.rename(v);
+			}
+		}
+	}
+
+	/**
+	 * Writes a value as JSON, the value of an attribute or an element of a collection.
+	 */
+	private static abstract class Encoder {
+		void encodeAttribute(Tuple tuple, int index, JSONByteWriter out) throws IOException {
+			encodeValue(tuple.getObject(index), out);
+		}
+
+		abstract void encodeValue(Object value, JSONByteWriter out) throws IOException;
+	}
+
+	private static final class PrimitiveEncoder extends Encoder {
+		private final MetaType type;
+
+		PrimitiveEncoder(MetaType type) {
+			this.type = type;
+		}
+
+		@Override
+		void encodeAttribute(Tuple tuple, int index, JSONByteWriter out) throws IOException {
+			switch(type) {
+			case BOOLEAN:
+				out.writeBoolean(tuple.getBoolean(index));
+				break;
+			case INT8:
+				out.writeLong(tuple.getByte(index));
+				break;
+			case UINT8:
+				out.writeLong(tuple.getByte(index) & 0xffL);
+				break;
+			case INT16:
+				out.writeLong(tuple.getShort(index));
+				break;
+			case UINT16:
+				out.writeLong(tuple.getShort(index) & 0xffffL);
+				break;
+			case INT32:
+				out.writeLong(tuple.getInt(index));
+				break;
+			case UINT32:
+				out.writeLong(tuple.getInt(index) & 0xffffffffL);
+				break;
+			case INT64:
+				out.writeLong(tuple.getLong(index));
+				break;
+			case UINT64:
+				out.writeUnsignedLong(tuple.getLong(index));
+				break;
+			case FLOAT32:
+				out.writeFloat(tuple.getFloat(index));
+				break;
+			case FLOAT64:
+				out.writeDouble(tuple.getDouble(index));
+				break;
+			default:
+				super.encodeAttribute(tuple, index, out);
+				break;
+			}
+		}
+
+		@Override
+		void encodeValue(Object value, JSONByteWriter out) throws IOException {
+			if(value == null) {
+				out.writeNull();
+				return;
+			}
+			switch(type) {
+			case BOOLEAN:
+				out.writeBoolean((Boolean)value);
+				break;
+			case INT8:
+			case INT16:
+			case INT32:
+			case INT64:
+				out.writeLong(((Number)value).longValue());
+				break;
+			case UINT8:
+				out.writeLong(((Number)value).byteValue() & 0xffL);
+				break;
+			case UINT16:
+				out.writeLong(((Number)value).shortValue() & 0xffffL);
+				break;
+			case UINT32:
+				out.writeLong(((Number)value).intValue() & 0xffffffffL);
+				break;
+			case UINT64:
+				out.writeUnsignedLong(((Number)value).longValue());
+				break;
+			case FLOAT32:
+				out.writeFloat(((Number)value).floatValue());
+				break;
+			case FLOAT64:
+				out.writeDouble(((Number)value).doubleValue());
+				break;
+			default:
+				// rstring values are written from their UTF-8 bytes
+				if(value instanceof RString)
+					out.writeString(((RString)value).getData());
+				else
+					out.writeString(value.toString());
+				break;
+			}
+		}
+	}
+
+	/**
+	 * Lists and sets, the Java representation is a collection or an array of a primitive type.
+	 */
+	private static final class CollectionEncoder extends Encoder {
+		private final Encoder element;
+
+		CollectionEncoder(Encoder element) {
+			this.element = element;
+		}
+
+		@Override
+		void encodeValue(Object value, JSONByteWriter out) throws IOException {
+			out.write((byte)'[');
+			if(value instanceof Collection) {
+				boolean first = true;
+				for(Object e : (Collection<?>)value) {
+					if(!first)
+						out.write((byte)',');
+					first = false;
+					element.encodeValue(e, out);
+				}
+			}
+			else if(value instanceof Object[]) {
+				Object[] array = (Object[])value;
+				for(int i = 0; i < array.length; i++) {
+					if(i != 0)
+						out.write((byte)',');
+					element.encodeValue(array[i], out);
+				}
+			}
+			else if(value instanceof int[]) {
+				int[] array = (int[])value;
+				for(int i = 0; i < array.length; i++) {
+					if(i != 0)
+						out.write((byte)',');
+					element.encodeValue(array[i], out);
+				}
+			}
+			else if(value instanceof long[]) {
+				long[] array = (long[])value;
+				for(int i = 0; i < array.length; i++) {
+					if(i != 0)
+						out.write((byte)',');
+					element.encodeValue(array[i], out);
+				}
+			}
+			else if(value instanceof short[]) {
+				short[] array = (short[])value;
+				for(int i = 0; i < array.length; i++) {
+					if(i != 0)
+						out.write((byte)',');
+					element.encodeValue(array[i], out);
+				}
+			}
+			else if(value instanceof byte[]) {
+				byte[] array = (byte[])value;
+				for(int i = 0; i < array.length; i++) {
+					if(i != 0)
+						out.write((byte)',');
+					element.encodeValue(array[i], out);
+				}
+			}
+			else if(value instanceof boolean[]) {
+				boolean[] array = (boolean[])value;
+				for(int i = 0; i < array.length; i++) {
+					if(i != 0)
+						out.write((byte)',');
+					out.writeBoolean(array[i]);
+				}
+			}
+			else if(value instanceof float[]) {
+				float[] array = (float[])value;
+				for(int i = 0; i < array.length; i++) {
+					if(i != 0)
+						out.write((byte)',');
+					out.writeFloat(array[i]);
+				}
+			}
+			else if(value instanceof double[]) {
+				double[] array = (double[])value;
+				for(int i = 0; i < array.length; i++) {
+					if(i != 0)
+						out.write((byte)',');
+					out.writeDouble(array[i]);
+				}
+			}
+			out.write((byte)']');
+		}
+	}
+
+	private static final class TupleEncoder extends Encoder {
+		// "key": with a leading comma except for the first attribute
+		private final byte[][] keys;
+		private final Encoder[] attributes;
+
+		TupleEncoder(byte[][] keys, Encoder[] attributes) {
+			this.keys = keys;
+			this.attributes = attributes;
+		}
+
+		@Override
+		void encodeAttribute(Tuple tuple, int index, JSONByteWriter out) throws IOException {
+			encodeValue(tuple.getTuple(index), out);
+		}
+
+		@Override
+		void encodeValue(Object value, JSONByteWriter out) throws IOException {
+			if(value == null) {
+				out.writeNull();
+				return;
+			}
+			Tuple tuple = (Tuple)value;
+			out.write((byte)'{');
+			for(int i = 0; i < attributes.length; i++) {
+				out.write(keys[i]);
+				attributes[i].encodeAttribute(tuple, i, out);
+			}
+			out.write((byte)'}');
+		}
+	}
+
+	/**
+	 * Attributes of types without encoder, like optional, map, decimal and timestamp types,
+	 * are encoded by JSONEncoding. Keys of nested tuples are renamed before the value is written.
+	 */
+	private static final class FallbackEncoder extends Encoder {
+		private final String name;
+		private final Renaming renaming;
+
+		FallbackEncoder(String name, Renaming renaming) {
+			this.name = name;
+			this.renaming = renaming;
+		}
+
+		@Override
+		void encodeAttribute(Tuple tuple, int index, JSONByteWriter out) throws IOException {
+			JSONEncoding<JSONObject, JSONArray> je = EncodingFactory.getJSONEncoding();
+			Object value = je.getAttributeObject(tuple, name);
+			if(value != null)
+				renaming.rename(value);
+			encodeValue(value, out);
+		}
+
+		@Override
+		void encodeValue(Object value, JSONByteWriter out) throws IOException {
+			if(value == null)
+				out.writeNull();
+			else if(value instanceof JSONArtifact)
+				out.writeRaw(((JSONArtifact)value).serialize());
+			else if(value instanceof String)
+				out.writeString((String)value);
+			else if(value instanceof Boolean)
+				out.writeBoolean((Boolean)value);
+			else if(value instanceof Number)
+				out.writeRaw(value.toString());
+			else
+				out.writeString(value.toString());
+		}
+	}
 
 	/**
 	 * Converts an SPL tuple to a String representation of a JSONObject 
@@ -0,0 +1,355 @@
+package com.ibm.streamsx.json.benchmark;
+
+import java.lang.management.GarbageCollectorMXBean;
+import java.lang.management.ManagementFactory;
+import java.lang.management.ThreadMXBean;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+
+import com.ibm.json.java.JSONArray;
+import com.ibm.json.java.JSONObject;
+import com.ibm.streams.flow.declare.InputPortDeclaration;
+import com.ibm.streams.flow.declare.OperatorGraph;
+import com.ibm.streams.flow.declare.OperatorGraphFactory;
+import com.ibm.streams.flow.declare.OperatorInvocation;
+import com.ibm.streams.flow.javaprimitives.JavaOperatorTester;
+import com.ibm.streams.flow.javaprimitives.JavaTestableGraph;
+import com.ibm.streams.operator.AbstractOperator;
+import com.ibm.streams.operator.OutputTuple;
+import com.ibm.streams.operator.StreamSchema;
+import com.ibm.streams.operator.Tuple;
+import com.ibm.streams.operator.StreamingOutput;
+import com.ibm.streams.operator.Type;
+import com.ibm.streamsx.json.converters.JSONByteWriter;
+import com.ibm.streamsx.json.converters.JSONToTupleConverter;
+import com.ibm.streamsx.json.converters.TupleToJSONConverter;
+
+/**
+ * Benchmark of the static conversion methods of {@link JSONToTupleConverter} and
+ * {@link TupleToJSONConverter}, the convert methods of a JSONToTupleConverter instance
+ * from a String and from UTF-8 bytes, as used by the JSONToTuple operator, and the
+ * encoder of a TupleToJSONConverter instance, on schemas and documents generated
+ * from a fixed seed.
+ * <p>
+ * Each function runs on each shape for the warm-up time so that the JIT compiled
+ * it, then for the given number of measured iterations. One JSON line per function
+ * and shape is written to stdout:
+ * <pre>
+ * {"function":"jsonToTuple","shape":"flat","opsPerSec":..,"minOpsPerSec":..,"maxOpsPerSec":..,
+ *  "bytesAllocatedPerOp":..,"allocationMBPerSec":..,"gcCount":..,"gcMillis":..}
+ * </pre>
+ * opsPerSec is the mean of the iterations, the allocations are those of the
+ * benchmark thread (-1 if the JVM does not count them) and the garbage
+ * collections are those of all collectors during the measured iterations.
+ * <p>
+ * Usage: ConverterBenchmark [-w warmupSeconds] [-t iterationSeconds] [-i iterations] [-f function|shape]
+ */
+public class ConverterBenchmark {
+
+	// results are stored so that the JIT cannot eliminate the conversions
+	private static volatile Object sink;
+
+	/**
+	 * Operator without function, the output tuples for the convert methods are
+	 * created by the input port testers of its invocations.
+	 */
+	public static class TupleFactory extends AbstractOperator {
+	}
+
+	/**
+	 * One function on one shape.
+	 */
+	private static abstract class Benchmark {
+		final String function;
+		final String shape;
+
+		Benchmark(String function, String shape) {
+			this.function = function;
+			this.shape = shape;
+		}
+
+		abstract Object run() throws Exception;
+	}
+
+	/**
+	 * Schema with a generated document and the tuple converted from it.
+	 * For the array shapes the attribute {@code values} is the list.
+	 */
+	private static class Shape {
+		final String name;
+		final StreamSchema schema;
+		final JSONObject document;
+		final Tuple tuple;
+
+		Shape(String name, String schema, JSONObject document) throws Exception {
+			this.name = name;
+			this.schema = Type.Factory.getStreamSchema(schema);
+			this.document = document;
+			this.tuple = JSONToTupleConverter.jsonToTuple(document, this.schema);
+		}
+	}
+
+	private static final String CHARS = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"; //$NON-NLS-1$
+
+	private static String text(Random random, int length) {
+		StringBuilder s = new StringBuilder(length);
+		for(int i = 0; i < length; i++)
+			s.append(CHARS.charAt(random.nextInt(CHARS.length())));
+		return s.toString();
+	}
+
+	/* 16 attributes each of int64, float64, boolean and rstring */
+	private static Shape flat(Random random) throws Exception {
+		StringBuilder schema = new StringBuilder("tuple<"); //$NON-NLS-1$
+		JSONObject document = new JSONObject();
+		for(int i = 0; i < 16; i++) {
+			schema.append(i == 0 ? "" : ", ").append("int64 i").append(i).append(", float64 f").append(i) //$NON-NLS-1$ //$NON-NLS-2$ //$NON-NLS-3$ //$NON-NLS-4$ //$NON-NLS-5$
+				.append(", boolean b").append(i).append(", rstring s").append(i); //$NON-NLS-1$ //$NON-NLS-2$
+			document.put("i" + i, random.nextLong()); //$NON-NLS-1$
+			document.put("f" + i, random.nextDouble() * 1000); //$NON-NLS-1$
+			document.put("b" + i, random.nextBoolean()); //$NON-NLS-1$
+			document.put("s" + i, text(random, 20)); //$NON-NLS-1$
+		}
+		return new Shape("flat", schema.append('>').toString(), document); //$NON-NLS-1$
+	}
+
+	/* tuples nested 12 levels deep */
+	private static Shape deep(Random random) throws Exception {
+		String schema = "tuple<int32 level, list<int32> values>"; //$NON-NLS-1$
+		JSONObject document = new JSONObject();
+		document.put("level", 0); //$NON-NLS-1$
+		JSONArray values = new JSONArray();
+		for(int i = 0; i < 4; i++)
+			values.add(random.nextInt());
+		document.put("values", values); //$NON-NLS-1$
+
+		for(int level = 1; level <= 12; level++) {
+			schema = "tuple<int32 level, rstring name, " + schema + " child>"; //$NON-NLS-1$ //$NON-NLS-2$
+			JSONObject parent = new JSONObject();
+			parent.put("level", level); //$NON-NLS-1$
+			parent.put("name", text(random, 8)); //$NON-NLS-1$
+			parent.put("child", document); //$NON-NLS-1$
+			document = parent;
+		}
+		return new Shape("deep", schema, document); //$NON-NLS-1$
+	}
+
+	/* list of 500 strings */
+	private static Shape stringArray(Random random) throws Exception {
+		JSONArray values = new JSONArray();
+		for(int i = 0; i < 500; i++)
+			values.add(text(random, 1 + random.nextInt(30)));
+		JSONObject document = new JSONObject();
+		document.put("values", values); //$NON-NLS-1$
+		return new Shape("stringArray", "tuple<list<rstring> values>", document); //$NON-NLS-1$ //$NON-NLS-2$
+	}
+
+	/* list of 1000 float64 */
+	private static Shape numericArray(Random random) throws Exception {
+		JSONArray values = new JSONArray();
+		for(int i = 0; i < 1000; i++)
+			values.add(random.nextDouble() * Math.pow(10, random.nextInt(12) - 6));
+		JSONObject document = new JSONObject();
+		document.put("values", values); //$NON-NLS-1$
+		return new Shape("numericArray", "tuple<list<float64> values>", document); //$NON-NLS-1$ //$NON-NLS-2$
+	}
+
+	/*
+	 * Graph with one operator per shape, the convert methods of JSONToTupleConverter
+	 * convert to an OutputTuple, which only a port creates
+	 */
+	private static JavaTestableGraph createTupleFactories(List<Shape> shapes, List<StreamingOutput<OutputTuple>> ports) throws Exception {
+		OperatorGraph graph = OperatorGraphFactory.newGraph();
+		List<InputPortDeclaration> inputs = new ArrayList<InputPortDeclaration>();
+		for(Shape shape : shapes) {
+			OperatorInvocation<TupleFactory> factory = graph.addOperator(TupleFactory.class);
+			inputs.add(factory.addInput(shape.schema));
+		}
+
+		JavaTestableGraph testableGraph = new JavaOperatorTester().executable(graph);
+		testableGraph.initialize().get().allPortsReady().get();
+		for(InputPortDeclaration input : inputs)
+			ports.add(testableGraph.getInputTester(input));
+		return testableGraph;
+	}
+
+	private static List<Benchmark> benchmarks(List<JavaTestableGraph> graphs) throws Exception {
+		Random random = new Random(42);
+		List<Shape> tupleShapes = new ArrayList<Shape>();
+		tupleShapes.add(flat(random));
+		tupleShapes.add(deep(random));
+		List<Shape> arrayShapes = new ArrayList<Shape>();
+		arrayShapes.add(stringArray(random));
+		arrayShapes.add(numericArray(random));
+		List<Shape> allShapes = new ArrayList<Shape>(tupleShapes);
+		allShapes.addAll(arrayShapes);
+
+		final TupleToJSONConverter encoder = new TupleToJSONConverter(null);
+		final JSONByteWriter out = new JSONByteWriter();
+		final JSONToTupleConverter converter = new JSONToTupleConverter(null);
+		List<StreamingOutput<OutputTuple>> ports = new ArrayList<StreamingOutput<OutputTuple>>();
+		graphs.add(createTupleFactories(allShapes, ports));
+
+		List<Benchmark> benchmarks = new ArrayList<Benchmark>();
+		for(int s = 0; s < allShapes.size(); s++) {
+			final Shape shape = allShapes.get(s);
+			// the output tuple is reused, each document sets all its attributes
+			final OutputTuple output = ports.get(s).newTuple();
+			final String json = shape.document.serialize();
+			final byte[] utf8 = json.getBytes(StandardCharsets.UTF_8);
+
+			benchmarks.add(new Benchmark("jsonToAtributeMap", shape.name) { //$NON-NLS-1$
+				Object run() throws Exception {
+					return JSONToTupleConverter.jsonToAtributeMap(shape.document, shape.schema);
+				}
+			});
+			benchmarks.add(new Benchmark("jsonToTuple", shape.name) { //$NON-NLS-1$
+				Object run() throws Exception {
+					return JSONToTupleConverter.jsonToTuple(shape.document, shape.schema);
+				}
+			});
+			benchmarks.add(new Benchmark("convertString", shape.name) { //$NON-NLS-1$
+				Object run() throws Exception {
+					converter.convert(json, output, null);
+					return output;
+				}
+			});
+			benchmarks.add(new Benchmark("convertBytes", shape.name) { //$NON-NLS-1$
+				Object run() throws Exception {
+					converter.convert(utf8, 0, utf8.length, output, null);
+					return output;
+				}
+			});
+			benchmarks.add(new Benchmark("convertTuple", shape.name) { //$NON-NLS-1$
+				Object run() throws Exception {
+					return TupleToJSONConverter.convertTuple(shape.tuple);
+				}
+			});
+			benchmarks.add(new Benchmark("encode", shape.name) { //$NON-NLS-1$
+				Object run() throws Exception {
+					out.reset();
+					encoder.encode(shape.tuple, out);
+					return out;
+				}
+			});
+		}
+		for(final Shape shape : arrayShapes) {
+			// arrayToSPLArray is reached through jsonToAttribute for lists of primitive types
+			final Type type = shape.schema.getAttribute("values").getType(); //$NON-NLS-1$
+			final Object array = shape.document.get("values"); //$NON-NLS-1$
+			benchmarks.add(new Benchmark("arrayToSPLArray", shape.name) { //$NON-NLS-1$
+				Object run() throws Exception {
+					return JSONToTupleConverter.jsonToAttribute("values", type, array, null); //$NON-NLS-1$
+				}
+			});
+			benchmarks.add(new Benchmark("convertArray", shape.name) { //$NON-NLS-1$
+				Object run() throws Exception {
+					return TupleToJSONConverter.convertArray(shape.tuple, "values"); //$NON-NLS-1$
+				}
+			});
+		}
+		return benchmarks;
+	}
+
+	/**
+	 * Counters of the benchmark thread and the garbage collectors at one point in time.
+	 */
+	private static class Snapshot {
+		final long nanos = System.nanoTime();
+		final long allocatedBytes = allocatedBytes();
+		long gcCount;
+		long gcMillis;
+
+		Snapshot() {
+			for(GarbageCollectorMXBean gc : ManagementFactory.getGarbageCollectorMXBeans()) {
+				gcCount += Math.max(0, gc.getCollectionCount());
+				gcMillis += Math.max(0, gc.getCollectionTime());
+			}
+		}
+
+		private static long allocatedBytes() {
+			ThreadMXBean threads = ManagementFactory.getThreadMXBean();
+			if(threads instanceof com.sun.management.ThreadMXBean) {
+				com.sun.management.ThreadMXBean counting = (com.sun.management.ThreadMXBean) threads;
+				if(counting.isThreadAllocatedMemorySupported() && counting.isThreadAllocatedMemoryEnabled())
+					return counting.getThreadAllocatedBytes(Thread.currentThread().getId());
+			}
+			return -1;
+		}
+	}
+
+	/* runs the benchmark for at least the given time, returns the number of operations */
+	private static long runFor(Benchmark benchmark, long nanos) throws Exception {
+		long ops = 0;
+		long end = System.nanoTime() + nanos;
+		// the clock is read every 64 operations to keep it out of the measurement
+		do {
+			for(int i = 0; i < 64; i++)
+				sink = benchmark.run();
+			ops += 64;
+		} while(System.nanoTime() < end);
+		return ops;
+	}
+
+	private static String measure(Benchmark benchmark, double warmupSeconds, double iterationSeconds, int iterations) throws Exception {
+		runFor(benchmark, (long) (warmupSeconds * 1e9));
+		System.gc();
+
+		double totalOpsPerSec = 0;
+		double minOpsPerSec = Double.MAX_VALUE;
+		double maxOpsPerSec = 0;
+		long totalOps = 0;
+		Snapshot start = new Snapshot();
+		for(int i = 0; i < iterations; i++) {
+			long iterationStart = System.nanoTime();
+			long ops = runFor(benchmark, (long) (iterationSeconds * 1e9));
+			double opsPerSec = ops * 1e9 / (System.nanoTime() - iterationStart);
+			totalOpsPerSec += opsPerSec;
+			minOpsPerSec = Math.min(minOpsPerSec, opsPerSec);
+			maxOpsPerSec = Math.max(maxOpsPerSec, opsPerSec);
+			totalOps += ops;
+		}
+		Snapshot end = new Snapshot();
+
+		double seconds = (end.nanos - start.nanos) / 1e9;
+		boolean counted = start.allocatedBytes >= 0 && end.allocatedBytes >= 0;
+		long allocated = end.allocatedBytes - start.allocatedBytes;
+		return String.format("{\"function\":\"%s\",\"shape\":\"%s\",\"opsPerSec\":%.1f,\"minOpsPerSec\":%.1f,\"maxOpsPerSec\":%.1f," //$NON-NLS-1$
+				+ "\"bytesAllocatedPerOp\":%.1f,\"allocationMBPerSec\":%.1f,\"gcCount\":%d,\"gcMillis\":%d}", //$NON-NLS-1$
+				benchmark.function, benchmark.shape, totalOpsPerSec / iterations, minOpsPerSec, maxOpsPerSec,
+				counted ? (double) allocated / totalOps : -1.0, counted ? allocated / seconds / 1e6 : -1.0,
+				end.gcCount - start.gcCount, end.gcMillis - start.gcMillis);
+	}
+
+	public static void main(String[] args) throws Exception {
+		double warmupSeconds = 5;
+		double iterationSeconds = 1;
+		int iterations = 5;
+		String filter = null;
+		for(int i = 0; i + 1 < args.length; i += 2) {
+			if("-w".equals(args[i])) //$NON-NLS-1$
+				warmupSeconds = Double.parseDouble(args[i + 1]);
+			else if("-t".equals(args[i])) //$NON-NLS-1$
+				iterationSeconds = Double.parseDouble(args[i + 1]);
+			else if("-i".equals(args[i])) //$NON-NLS-1$
+				iterations = Integer.parseInt(args[i + 1]);
+			else if("-f".equals(args[i])) //$NON-NLS-1$
+				filter = args[i + 1];
+			else
+				throw new IllegalArgumentException("Usage: ConverterBenchmark [-w warmupSeconds] [-t iterationSeconds] [-i iterations] [-f function|shape]"); //$NON-NLS-1$
+		}
+
+		List<JavaTestableGraph> graphs = new ArrayList<JavaTestableGraph>();
+		try {
+			for(Benchmark benchmark : benchmarks(graphs)) {
+				if(filter == null || filter.equals(benchmark.function) || filter.equals(benchmark.shape))
+					System.out.println(measure(benchmark, warmupSeconds, iterationSeconds, iterations));
+			}
+		} finally {
+			for(JavaTestableGraph graph : graphs)
+				graph.shutdown().get();
+		}
+	}
+}
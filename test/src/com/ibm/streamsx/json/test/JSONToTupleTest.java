@@ -4,6 +4,8 @@ import static org.junit.Assert.assertEquals;
 import static org.junit.Assert.assertFalse;
 import static org.junit.Assert.assertTrue;
 
+import java.nio.charset.StandardCharsets;
+
 import org.junit.Test;
 
 import com.ibm.json.java.JSONObject;
@@ -20,7 +22,9 @@ import com.ibm.streams.operator.StreamSchema;
 import com.ibm.streams.operator.StreamingOutput;
 import com.ibm.streams.operator.Tuple;
 import com.ibm.streams.operator.Type;
+import com.ibm.streams.operator.metrics.OperatorMetrics;
 import com.ibm.streams.operator.types.RString;
+import com.ibm.streams.operator.types.ValueFactory;
 import com.ibm.streamsx.json.JSONToTuple;
 
 public class JSONToTupleTest {
@@ -91,4 +95,92 @@ public class JSONToTupleTest {
 		testableGraph.shutdown().get();
 		
 	}
+
+	/**
+	 * Test JSON in rstring and blob attributes is parsed from its UTF-8 bytes.
+	 */
+	@Test
+	public void testUTF8Input() throws Exception {
+
+		OperatorGraph graph = OperatorGraphFactory.newGraph();
+
+		StreamSchema inSchema = Type.Factory.getStreamSchema("tuple<blob jsonBlob, rstring jsonString>");
+		StreamSchema outSchema = Type.Factory.getStreamSchema("tuple<rstring s, list<rstring> l, int32 n>");
+
+		OperatorInvocation<JSONToTuple> fromBlob = graph.addOperator(JSONToTuple.class);
+		fromBlob.setStringParameter("jsonStringAttribute", "jsonBlob");
+		InputPortDeclaration blobInput = fromBlob.addInput(inSchema);
+		OutputPortDeclaration blobOutput = fromBlob.addOutput(outSchema);
+
+		OperatorInvocation<JSONToTuple> fromRString = graph.addOperator(JSONToTuple.class);
+		InputPortDeclaration rstringInput = fromRString.addInput(inSchema);
+		OutputPortDeclaration rstringOutput = fromRString.addOutput(outSchema);
+
+		assertTrue(graph.compileChecks());
+
+		JavaTestableGraph testableGraph = new JavaOperatorTester().executable(graph);
+
+		StreamingOutput<OutputTuple> blobTester = testableGraph.getInputTester(blobInput);
+		StreamingOutput<OutputTuple> rstringTester = testableGraph.getInputTester(rstringInput);
+
+		MostRecent<Tuple> blobResult = new MostRecent<>();
+		testableGraph.registerStreamHandler(blobOutput, blobResult);
+		MostRecent<Tuple> rstringResult = new MostRecent<>();
+		testableGraph.registerStreamHandler(rstringOutput, rstringResult);
+
+		testableGraph.initialize().get().allPortsReady().get();
+
+		// two, three and four byte sequences and an escaped surrogate pair
+		String json = "{\"s\": \"\u00e4\u20ac\ud83d\ude00\", \"l\": [\"\\ud83d\\ude00\", \"x\"], \"n\": 7}";
+		byte[] utf8 = json.getBytes(StandardCharsets.UTF_8);
+
+		blobTester.submitAsTuple(ValueFactory.newBlob(utf8, 0, utf8.length), new RString(""));
+		rstringTester.submitAsTuple(ValueFactory.newBlob(new byte[0], 0, 0), new RString(utf8));
+
+		for(Tuple outTuple : new Tuple[] {blobResult.getMostRecentTuple(), rstringResult.getMostRecentTuple()}) {
+			assertEquals("\u00e4\u20ac\ud83d\ude00", outTuple.getString("s"));
+			assertEquals(new RString("\ud83d\ude00"), outTuple.getList("l").get(0));
+			assertEquals(7, outTuple.getInt("n"));
+		}
+
+		testableGraph.shutdown().get();
+	}
+
+	/**
+	 * Test the custom metrics of the converted JSON strings, keys and errors.
+	 */
+	@Test
+	public void testMetrics() throws Exception {
+
+		OperatorGraph graph = OperatorGraphFactory.newGraph();
+
+		StreamSchema inSchema = Type.Factory.getStreamSchema("tuple<rstring jsonString>");
+		StreamSchema outSchema = Type.Factory.getStreamSchema("tuple<int32 a, tuple<int32 b> t>");
+
+		OperatorInvocation<JSONToTuple> json2Tuple = graph.addOperator(JSONToTuple.class);
+		json2Tuple.setBooleanParameter("ignoreParsingError", true);
+		InputPortDeclaration input = json2Tuple.addInput(inSchema);
+		json2Tuple.addOutput(outSchema);
+
+		assertTrue(graph.compileChecks());
+
+		JavaTestableGraph testableGraph = new JavaOperatorTester().executable(graph);
+		StreamingOutput<OutputTuple> testInput = testableGraph.getInputTester(input);
+		testableGraph.initialize().get().allPortsReady().get();
+
+		// keys in a dropped value are not counted, keys read before an error are
+		testInput.submitAsTuple(new RString("{\"a\": 1, \"x\": {\"y\": 2}, \"t\": {\"b\": 2, \"c\": 3}}"));
+		testInput.submitAsTuple(new RString("{\"a\" 1}"));
+		testInput.submitAsTuple(new RString("{\"a\": \"one\"}"));
+
+		OperatorMetrics metrics = testableGraph.getOperatorInstance(json2Tuple).getOperatorContext().getMetrics();
+		assertEquals(3, metrics.getCustomMetric("nDocuments").getValue());
+		assertEquals(5, metrics.getCustomMetric("nKeysMatched").getValue());
+		assertEquals(2, metrics.getCustomMetric("nKeysDropped").getValue());
+		assertEquals(1, metrics.getCustomMetric("nParseErrors").getValue());
+		assertEquals(1, metrics.getCustomMetric("nConversionErrors").getValue());
+		assertEquals(46, metrics.getCustomMetric("maxDocumentSize").getValue());
+
+		testableGraph.shutdown().get();
+	}
 }
@@ -0,0 +1,138 @@
+package com.ibm.streamsx.json.test;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.Map;
+
+import org.junit.Test;
+
+import com.ibm.json.java.JSONArray;
+import com.ibm.json.java.JSONObject;
+import com.ibm.streams.flow.declare.InputPortDeclaration;
+import com.ibm.streams.flow.declare.OperatorGraph;
+import com.ibm.streams.flow.declare.OperatorGraphFactory;
+import com.ibm.streams.flow.declare.OperatorInvocation;
+import com.ibm.streams.flow.declare.OutputPortDeclaration;
+import com.ibm.streams.flow.handlers.MostRecent;
+import com.ibm.streams.flow.javaprimitives.JavaOperatorTester;
+import com.ibm.streams.flow.javaprimitives.JavaTestableGraph;
+import com.ibm.streams.operator.OutputTuple;
+import com.ibm.streams.operator.StreamSchema;
+import com.ibm.streams.operator.StreamingOutput;
+import com.ibm.streams.operator.Tuple;
+import com.ibm.streams.operator.Type;
+import com.ibm.streams.operator.types.RString;
+import com.ibm.streamsx.json.JSONToTuple;
+import com.ibm.streamsx.json.converters.JSONToTupleConverter;
+import com.ibm.streamsx.json.converters.TupleToJSONConverter;
+
+public class PrefixToIgnoreTest {
+
+	private static final String json = "{\"a\": \"v\", \"t\": {\"b\": 5}}";
+	private static final StreamSchema outSchema = Type.Factory.getStreamSchema("tuple<rstring __a, rstring x_a, tuple<int32 x_b> t>");
+
+	/**
+	 * Test converters with different prefixes don't affect each other.
+	 */
+	@Test
+	public void testConverterInstances() throws Exception {
+		JSONToTupleConverter underscore = new JSONToTupleConverter("__");
+		JSONToTupleConverter x = new JSONToTupleConverter("x_");
+
+		Tuple tuple = underscore.toTuple(JSONObject.parse(json), outSchema);
+		assertEquals("v", tuple.getString("__a"));
+		assertEquals("", tuple.getString("x_a"));
+		assertEquals(0, tuple.getTuple("t").getInt("x_b"));
+
+		tuple = x.toTuple(JSONObject.parse(json), outSchema);
+		assertEquals("", tuple.getString("__a"));
+		assertEquals("v", tuple.getString("x_a"));
+		assertEquals(5, tuple.getTuple("t").getInt("x_b"));
+
+		tuple = underscore.toTuple(JSONObject.parse(json), outSchema);
+		assertEquals("v", tuple.getString("__a"));
+		assertEquals("", tuple.getString("x_a"));
+	}
+
+	/**
+	 * Test two JSONToTuple operators with different prefixes in one JVM.
+	 */
+	@Test
+	public void testFusedOperators() throws Exception {
+
+		OperatorGraph graph = OperatorGraphFactory.newGraph();
+
+		StreamSchema inSchema = Type.Factory.getStreamSchema("tuple<rstring jsonString>");
+
+		OperatorInvocation<JSONToTuple> underscore = graph.addOperator(JSONToTuple.class);
+		underscore.setStringParameter("prefixToIgnore", "__");
+		InputPortDeclaration underscoreInput = underscore.addInput(inSchema);
+		OutputPortDeclaration underscoreOutput = underscore.addOutput(outSchema);
+
+		OperatorInvocation<JSONToTuple> x = graph.addOperator(JSONToTuple.class);
+		x.setStringParameter("prefixToIgnore", "x_");
+		InputPortDeclaration xInput = x.addInput(inSchema);
+		OutputPortDeclaration xOutput = x.addOutput(outSchema);
+
+		assertTrue(graph.compileChecks());
+
+		JavaTestableGraph testableGraph = new JavaOperatorTester().executable(graph);
+
+		StreamingOutput<OutputTuple> underscoreTester = testableGraph.getInputTester(underscoreInput);
+		StreamingOutput<OutputTuple> xTester = testableGraph.getInputTester(xInput);
+
+		MostRecent<Tuple> underscoreResult = new MostRecent<>();
+		testableGraph.registerStreamHandler(underscoreOutput, underscoreResult);
+		MostRecent<Tuple> xResult = new MostRecent<>();
+		testableGraph.registerStreamHandler(xOutput, xResult);
+
+		testableGraph.initialize().get().allPortsReady().get();
+
+		underscoreTester.submitAsTuple(new RString(json));
+		xTester.submitAsTuple(new RString(json));
+
+		Tuple outTuple = underscoreResult.getMostRecentTuple();
+		assertEquals("v", outTuple.getString("__a"));
+		assertEquals("", outTuple.getString("x_a"));
+		assertEquals(0, outTuple.getTuple("t").getInt("x_b"));
+
+		outTuple = xResult.getMostRecentTuple();
+		assertEquals("", outTuple.getString("__a"));
+		assertEquals("v", outTuple.getString("x_a"));
+		assertEquals(5, outTuple.getTuple("t").getInt("x_b"));
+
+		testableGraph.shutdown().get();
+	}
+
+	/**
+	 * Test the prefix is removed from attribute names in nested tuples but not from string values.
+	 */
+	@Test
+	public void testTupleToJSONConverter() throws Exception {
+		StreamSchema innerSchema = Type.Factory.getStreamSchema("tuple<rstring __b>");
+		StreamSchema schema = Type.Factory.getStreamSchema("tuple<rstring __a, list<tuple<rstring __b>> l>");
+
+		Map<String, Object> inner = new HashMap<>();
+		inner.put("__b", new RString("\"__c"));
+		Map<String, Object> map = new HashMap<>();
+		map.put("__a", new RString("x"));
+		map.put("l", Arrays.asList(innerSchema.getTuple(inner)));
+		Tuple tuple = schema.getTuple(map);
+
+		JSONObject json = JSONObject.parse(new TupleToJSONConverter("__").toJSON(tuple));
+		assertEquals("x", json.get("a"));
+		assertFalse(json.containsKey("__a"));
+		JSONObject element = (JSONObject)((JSONArray)json.get("l")).get(0);
+		assertEquals("\"__c", element.get("b"));
+
+		JSONArray array = JSONArray.parse(new TupleToJSONConverter("__").arrayToJSON(tuple, "l"));
+		assertEquals("\"__c", ((JSONObject)array.get(0)).get("b"));
+
+		json = JSONObject.parse(new TupleToJSONConverter(null).toJSON(tuple));
+		assertEquals("x", json.get("__a"));
+	}
+}
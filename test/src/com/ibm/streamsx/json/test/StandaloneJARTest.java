@@ -14,6 +14,10 @@ import com.ibm.streams.operator.StreamSchema;
 import com.ibm.streams.operator.Tuple;
 import com.ibm.streams.operator.Type;
 import com.ibm.streams.operator.types.RString;
+import com.ibm.streamsx.json.converters.ConversionErrorLog;
+import com.ibm.streamsx.json.converters.JSONByteWriter;
+import com.ibm.streamsx.json.converters.JSONParseException;
+import com.ibm.streamsx.json.converters.JSONTokenizer;
 import com.ibm.streamsx.json.converters.JSONToTupleConverter;
 import com.ibm.streamsx.json.converters.TupleToJSONConverter;
 
@@ -83,6 +87,85 @@ public class StandaloneJARTest {
 				.replace(" ", "");
 		
 		Assert.assertEquals(rawExpected, json);
+
+		JSONByteWriter out = new JSONByteWriter();
+		new TupleToJSONConverter(null).encode(tuple, out);
+		Assert.assertEquals(rawExpected, out.toString());
+		Assert.assertEquals(new RString(rawExpected), out.toRString());
+	}
+
+	@Test
+	public void encode() throws Exception {
+		StreamSchema encodeSchema = Type.Factory.getStreamSchema(
+				"tuple<uint8 u8, uint64 u64, int64 i64, rstring r, ustring u, list<float64> l, map<rstring,int32> m>");
+		Map<String, Object> map = new HashMap<>();
+		map.put("u8", (byte)-1);
+		map.put("u64", -1L);
+		map.put("i64", Long.MIN_VALUE);
+		map.put("r", new RString("\"\u00e4\n\\"));
+		map.put("u", "\u20ac\ud83d\ude00");
+		map.put("l", Arrays.asList(1.5, -2.0));
+		map.put("m", new HashMap<RString, Integer>());
+		Tuple tuple = encodeSchema.getTuple(map);
+
+		JSONByteWriter out = new JSONByteWriter();
+		new TupleToJSONConverter(null).encode(tuple, out);
+		Assert.assertEquals("{\"u8\":255,\"u64\":18446744073709551615,\"i64\":-9223372036854775808," +
+				"\"r\":\"\\\"\u00e4\\n\\\\\",\"u\":\"\u20ac\ud83d\ude00\",\"l\":[1.5,-2.0],\"m\":{}}", out.toString());
+
+		out.reset();
+		new TupleToJSONConverter(null).encodeAttribute(tuple, "l", out);
+		Assert.assertEquals("[1.5,-2.0]", out.toString());
+	}
+
+	@Test
+	public void encodeNonFinite() throws Exception {
+		StreamSchema encodeSchema = Type.Factory.getStreamSchema(
+				"tuple<float64 nan, float32 inf, list<float64> l>");
+		Map<String, Object> map = new HashMap<>();
+		map.put("nan", Double.NaN);
+		map.put("inf", Float.NEGATIVE_INFINITY);
+		map.put("l", Arrays.asList(1.5, Double.POSITIVE_INFINITY));
+		Tuple tuple = encodeSchema.getTuple(map);
+
+		// JSON has no literal for NaN and infinity, they are written as null
+		JSONByteWriter out = new JSONByteWriter();
+		new TupleToJSONConverter(null).encode(tuple, out);
+		Assert.assertEquals("{\"nan\":null,\"inf\":null,\"l\":[1.5,null]}", out.toString());
+	}
+
+	@Test
+	public void errorLog() throws Exception {
+		JSONTokenizer tokenizer = new JSONTokenizer();
+		JSONParseException invalid = null;
+		try {
+			tokenizer.reset("{\"a\" 1}");
+			while(tokenizer.next() != JSONTokenizer.END);
+		} catch(JSONParseException e) {
+			invalid = e;
+		}
+		Assert.assertNotNull(invalid);
+		Assert.assertEquals(5, invalid.getPosition());
+
+		ConversionErrorLog errors = new ConversionErrorLog(60000);
+		Assert.assertTrue(errors.add(invalid));
+		Assert.assertEquals("", errors.summary());
+		Assert.assertFalse(errors.add(invalid));
+		Assert.assertFalse(errors.add(new Exception("conversion")));
+		Assert.assertEquals(3, errors.getErrorCount());
+		Assert.assertEquals(2, errors.getInvalidJSONCount());
+		Assert.assertEquals(5, errors.getFirstPosition());
+		Assert.assertEquals("':' expected", invalid.getReason());
+		Assert.assertEquals(2, errors.getCount("':' expected"));
+		Assert.assertEquals(1, errors.getCount("Exception"));
+		String summary = errors.summary();
+		Assert.assertTrue(summary.contains("2 errors not logged"));
+		Assert.assertTrue(summary.contains("3 errors in total: ':' expected=2 Exception=1, first at position 5, last at position 5)"));
+		Assert.assertEquals("", errors.summary());
+
+		errors = new ConversionErrorLog(0);
+		Assert.assertTrue(errors.add(invalid));
+		Assert.assertTrue(errors.add(invalid));
 	}
 	
 }
@@ -0,0 +1,407 @@
+/*
+ * JsonBenchmark.cpp
+ *
+ * Microbenchmark of the native functions tupleToJSON, mapToJSON, extractFromJSON,
+ * parseJSON and queryJSON over documents of different shapes, built with the SPL
+ * runtime shim (see ../Makefile).
+ *
+ * Each function runs on each shape until the minimum time elapsed, one JSON line
+ * per function and shape is written to stdout:
+ *   {"function":"parseJSON","shape":"flat","docs":..,"bytesPerDoc":..,"nsPerDoc":..,
+ *    "docsPerSec":..,"mbPerSec":..,"allocsPerDoc":..}
+ * mbPerSec is the JSON bytes written or read per second (0 for queryJSON, which
+ * queries a document parsed before), allocsPerDoc counts the
+ * calls of malloc, calloc and realloc, which includes operator new.
+ *
+ * simd is the level of the rapidjson kernels, the best one the CPU supports or the
+ * one selected with -s.
+ *
+ * Usage: JsonBenchmark [-t seconds] [-f function|shape] [-s scalar|sse2|sse4.2|avx2]
+ */
+
+#include "Json.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+using namespace com::ibm::streamsx::json;
+
+
+/*
+ * allocation counter, the allocation functions of the C library are
+ * interposed for the whole process
+ */
+static SPL::uint64 allocations = 0;
+
+extern "C" {
+	void * __libc_malloc(size_t size);
+	void * __libc_calloc(size_t count, size_t size);
+	void * __libc_realloc(void * ptr, size_t size);
+
+	void * malloc(size_t size) {
+		allocations++;
+		return __libc_malloc(size);
+	}
+
+	void * calloc(size_t count, size_t size) {
+		allocations++;
+		return __libc_calloc(count, size);
+	}
+
+	void * realloc(void * ptr, size_t size) {
+		allocations++;
+		return __libc_realloc(ptr, size);
+	}
+}
+
+
+/*
+ * shapes
+ */
+static SPL::rstring text(size_t length, size_t seed) {
+	static const char chars[] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+	SPL::rstring s;
+	for(size_t i = 0; i < length; i++)
+		s += chars[(seed * 31 + i * 7) % (sizeof(chars) - 1)];
+	return s;
+}
+
+/* 16 attributes each of int64, float64, boolean and rstring */
+struct FlatTuple : SPL::Tuple {
+	enum { WIDTH = 16 };
+
+	SPL::int64 ints[WIDTH];
+	SPL::float64 floats[WIDTH];
+	SPL::boolean flags[WIDTH];
+	SPL::rstring strings[WIDTH];
+
+	FlatTuple() { reg(); }
+	FlatTuple(FlatTuple const& o) : SPL::Tuple() { *this = o; reg(); }
+	FlatTuple & operator=(FlatTuple const& o) {
+		for(int i = 0; i < WIDTH; i++) {
+			ints[i] = o.ints[i]; floats[i] = o.floats[i]; flags[i] = o.flags[i]; strings[i] = o.strings[i];
+		}
+		return *this;
+	}
+
+	void reg() {
+		static const char * const prefixes[] = { "i", "f", "b", "s" };
+		for(int i = 0; i < WIDTH; i++) {
+			char name[8];
+			snprintf(name, sizeof(name), "%s%d", prefixes[0], i); addAttribute(name, ints[i]);
+			snprintf(name, sizeof(name), "%s%d", prefixes[1], i); addAttribute(name, floats[i]);
+			snprintf(name, sizeof(name), "%s%d", prefixes[2], i); addAttribute(name, flags[i]);
+			snprintf(name, sizeof(name), "%s%d", prefixes[3], i); addAttribute(name, strings[i]);
+		}
+	}
+
+	void fill() {
+		for(int i = 0; i < WIDTH; i++) {
+			ints[i] = i * 1000003LL;
+			floats[i] = i * 3.14159;
+			flags[i] = i % 2 == 0;
+			strings[i] = text(20, i);
+		}
+	}
+};
+
+/* tuples nested DEPTH levels deep */
+template<int DEPTH>
+struct DeepTuple : SPL::Tuple {
+	SPL::int32 level;
+	SPL::rstring name;
+	DeepTuple<DEPTH - 1> child;
+
+	DeepTuple() : level(0) { reg(); }
+	DeepTuple(DeepTuple const& o) : SPL::Tuple(), level(o.level), name(o.name), child(o.child) { reg(); }
+	DeepTuple & operator=(DeepTuple const& o) { level = o.level; name = o.name; child = o.child; return *this; }
+
+	void reg() { addAttribute("level", level); addAttribute("name", name); addAttribute("child", child); }
+
+	void fill() { level = DEPTH; name = text(8, DEPTH); child.fill(); }
+};
+
+template<>
+struct DeepTuple<0> : SPL::Tuple {
+	SPL::int32 level;
+	SPL::list<SPL::int32> values;
+
+	DeepTuple() : level(0) { reg(); }
+	DeepTuple(DeepTuple const& o) : SPL::Tuple(), level(o.level), values(o.values) { reg(); }
+	DeepTuple & operator=(DeepTuple const& o) { level = o.level; values = o.values; return *this; }
+
+	void reg() { addAttribute("level", level); addAttribute("values", values); }
+
+	void fill() { values = SPL::list<SPL::int32>(4, 7); }
+};
+
+typedef DeepTuple<12> DeepShape;
+
+struct StringArrayTuple : SPL::Tuple {
+	SPL::list<SPL::rstring> strings;
+
+	StringArrayTuple() { reg(); }
+	StringArrayTuple(StringArrayTuple const& o) : SPL::Tuple(), strings(o.strings) { reg(); }
+	StringArrayTuple & operator=(StringArrayTuple const& o) { strings = o.strings; return *this; }
+
+	void reg() { addAttribute("strings", strings); }
+
+	void fill() {
+		for(int i = 0; i < 500; i++)
+			strings.push_back(text(32, i));
+	}
+};
+
+struct NumericArrayTuple : SPL::Tuple {
+	SPL::list<SPL::int64> ints;
+	SPL::list<SPL::float64> floats;
+
+	NumericArrayTuple() { reg(); }
+	NumericArrayTuple(NumericArrayTuple const& o) : SPL::Tuple(), ints(o.ints), floats(o.floats) { reg(); }
+	NumericArrayTuple & operator=(NumericArrayTuple const& o) { ints = o.ints; floats = o.floats; return *this; }
+
+	void reg() { addAttribute("ints", ints); addAttribute("floats", floats); }
+
+	void fill() {
+		for(int i = 0; i < 500; i++) {
+			ints.push_back(i * 7919LL - 100000);
+			floats.push_back(i / 7.0);
+		}
+	}
+};
+
+/* every other optional is null */
+struct OptionalTuple : SPL::Tuple {
+	enum { WIDTH = 8 };
+
+	SPL::optional<SPL::int32> ints[WIDTH];
+	SPL::optional<SPL::rstring> strings[WIDTH];
+	SPL::optional<SPL::list<SPL::float64> > lists[WIDTH];
+
+	OptionalTuple() { reg(); }
+	OptionalTuple(OptionalTuple const& o) : SPL::Tuple() { *this = o; reg(); }
+	OptionalTuple & operator=(OptionalTuple const& o) {
+		for(int i = 0; i < WIDTH; i++) {
+			ints[i] = o.ints[i]; strings[i] = o.strings[i]; lists[i] = o.lists[i];
+		}
+		return *this;
+	}
+
+	void reg() {
+		for(int i = 0; i < WIDTH; i++) {
+			char name[8];
+			snprintf(name, sizeof(name), "oi%d", i); addAttribute(name, ints[i]);
+			snprintf(name, sizeof(name), "os%d", i); addAttribute(name, strings[i]);
+			snprintf(name, sizeof(name), "ol%d", i); addAttribute(name, lists[i]);
+		}
+	}
+
+	void fill() {
+		for(int i = 0; i < WIDTH; i += 2) {
+			ints[i] = i;
+			strings[i] = text(16, i);
+			lists[i] = SPL::list<SPL::float64>(4, i * 0.5);
+		}
+	}
+};
+
+/* ustring attributes with non-ASCII text, written with escapes by the writer */
+struct UStringTuple : SPL::Tuple {
+	enum { WIDTH = 16 };
+
+	SPL::ustring strings[WIDTH];
+	SPL::list<SPL::ustring> list;
+
+	UStringTuple() { reg(); }
+	UStringTuple(UStringTuple const& o) : SPL::Tuple(), list(o.list) { for(int i = 0; i < WIDTH; i++) strings[i] = o.strings[i]; reg(); }
+	UStringTuple & operator=(UStringTuple const& o) { for(int i = 0; i < WIDTH; i++) strings[i] = o.strings[i]; list = o.list; return *this; }
+
+	void reg() {
+		for(int i = 0; i < WIDTH; i++) {
+			char name[8];
+			snprintf(name, sizeof(name), "u%d", i); addAttribute(name, strings[i]);
+		}
+		addAttribute("list", list);
+	}
+
+	void fill() {
+		for(int i = 0; i < WIDTH; i++)
+			strings[i] = SPL::ustring("Gr\xc3\xbc\xc3\x9f" "e aus K\xc3\xb6ln \xe2\x82\xac \xe6\x9d\xb1\xe4\xba\xac");
+		for(int i = 0; i < 64; i++)
+			list.push_back(SPL::ustring("\xc3\xa9t\xc3\xa9 \xe2\x98\x83"));
+	}
+};
+
+
+/*
+ * measurement
+ */
+static double minSeconds = 0.5;
+static const char * filter = NULL;
+static const char * simd = "none";
+
+static SPL::uint64 now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<SPL::uint64>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/* sink the results are added to, so the calls cannot be optimized away */
+static volatile size_t sink = 0;
+
+template<typename Op>
+static void run(const char * function, const char * shape, size_t bytesPerDoc, Op op) {
+	if(filter && !strstr(function, filter) && strcmp(shape, filter) != 0)
+		return;
+
+	// warm up the caches and the reused buffers
+	for(int i = 0; i < 100; i++)
+		sink += op();
+
+	SPL::uint64 docs = 0;
+	SPL::uint64 allocs = allocations;
+	SPL::uint64 start = now();
+	SPL::uint64 elapsed = 0;
+	SPL::uint64 batch = 16;
+	while(elapsed < minSeconds * 1e9) {
+		for(SPL::uint64 i = 0; i < batch; i++)
+			sink += op();
+		docs += batch;
+		elapsed = now() - start;
+		if(batch < 4096)
+			batch *= 2;
+	}
+	allocs = allocations - allocs;
+
+	double seconds = elapsed / 1e9;
+	printf("{\"function\":\"%s\",\"shape\":\"%s\",\"docs\":%llu,\"bytesPerDoc\":%llu,\"nsPerDoc\":%.1f,"
+		"\"docsPerSec\":%.0f,\"mbPerSec\":%.2f,\"allocsPerDoc\":%.2f,\"simd\":\"%s\"}\n",
+		function, shape, static_cast<unsigned long long>(docs), static_cast<unsigned long long>(bytesPerDoc),
+		static_cast<double>(elapsed) / docs, docs / seconds, bytesPerDoc * docs / seconds / 1e6,
+		static_cast<double>(allocs) / docs, simd);
+	fflush(stdout);
+}
+
+struct ToJSON {
+	SPL::Tuple const& tuple;
+	ToJSON(SPL::Tuple const& tuple) : tuple(tuple) {}
+	size_t operator()() const { return tupleToJSON(tuple).size(); }
+};
+
+template<typename Map>
+struct MapToJSON {
+	Map const& map;
+	MapToJSON(Map const& map) : map(map) {}
+	size_t operator()() const { return mapToJSON(map).size(); }
+};
+
+template<typename T>
+struct Extract {
+	SPL::rstring const& json;
+	mutable T tuple;
+	Extract(SPL::rstring const& json) : json(json) {}
+	size_t operator()() const { extractFromJSON(json, tuple); return tuple.getNumberOfAttributes(); }
+};
+
+struct Parse {
+	SPL::rstring const& json;
+	SPL::uint64 context;
+	Parse(SPL::rstring const& json, SPL::uint64 context) : json(json), context(context) {}
+	size_t operator()() const { return parseJSON(json, context); }
+};
+
+/* queries on a parsed document, the document is parsed once */
+template<typename T>
+struct Query {
+	SPL::rstring path;
+	SPL::uint64 context;
+	Query(SPL::rstring const& path, SPL::uint64 context) : path(path), context(context) {}
+	size_t operator()() const { return sizeOf(queryJSON(path, T(), context)); }
+
+	static size_t sizeOf(SPL::rstring const& value) { return value.size(); }
+	template<typename V> static size_t sizeOf(V const& value) { return static_cast<size_t>(value); }
+};
+
+/* all functions on one shape */
+template<typename T, typename Q>
+static void runShape(const char * shape, T const& tuple, SPL::rstring const& queryPath, Q const&) {
+	SPL::rstring json = tupleToJSON(tuple);
+	SPL::uint64 context = createJSONContext();
+
+	run("tupleToJSON", shape, json.size(), ToJSON(tuple));
+	run("extractFromJSON", shape, json.size(), Extract<T>(json));
+	run("parseJSON", shape, json.size(), Parse(json, context));
+
+	if(parseJSON(json, context) != 0) {
+		fprintf(stderr, "parse error in shape %s\n", shape);
+		exit(1);
+	}
+	run("queryJSON", shape, 0, Query<Q>(queryPath, context));
+
+	releaseJSONContext(context);
+}
+
+static void usage(const char * program) {
+	fprintf(stderr, "Usage: %s [-t seconds] [-f function|shape] [-s scalar|sse2|sse4.2|avx2]\n", program);
+	exit(2);
+}
+
+/* selects the rapidjson kernels by name, lowered to the best level of the CPU */
+static bool selectSimd(const char * name) {
+#ifdef RAPIDJSON_SIMD_DISPATCH
+	for(int level = rapidjson::internal::kSimdScalar; level <= rapidjson::internal::kSimdAVX2; level++) {
+		rapidjson::internal::SimdLevel l = static_cast<rapidjson::internal::SimdLevel>(level);
+		if(strcmp(name, rapidjson::internal::GetSimdLevelName(l)) == 0) {
+			simd = rapidjson::internal::GetSimdLevelName(rapidjson::internal::SetSimdLevel(l));
+			return true;
+		}
+	}
+#endif
+	return false;
+}
+
+int main(int argc, char ** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+			minSeconds = atof(argv[++i]);
+		else if(strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+			filter = argv[++i];
+		else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc && selectSimd(argv[i + 1]))
+			i++;
+		else
+			usage(argv[0]);
+	}
+#ifdef RAPIDJSON_SIMD_DISPATCH
+	simd = rapidjson::internal::GetSimdLevelName(rapidjson::internal::GetSimdLevel());
+#endif
+
+	FlatTuple flat; flat.fill();
+	runShape("flat", flat, "/s15", SPL::rstring());
+
+	DeepShape deep; deep.fill();
+	runShape("deep", deep, "/child/child/child/child/child/child/child/child/child/child/child/child/values/3", SPL::int32());
+
+	StringArrayTuple strings; strings.fill();
+	runShape("stringArray", strings, "/strings/499", SPL::rstring());
+
+	NumericArrayTuple numbers; numbers.fill();
+	runShape("numericArray", numbers, "/floats/499", SPL::float64());
+
+	OptionalTuple optionals; optionals.fill();
+	runShape("optional", optionals, "/oi6", SPL::int32());
+
+	UStringTuple ustrings; ustrings.fill();
+	runShape("ustring", ustrings, "/u15", SPL::rstring());
+
+	SPL::map<SPL::rstring, SPL::float64> map;
+	for(int i = 0; i < 256; i++)
+		map[text(12, i)] = i * 0.25;
+	run("mapToJSON", "map", mapToJSON(map).size(), MapToJSON<SPL::map<SPL::rstring, SPL::float64> >(map));
+
+	return 0;
+}
@@ -0,0 +1,37 @@
+/*
+ * Metric.h
+ *
+ * Shim of the SPL runtime metric, the value is kept in the object.
+ */
+
+#ifndef SPL_SHIM_METRIC_H_
+#define SPL_SHIM_METRIC_H_
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+namespace SPL {
+
+	class Metric {
+	public:
+		enum Kind { Gauge, Counter, Time };
+
+		Metric(std::string const& name = "", Kind kind = Counter) : name_(name), kind_(kind), value_(0) {}
+
+		std::string const& getName() const { return name_; }
+		Kind getKind() const { return kind_; }
+
+		void incrementValue(int64 v = 1) { value_ += v; }
+		void incrementValueNoLock(int64 v = 1) { value_ += v; }
+		void setValue(int64 v) { value_ = v; }
+		void setValueNoLock(int64 v) { value_ = v; }
+		int64 getValue() const { return value_; }
+		int64 getValueNoLock() const { return value_; }
+
+	private:
+		std::string name_;
+		Kind kind_;
+		int64 value_;
+	};
+}
+
+#endif /* SPL_SHIM_METRIC_H_ */
@@ -0,0 +1,43 @@
+/*
+ * SPLCast.h
+ *
+ * Shim of the SPL cast functions used by the toolkit headers.
+ */
+
+#ifndef SPL_SHIM_SPL_CAST_H_
+#define SPL_SHIM_SPL_CAST_H_
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+namespace SPL {
+
+	namespace shim {
+
+		template<typename T> inline void convert(rstring const& s, T & t) {
+			std::istringstream is(s);
+			is >> t;
+		}
+		inline void convert(rstring const& s, rstring & t) { t = s; }
+		inline void convert(rstring const& s, ustring & t) { t = ustring(s.data(), s.size()); }
+		inline void convert(ustring const& s, rstring & t) { t = s.utf8(); }
+		template<typename S> inline void convert(S const& s, rstring & t) {
+			std::ostringstream os;
+			os << s;
+			t = os.str();
+		}
+		inline void convert(int8 const& s, rstring & t) { convert(static_cast<int32>(s), t); }
+		inline void convert(uint8 const& s, rstring & t) { convert(static_cast<uint32>(s), t); }
+		template<int Tag> inline void convert(decimal<Tag> const& s, float64 & t) { t = s.get(); }
+	}
+
+	template<typename T, typename S>
+	struct spl_cast {
+		static T cast(S const& s) {
+			T t;
+			shim::convert(s, t);
+			return t;
+		}
+	};
+}
+
+#endif /* SPL_SHIM_SPL_CAST_H_ */
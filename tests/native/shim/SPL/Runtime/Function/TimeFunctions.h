@@ -0,0 +1,24 @@
+/*
+ * TimeFunctions.h
+ *
+ * Shim of the SPL time functions used by the toolkit headers.
+ */
+
+#ifndef SPL_SHIM_TIME_FUNCTIONS_H_
+#define SPL_SHIM_TIME_FUNCTIONS_H_
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+namespace SPL { namespace Functions { namespace Time {
+
+	inline rstring ctime(timestamp const& ts) {
+		time_t secs = static_cast<time_t>(ts.getSeconds());
+		char buf[32];
+		struct tm t;
+		::localtime_r(&secs, &t);
+		::strftime(buf, sizeof(buf), "%a %b %e %H:%M:%S %Y", &t);
+		return rstring(buf);
+	}
+}}}
+
+#endif /* SPL_SHIM_TIME_FUNCTIONS_H_ */
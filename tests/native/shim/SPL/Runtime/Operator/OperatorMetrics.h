@@ -0,0 +1,39 @@
+/*
+ * OperatorMetrics.h
+ *
+ * Shim of the SPL runtime operator metrics. Unlike the runtime, a custom
+ * metric that is not declared is created on its first lookup, as the shim
+ * has no operator model.
+ */
+
+#ifndef SPL_SHIM_OPERATOR_METRICS_H_
+#define SPL_SHIM_OPERATOR_METRICS_H_
+
+#include <SPL/Runtime/Common/Metric.h>
+
+namespace SPL {
+
+	class OperatorMetrics {
+	public:
+		Metric & getCustomMetricByName(std::string const& name) {
+			std::map<std::string, Metric>::iterator it = metrics_.find(name);
+			if(it == metrics_.end())
+				it = metrics_.insert(std::make_pair(name, Metric(name))).first;
+			return it->second;
+		}
+
+		Metric & createCustomMetric(std::string const& name, std::string const& description, Metric::Kind kind) {
+			(void)description;
+			return metrics_[name] = Metric(name, kind);
+		}
+
+		bool hasCustomMetric(std::string const& name) const { return metrics_.count(name) != 0; }
+
+		std::map<std::string, Metric> const& getCustomMetrics() const { return metrics_; }
+
+	private:
+		std::map<std::string, Metric> metrics_;
+	};
+}
+
+#endif /* SPL_SHIM_OPERATOR_METRICS_H_ */
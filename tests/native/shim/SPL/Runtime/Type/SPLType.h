@@ -0,0 +1,671 @@
+/*
+ * SPLType.h
+ *
+ * Minimal stand-in for the parts of the IBM Streams SPL runtime type system
+ * that are used by JsonReader.h and JsonWriter.h. It allows the toolkit
+ * headers to be compiled, unit tested and profiled on a plain Linux box
+ * without a Streams installation.
+ *
+ * Only the reflective value API (ValueHandle, Tuple, List, Set, Map,
+ * Optional, meta types) and the concrete types needed by the tests are
+ * provided. Bounded collections are declared but have no concrete type.
+ */
+
+#ifndef SPL_SHIM_SPL_TYPE_H_
+#define SPL_SHIM_SPL_TYPE_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <complex>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/type_traits/is_base_of.hpp>
+#include <boost/utility/enable_if.hpp>
+
+/*
+ * Tracing
+ *
+ * SPLAPPTRC evaluates its message only if the level is enabled, the active
+ * level is taken from the environment variable SPL_SHIM_TRACE (0 - off,
+ * 1 - error, 2 - warn, 3 - info, 4 - debug, 5 - trace).
+ */
+#define L_ERROR 1
+#define L_WARN  2
+#define L_INFO  3
+#define L_DEBUG 4
+#define L_TRACE 5
+
+namespace SPL { namespace shim {
+
+	inline int & traceLevel() {
+		static int level = getenv("SPL_SHIM_TRACE") ? atoi(getenv("SPL_SHIM_TRACE")) : 0;
+		return level;
+	}
+}}
+
+#define SPLAPPTRC(level, msg, aspect) \
+	do { \
+		if(SPL::shim::traceLevel() >= (level)) { \
+			std::ostringstream splShimTrc_; \
+			splShimTrc_ << msg; \
+			std::cerr << #level << " [" << aspect << "] " << splShimTrc_.str() << std::endl; \
+		} \
+	} while(0)
+
+#define SPLAPPLOG(level, msg, aspect) SPLAPPTRC(level, msg, aspect)
+
+#define THROW(type, msg) \
+	do { \
+		std::ostringstream splShimThrow_; \
+		splShimThrow_ << msg; \
+		throw type##Exception(__FUNCTION__, splShimThrow_.str()); \
+	} while(0)
+
+
+namespace SPL {
+
+	class SPLRuntimeException : public std::runtime_error {
+	public:
+		SPLRuntimeException(std::string const& location, std::string const& msg) : std::runtime_error(msg), location_(location) {}
+		virtual ~SPLRuntimeException() throw() {}
+		std::string const& getLocation() const { return location_; }
+		std::string getExplanation() const { return what(); }
+	private:
+		std::string location_;
+	};
+
+	class SPLRuntimeOperatorException : public SPLRuntimeException {
+	public:
+		SPLRuntimeOperatorException(std::string const& location, std::string const& msg) : SPLRuntimeException(location, msg) {}
+		virtual ~SPLRuntimeOperatorException() throw() {}
+	};
+
+	class SPLRuntimeInvalidArgumentException : public SPLRuntimeException {
+	public:
+		SPLRuntimeInvalidArgumentException(std::string const& location, std::string const& msg) : SPLRuntimeException(location, msg) {}
+		virtual ~SPLRuntimeInvalidArgumentException() throw() {}
+	};
+
+
+	/* primitive types */
+	typedef bool boolean;
+	typedef int8_t int8;
+	typedef int16_t int16;
+	typedef int32_t int32;
+	typedef int64_t int64;
+	typedef uint8_t uint8;
+	typedef uint16_t uint16;
+	typedef uint32_t uint32;
+	typedef uint64_t uint64;
+	typedef float float32;
+	typedef double float64;
+	typedef std::complex<float> complex32;
+	typedef std::complex<double> complex64;
+
+
+	namespace Meta {
+
+		class Type {
+		public:
+			enum value {
+				INVALID, BOOLEAN, ENUM,
+				INT8, INT16, INT32, INT64, UINT8, UINT16, UINT32, UINT64,
+				FLOAT32, FLOAT64, DECIMAL32, DECIMAL64, DECIMAL128,
+				COMPLEX32, COMPLEX64, TIMESTAMP,
+				RSTRING, BSTRING, USTRING, BLOB, XML,
+				LIST, BLIST, SET, BSET, MAP, BMAP, TUPLE, OPTIONAL
+			};
+
+			Type() : value_(INVALID) {}
+			Type(value v) : value_(v) {}
+			operator value() const { return value_; }
+
+		private:
+			value value_;
+		};
+	}
+
+
+	/* strings */
+	class RString : public std::string {
+	public:
+		RString() {}
+		RString(const char * s) : std::string(s) {}
+		RString(const char * s, size_t n) : std::string(s, n) {}
+		RString(std::string const& s) : std::string(s) {}
+		template<typename It> RString(It b, It e) : std::string(b, e) {}
+
+		RString & operator=(const char * s) { std::string::operator=(s); return *this; }
+		RString & operator=(std::string const& s) { std::string::operator=(s); return *this; }
+	};
+	typedef RString rstring;
+
+	/* ustring keeps its content UTF-8 encoded in the shim */
+	class ustring {
+	public:
+		ustring() {}
+		ustring(const char * s) : data_(s) {}
+		ustring(const char * s, size_t n) : data_(s, n) {}
+		explicit ustring(std::string const& s) : data_(s) {}
+
+		ustring & operator=(const char * s) { data_ = s; return *this; }
+
+		std::string const& utf8() const { return data_; }
+		size_t length() const { return data_.length(); }
+		bool operator==(ustring const& o) const { return data_ == o.data_; }
+		bool operator!=(ustring const& o) const { return data_ != o.data_; }
+		bool operator<(ustring const& o) const { return data_ < o.data_; }
+
+	private:
+		std::string data_;
+	};
+	inline std::ostream & operator<<(std::ostream & os, ustring const& s) { return os << s.utf8(); }
+
+	class BString {
+	public:
+		virtual ~BString() {}
+		virtual size_t getBoundedSize() const = 0;
+		virtual const char * getCString() const = 0;
+		virtual size_t getUsedSize() const = 0;
+		virtual void assign(const char * s, size_t n) = 0;
+
+		BString & operator=(std::string const& s) { assign(s.data(), s.size()); return *this; }
+	};
+
+	template<size_t N>
+	class bstring : public BString {
+	public:
+		bstring() : size_(0) { data_[0] = 0; }
+		bstring(const char * s, size_t n) { assign(s, n); }
+		bstring(std::string const& s) { assign(s.data(), s.size()); }
+		bstring(bstring const& o) : BString() { assign(o.data_, o.size_); }
+
+		bstring & operator=(bstring const& o) { assign(o.data_, o.size_); return *this; }
+		bstring & operator=(std::string const& s) { assign(s.data(), s.size()); return *this; }
+
+		size_t getBoundedSize() const { return N; }
+		const char * getCString() const { return data_; }
+		size_t getUsedSize() const { return size_; }
+		void assign(const char * s, size_t n) {
+			size_ = n < N ? n : N;
+			memcpy(data_, s, size_);
+			data_[size_] = 0;
+		}
+
+		bool operator==(bstring const& o) const { return size_ == o.size_ && memcmp(data_, o.data_, size_) == 0; }
+		bool operator<(bstring const& o) const { return strcmp(data_, o.data_) < 0; }
+
+	private:
+		char data_[N + 1];
+		size_t size_;
+	};
+
+
+	/* decimals are approximated by a double in the shim */
+	template<int Tag>
+	class decimal {
+	public:
+		decimal() : v_(0) {}
+		decimal(double v) : v_(v) {}
+		double get() const { return v_; }
+		bool operator==(decimal const& o) const { return v_ == o.v_; }
+	private:
+		double v_;
+	};
+	template<int Tag> inline std::ostream & operator<<(std::ostream & os, decimal<Tag> const& d) { return os << d.get(); }
+	template<int Tag> inline std::istream & operator>>(std::istream & is, decimal<Tag> & d) { double v; if(is >> v) d = decimal<Tag>(v); return is; }
+	typedef decimal<32> decimal32;
+	typedef decimal<64> decimal64;
+	typedef decimal<128> decimal128;
+
+
+	class timestamp {
+	public:
+		timestamp() : secs_(0), nanos_(0) {}
+		timestamp(int64 secs, uint32 nanos) : secs_(secs), nanos_(nanos) {}
+		int64 getSeconds() const { return secs_; }
+		uint32 getNanoseconds() const { return nanos_; }
+		bool operator==(timestamp const& o) const { return secs_ == o.secs_ && nanos_ == o.nanos_; }
+	private:
+		int64 secs_;
+		uint32 nanos_;
+	};
+
+	class blob : public std::vector<unsigned char> {};
+
+	class xml : public rstring {};
+
+
+	class Enum {
+	public:
+		virtual ~Enum() {}
+		virtual rstring const& getValue() const = 0;
+	};
+
+
+	class Tuple;
+	class List;
+	class BList;
+	class Set;
+	class BSet;
+	class Map;
+	class BMap;
+	class Optional;
+	template<typename T> class list;
+	template<typename T> class set;
+	template<typename K, typename V> class map;
+	template<typename T> class optional;
+
+
+	/* meta type of a C++ value, resolved by overloading on the value pointer */
+	inline Meta::Type metaTypeOf(const boolean *) { return Meta::Type::BOOLEAN; }
+	inline Meta::Type metaTypeOf(const int8 *) { return Meta::Type::INT8; }
+	inline Meta::Type metaTypeOf(const int16 *) { return Meta::Type::INT16; }
+	inline Meta::Type metaTypeOf(const int32 *) { return Meta::Type::INT32; }
+	inline Meta::Type metaTypeOf(const int64 *) { return Meta::Type::INT64; }
+	inline Meta::Type metaTypeOf(const uint8 *) { return Meta::Type::UINT8; }
+	inline Meta::Type metaTypeOf(const uint16 *) { return Meta::Type::UINT16; }
+	inline Meta::Type metaTypeOf(const uint32 *) { return Meta::Type::UINT32; }
+	inline Meta::Type metaTypeOf(const uint64 *) { return Meta::Type::UINT64; }
+	inline Meta::Type metaTypeOf(const float32 *) { return Meta::Type::FLOAT32; }
+	inline Meta::Type metaTypeOf(const float64 *) { return Meta::Type::FLOAT64; }
+	inline Meta::Type metaTypeOf(const decimal32 *) { return Meta::Type::DECIMAL32; }
+	inline Meta::Type metaTypeOf(const decimal64 *) { return Meta::Type::DECIMAL64; }
+	inline Meta::Type metaTypeOf(const decimal128 *) { return Meta::Type::DECIMAL128; }
+	inline Meta::Type metaTypeOf(const complex32 *) { return Meta::Type::COMPLEX32; }
+	inline Meta::Type metaTypeOf(const complex64 *) { return Meta::Type::COMPLEX64; }
+	inline Meta::Type metaTypeOf(const timestamp *) { return Meta::Type::TIMESTAMP; }
+	inline Meta::Type metaTypeOf(const rstring *) { return Meta::Type::RSTRING; }
+	inline Meta::Type metaTypeOf(const ustring *) { return Meta::Type::USTRING; }
+	inline Meta::Type metaTypeOf(const BString *) { return Meta::Type::BSTRING; }
+	inline Meta::Type metaTypeOf(const blob *) { return Meta::Type::BLOB; }
+	inline Meta::Type metaTypeOf(const xml *) { return Meta::Type::XML; }
+	inline Meta::Type metaTypeOf(const Enum *) { return Meta::Type::ENUM; }
+	inline Meta::Type metaTypeOf(const Tuple *) { return Meta::Type::TUPLE; }
+	template<typename T> inline Meta::Type metaTypeOf(const list<T> *) { return Meta::Type::LIST; }
+	template<typename T> inline Meta::Type metaTypeOf(const set<T> *) { return Meta::Type::SET; }
+	template<typename K, typename V> inline Meta::Type metaTypeOf(const map<K,V> *) { return Meta::Type::MAP; }
+	template<typename T> inline Meta::Type metaTypeOf(const optional<T> *) { return Meta::Type::OPTIONAL; }
+
+	/* address of the reflective interface of a value (or the value itself for primitives) */
+	inline const void * reflectiveBase(const void * p) { return p; }
+	inline const void * reflectiveBase(const Tuple * p) { return p; }
+	inline const void * reflectiveBase(const BString * p) { return p; }
+	inline const void * reflectiveBase(const Enum * p) { return p; }
+	template<typename T> inline const void * reflectiveBase(const list<T> * p) { return static_cast<const List*>(p); }
+	template<typename T> inline const void * reflectiveBase(const set<T> * p) { return static_cast<const Set*>(p); }
+	template<typename K, typename V> inline const void * reflectiveBase(const map<K,V> * p) { return static_cast<const Map*>(p); }
+	template<typename T> inline const void * reflectiveBase(const optional<T> * p) { return static_cast<const Optional*>(p); }
+
+	namespace shim {
+
+		/* reflective interfaces are reached through the base pointer, all other types through the value pointer */
+		template<typename T> struct UsesBase { enum { value = 0 }; };
+		template<> struct UsesBase<Tuple> { enum { value = 1 }; };
+		template<> struct UsesBase<BString> { enum { value = 1 }; };
+		template<> struct UsesBase<Enum> { enum { value = 1 }; };
+		template<> struct UsesBase<List> { enum { value = 1 }; };
+		template<> struct UsesBase<BList> { enum { value = 1 }; };
+		template<> struct UsesBase<Set> { enum { value = 1 }; };
+		template<> struct UsesBase<BSet> { enum { value = 1 }; };
+		template<> struct UsesBase<Map> { enum { value = 1 }; };
+		template<> struct UsesBase<BMap> { enum { value = 1 }; };
+		template<> struct UsesBase<Optional> { enum { value = 1 }; };
+
+		template<typename T>
+		inline void deleteAs(void * p) { delete static_cast<T*>(p); }
+	}
+
+
+	class ConstValueHandle {
+	public:
+		ConstValueHandle() : value_(0), base_(0), type_(Meta::Type::INVALID), deleter_(0) {}
+
+		template<typename T>
+		ConstValueHandle(T const& v, typename boost::disable_if<boost::is_base_of<ConstValueHandle, T> >::type * = 0)
+			: value_(&v), base_(reflectiveBase(&v)), type_(metaTypeOf(&v)), deleter_(&shim::deleteAs<T>) {}
+
+		Meta::Type getMetaType() const { return type_; }
+
+		template<typename T>
+		operator T const&() const { return *static_cast<const T*>(shim::UsesBase<T>::value ? base_ : value_); }
+
+	protected:
+		const void * value_;
+		const void * base_;
+		Meta::Type type_;
+		void (*deleter_)(void *);
+	};
+
+	class ValueHandle : public ConstValueHandle {
+	public:
+		ValueHandle() {}
+		ValueHandle(ValueHandle const& o) : ConstValueHandle(static_cast<ConstValueHandle const&>(o)) {}
+
+		template<typename T>
+		ValueHandle(T & v, typename boost::disable_if<boost::is_base_of<ConstValueHandle, T> >::type * = 0)
+			: ConstValueHandle(static_cast<T const&>(v)) {}
+
+		template<typename T>
+		operator T&() const { return *static_cast<T*>(const_cast<void*>(shim::UsesBase<T>::value ? base_ : value_)); }
+
+		void deleteValue() {
+			if(deleter_) deleter_(const_cast<void*>(value_));
+			value_ = base_ = 0;
+		}
+	};
+
+
+	/* type-erased iteration over sets and maps */
+	namespace shim {
+
+		template<typename Deref>
+		class IteratorImpl {
+		public:
+			virtual ~IteratorImpl() {}
+			virtual IteratorImpl * clone() const = 0;
+			virtual void next() = 0;
+			virtual bool equals(IteratorImpl const& o) const = 0;
+			virtual Deref deref() const = 0;
+		};
+
+		template<typename Deref>
+		class Iterator {
+		public:
+			Iterator() : impl_(0) {}
+			explicit Iterator(IteratorImpl<Deref> * impl) : impl_(impl) {}
+			Iterator(Iterator const& o) : impl_(o.impl_ ? o.impl_->clone() : 0) {}
+			~Iterator() { delete impl_; }
+
+			Iterator & operator=(Iterator const& o) {
+				if(this != &o) { delete impl_; impl_ = o.impl_ ? o.impl_->clone() : 0; }
+				return *this;
+			}
+			Iterator & operator++() { impl_->next(); return *this; }
+			Iterator operator++(int) { Iterator tmp(*this); impl_->next(); return tmp; }
+			bool operator==(Iterator const& o) const { return impl_->equals(*o.impl_); }
+			bool operator!=(Iterator const& o) const { return !impl_->equals(*o.impl_); }
+			Deref operator*() const { return impl_->deref(); }
+
+		private:
+			IteratorImpl<Deref> * impl_;
+		};
+
+		template<typename Deref, typename StdIter>
+		class StdIteratorImpl : public IteratorImpl<Deref> {
+		public:
+			explicit StdIteratorImpl(StdIter it) : it_(it) {}
+			IteratorImpl<Deref> * clone() const { return new StdIteratorImpl(it_); }
+			void next() { ++it_; }
+			bool equals(IteratorImpl<Deref> const& o) const { return it_ == static_cast<StdIteratorImpl const&>(o).it_; }
+			Deref deref() const { return derefValue(*it_); }
+
+		private:
+			template<typename V> static Deref derefValue(V const& v) { return Deref(v); }
+			template<typename K, typename V> static Deref derefValue(std::pair<const K, V> const& v) { return Deref(ConstValueHandle(v.first), ConstValueHandle(v.second)); }
+
+			StdIter it_;
+		};
+	}
+
+	typedef shim::Iterator<ConstValueHandle> ConstListIterator;
+	typedef shim::Iterator<ConstValueHandle> ConstSetIterator;
+	typedef shim::Iterator<std::pair<ConstValueHandle,ConstValueHandle> > ConstMapIterator;
+
+
+	/* reflective collection interfaces */
+	class List {
+	public:
+		virtual ~List() {}
+		virtual Meta::Type getElementMetaType() const = 0;
+		virtual ValueHandle createElement() const = 0;
+		virtual void pushBack(ConstValueHandle const& v) = 0;
+		virtual void removeAllElements() = 0;
+		virtual ValueHandle getElement(size_t i) = 0;
+		virtual size_t getSize() const = 0;
+		virtual ConstListIterator getBeginIterator() const = 0;
+		virtual ConstListIterator getEndIterator() const = 0;
+	};
+
+	class BList : public List {};
+
+	class Set {
+	public:
+		virtual ~Set() {}
+		virtual Meta::Type getElementMetaType() const = 0;
+		virtual ValueHandle createElement() const = 0;
+		virtual void insertElement(ConstValueHandle const& v) = 0;
+		virtual void removeAllElements() = 0;
+		virtual size_t getSize() const = 0;
+		virtual ConstSetIterator getBeginIterator() const = 0;
+		virtual ConstSetIterator getEndIterator() const = 0;
+	};
+
+	class BSet : public Set {};
+
+	class MapIterator {
+	public:
+		MapIterator(ValueHandle const& key, ValueHandle const& value) : pair_(key, value) {}
+		std::pair<ValueHandle,ValueHandle> const& operator*() const { return pair_; }
+	private:
+		std::pair<ValueHandle,ValueHandle> pair_;
+	};
+
+	class Map {
+	public:
+		virtual ~Map() {}
+		virtual Meta::Type getKeyMetaType() const = 0;
+		virtual Meta::Type getValueMetaType() const = 0;
+		virtual ValueHandle createValue() const = 0;
+		virtual void insertElement(ConstValueHandle const& key, ConstValueHandle const& value) = 0;
+		virtual void removeAllElements() = 0;
+		virtual MapIterator findElement(ConstValueHandle const& key) = 0;
+		virtual size_t getSize() const = 0;
+		virtual ConstMapIterator getBeginIterator() const = 0;
+		virtual ConstMapIterator getEndIterator() const = 0;
+	};
+
+	class BMap : public Map {};
+
+	class Optional {
+	public:
+		virtual ~Optional() {}
+		virtual Meta::Type getValueMetaType() const = 0;
+		virtual bool isPresent() const = 0;
+		virtual ValueHandle getValue() = 0;
+		virtual ConstValueHandle getValue() const = 0;
+		virtual void setValue(ConstValueHandle const& v) = 0;
+		virtual void clear() = 0;
+		virtual ValueHandle createValue() const = 0;
+	};
+
+
+	/* concrete collections */
+	template<typename T>
+	class list : public std::vector<T>, public List {
+	public:
+		list() {}
+		list(size_t n, T const& v) : std::vector<T>(n, v) {}
+		template<typename It> list(It b, It e) : std::vector<T>(b, e) {}
+
+		Meta::Type getElementMetaType() const { return metaTypeOf(static_cast<const T*>(0)); }
+		ValueHandle createElement() const { return ValueHandle(*new T()); }
+		void pushBack(ConstValueHandle const& v) { this->push_back(static_cast<T const&>(v)); }
+		void removeAllElements() { this->clear(); }
+		ValueHandle getElement(size_t i) { return ValueHandle((*this)[i]); }
+		size_t getSize() const { return this->size(); }
+		ConstListIterator getBeginIterator() const { return ConstListIterator(new shim::StdIteratorImpl<ConstValueHandle, typename std::vector<T>::const_iterator>(this->begin())); }
+		ConstListIterator getEndIterator() const { return ConstListIterator(new shim::StdIteratorImpl<ConstValueHandle, typename std::vector<T>::const_iterator>(this->end())); }
+	};
+
+	template<typename T>
+	class set : public std::set<T>, public Set {
+	public:
+		Meta::Type getElementMetaType() const { return metaTypeOf(static_cast<const T*>(0)); }
+		ValueHandle createElement() const { return ValueHandle(*new T()); }
+		void insertElement(ConstValueHandle const& v) { this->insert(static_cast<T const&>(v)); }
+		void removeAllElements() { this->clear(); }
+		size_t getSize() const { return this->size(); }
+		ConstSetIterator getBeginIterator() const { return ConstSetIterator(new shim::StdIteratorImpl<ConstValueHandle, typename std::set<T>::const_iterator>(this->begin())); }
+		ConstSetIterator getEndIterator() const { return ConstSetIterator(new shim::StdIteratorImpl<ConstValueHandle, typename std::set<T>::const_iterator>(this->end())); }
+	};
+
+	template<typename K, typename V>
+	class map : public std::map<K,V>, public Map {
+	public:
+		typedef std::map<K,V> Base;
+
+		Meta::Type getKeyMetaType() const { return metaTypeOf(static_cast<const K*>(0)); }
+		Meta::Type getValueMetaType() const { return metaTypeOf(static_cast<const V*>(0)); }
+		ValueHandle createValue() const { return ValueHandle(*new V()); }
+		void insertElement(ConstValueHandle const& key, ConstValueHandle const& value) {
+			this->insert(std::make_pair(static_cast<K const&>(key), static_cast<V const&>(value)));
+		}
+		void removeAllElements() { this->clear(); }
+		MapIterator findElement(ConstValueHandle const& key) {
+			typename Base::iterator it = this->find(static_cast<K const&>(key));
+			return MapIterator(ValueHandle(const_cast<K&>(it->first)), ValueHandle(it->second));
+		}
+		size_t getSize() const { return this->size(); }
+		ConstMapIterator getBeginIterator() const { return ConstMapIterator(new shim::StdIteratorImpl<std::pair<ConstValueHandle,ConstValueHandle>, typename Base::const_iterator>(this->begin())); }
+		ConstMapIterator getEndIterator() const { return ConstMapIterator(new shim::StdIteratorImpl<std::pair<ConstValueHandle,ConstValueHandle>, typename Base::const_iterator>(this->end())); }
+	};
+
+	template<typename T>
+	class optional : public Optional {
+	public:
+		optional() : present_(false), value_() {}
+		optional(T const& v) : present_(true), value_(v) {}
+		optional(optional const& o) : Optional(), present_(o.present_), value_(o.value_) {}
+
+		optional & operator=(optional const& o) { present_ = o.present_; value_ = o.value_; return *this; }
+		optional & operator=(T const& v) { present_ = true; value_ = v; return *this; }
+
+		T const& value() const { return value_; }
+		T & value() { return value_; }
+
+		bool operator==(optional const& o) const { return present_ == o.present_ && (!present_ || value_ == o.value_); }
+		bool operator!=(optional const& o) const { return !(*this == o); }
+
+		Meta::Type getValueMetaType() const { return metaTypeOf(static_cast<const T*>(0)); }
+		bool isPresent() const { return present_; }
+		ValueHandle getValue() { return ValueHandle(value_); }
+		ConstValueHandle getValue() const { return ConstValueHandle(value_); }
+		void setValue(ConstValueHandle const& v) { value_ = static_cast<T const&>(v); present_ = true; }
+		void clear() { present_ = false; value_ = T(); }
+		ValueHandle createValue() const { return ValueHandle(*new T()); }
+
+	private:
+		bool present_;
+		T value_;
+	};
+
+
+	/* reflective tuple
+	 *
+	 * Concrete tuple types derive from Tuple and register their members
+	 * in the constructor (and copy constructor) with addAttribute().
+	 */
+	/* like in the runtime, the name of an attribute refers to the tuple, not to the attribute object */
+	class TupleAttribute {
+	public:
+		TupleAttribute(std::string const& name, ValueHandle const& value) : name_(&name), value_(value) {}
+		std::string const& getName() const { return *name_; }
+		ValueHandle getValue() const { return value_; }
+	private:
+		const std::string * name_;
+		ValueHandle value_;
+	};
+
+	class ConstTupleAttribute {
+	public:
+		ConstTupleAttribute(std::string const& name, ConstValueHandle const& value) : name_(&name), value_(value) {}
+		ConstTupleAttribute(TupleAttribute const& attr) : name_(&attr.getName()), value_(attr.getValue()) {}
+		std::string const& getName() const { return *name_; }
+		ConstValueHandle getValue() const { return value_; }
+	private:
+		const std::string * name_;
+		ConstValueHandle value_;
+	};
+
+	class Tuple;
+
+	template<typename Attribute>
+	class TupleIteratorT {
+	public:
+		TupleIteratorT() : tuple_(0), index_(0) {}
+		TupleIteratorT(const Tuple * tuple, size_t index) : tuple_(tuple), index_(index) {}
+
+		TupleIteratorT & operator++() { ++index_; return *this; }
+		TupleIteratorT operator++(int) { TupleIteratorT tmp(*this); ++index_; return tmp; }
+		bool operator==(TupleIteratorT const& o) const { return tuple_ == o.tuple_ && index_ == o.index_; }
+		bool operator!=(TupleIteratorT const& o) const { return !(*this == o); }
+		Attribute operator*() const;
+		size_t index() const { return index_; }
+
+	private:
+		const Tuple * tuple_;
+		size_t index_;
+	};
+
+	typedef TupleIteratorT<TupleAttribute> TupleIterator;
+	typedef TupleIteratorT<ConstTupleAttribute> ConstTupleIterator;
+
+	class Tuple {
+	public:
+		virtual ~Tuple() {}
+
+		size_t getNumberOfAttributes() const { return names_.size(); }
+		TupleIterator getBeginIterator() { return TupleIterator(this, 0); }
+		TupleIterator getEndIterator() { return TupleIterator(this, names_.size()); }
+		ConstTupleIterator getBeginIterator() const { return ConstTupleIterator(this, 0); }
+		ConstTupleIterator getEndIterator() const { return ConstTupleIterator(this, names_.size()); }
+
+		TupleIterator findAttribute(std::string const& name) {
+			for(size_t i = 0; i < names_.size(); i++)
+				if(names_[i] == name) return TupleIterator(this, i);
+			return getEndIterator();
+		}
+
+		std::string const& getAttributeName(size_t i) const { return names_[i]; }
+		ValueHandle getAttributeValue(size_t i) const { return values_[i]; }
+
+	protected:
+		Tuple() {}
+		Tuple(Tuple const&) {}
+		Tuple & operator=(Tuple const&) { return *this; }
+
+		template<typename T>
+		void addAttribute(const char * name, T & value) {
+			names_.push_back(name);
+			values_.push_back(ValueHandle(value));
+		}
+
+	private:
+		std::vector<std::string> names_;
+		std::vector<ValueHandle> values_;
+	};
+
+	template<>
+	inline TupleAttribute TupleIteratorT<TupleAttribute>::operator*() const {
+		return TupleAttribute(tuple_->getAttributeName(index_), tuple_->getAttributeValue(index_));
+	}
+
+	template<>
+	inline ConstTupleAttribute TupleIteratorT<ConstTupleAttribute>::operator*() const {
+		return ConstTupleAttribute(tuple_->getAttributeName(index_), tuple_->getAttributeValue(index_));
+	}
+}
+
+#endif /* SPL_SHIM_SPL_TYPE_H_ */
@@ -0,0 +1,13 @@
+/*
+ * Tuple.h
+ *
+ * Shim of the SPL runtime tuple header, see SPLType.h.
+ */
+
+#ifndef SPL_SHIM_TUPLE_H_
+#define SPL_SHIM_TUPLE_H_
+
+#include <SPL/Runtime/Type/SPLType.h>
+#include <SPL/Runtime/Function/SPLCast.h>
+
+#endif /* SPL_SHIM_TUPLE_H_ */
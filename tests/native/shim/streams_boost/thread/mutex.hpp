@@ -0,0 +1,13 @@
+/*
+ * Shim mapping the Streams bundled boost (namespace streams_boost)
+ * to the boost installation of the build host.
+ */
+
+#ifndef SPL_SHIM_STREAMS_BOOST_THREAD_MUTEX_HPP_
+#define SPL_SHIM_STREAMS_BOOST_THREAD_MUTEX_HPP_
+
+#include <boost/thread/mutex.hpp>
+
+namespace streams_boost = boost;
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ * Shim mapping the Streams bundled boost (namespace streams_boost)
+ * to the boost installation of the build host.
+ */
+
+#ifndef SPL_SHIM_STREAMS_BOOST_UTILITY_ENABLE_IF_HPP_
+#define SPL_SHIM_STREAMS_BOOST_UTILITY_ENABLE_IF_HPP_
+
+#include <boost/utility/enable_if.hpp>
+
+namespace streams_boost = boost;
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * JsonGenerator.cpp
+ *
+ * Writes the documents of the synthetic JSON workload of the toolkit, one per line,
+ * or their SPL type, to create the data files and stream types of benchmarks and
+ * soak tests. The configuration is that of createJSONGenerator (see JsonGenerator.h),
+ * built with the SPL runtime shim (see ../Makefile).
+ *
+ * Usage: JsonGenerator [-t] [-n documents] [config]
+ *   -t  writes the SPL type instead of documents
+ *   -n  number of documents, default 10
+ * Example: JsonGenerator -n 100000 "width=32,depth=3,keyOrder=random" > data/Workload.json
+ */
+
+#include "Json.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+
+using namespace com::ibm::streamsx::json;
+
+
+int main(int argc, char * argv[]) {
+	bool type = false;
+	SPL::uint64 documents = 10;
+	std::string config;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-t") == 0)
+			type = true;
+		else if(strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			documents = strtoull(argv[++i], NULL, 10);
+		else if(argv[i][0] != '-' && config.empty())
+			config = argv[i];
+		else {
+			std::cerr << "Usage: JsonGenerator [-t] [-n documents] [config]" << std::endl;
+			return 2;
+		}
+	}
+
+	try {
+		WorkloadGenerator generator(WorkloadConfig::parse(config));
+		if(type) {
+			std::cout << generator.getSplType() << std::endl;
+			return 0;
+		}
+
+		for(SPL::uint64 i = 0; i < documents; i++)
+			std::cout << generator.next() << '\n';
+	}
+	catch(SPL::SPLRuntimeException const& e) {
+		std::cerr << e.getExplanation() << std::endl;
+		return 1;
+	}
+	return 0;
+}
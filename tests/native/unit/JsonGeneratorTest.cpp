@@ -0,0 +1,144 @@
+/*
+ * JsonGeneratorTest.cpp
+ *
+ * Unit tests of the synthetic JSON workload of JsonGenerator.h, built with the
+ * SPL runtime shim (see ../Makefile).
+ */
+
+#include "Json.h"
+#include "UnitTest.h"
+
+#include <string>
+
+using namespace com::ibm::streamsx::json;
+
+
+struct Numbers : SPL::Tuple {
+	SPL::list<SPL::int64> f0;
+	SPL::int64 f1;
+	SPL::int64 f2;
+
+	Numbers() : f1(0), f2(0) { addAttribute("f0", f0); addAttribute("f1", f1); addAttribute("f2", f2); }
+};
+
+static bool throws(std::string const& config) {
+	try {
+		WorkloadConfig::parse(config);
+	}
+	catch(SPL::SPLRuntimeException const&) {
+		return true;
+	}
+	return false;
+}
+
+
+TEST(config) {
+	WorkloadConfig config = WorkloadConfig::parse("width=3,depth=2,,numberTypes=int32:uint64,keyOrder=random,stringDistribution=exponential");
+	CHECK(config.width == 3 && config.depth == 2 && config.arrays == 1 && config.seed == 1);
+	CHECK(config.numberTypes.size() == 2 && config.numberTypes[1] == WorkloadConfig::UINT64);
+	CHECK(config.keyOrder == WorkloadConfig::RANDOM_ORDER && config.exponentialStrings);
+
+	CHECK(throws("width"));
+	CHECK(throws("widht=3"));
+	CHECK(throws("width=x"));
+	CHECK(throws("width=0"));
+	CHECK(throws("keyOrder=sorted"));
+	CHECK(throws("numberTypes=int64:int8"));
+	CHECK(throws("minArrayLength=5,maxArrayLength=4"));
+}
+
+TEST(type) {
+	WorkloadGenerator generator(WorkloadConfig::parse("width=3,stringRatio=0,booleanRatio=0,numberTypes=int64"));
+	CHECK(generator.getSplType() == "tuple<list<int64> f0, int64 f1, int64 f2>");
+
+	WorkloadGenerator nested(WorkloadConfig::parse("width=2,depth=3,arrays=0,stringRatio=1"));
+	CHECK(nested.getSplType() == "tuple<tuple<tuple<rstring f0, rstring f1> f0, rstring f1> f0, rstring f1>");
+}
+
+TEST(deterministic) {
+	std::string config = "width=12,depth=3,optionalDensity=0.3,unmatchedKeyRatio=0.5,keyOrder=random,escapeRatio=0.1";
+	WorkloadGenerator first(WorkloadConfig::parse(config));
+	WorkloadGenerator second(WorkloadConfig::parse(config));
+	WorkloadGenerator other(WorkloadConfig::parse(config + ",seed=2"));
+	CHECK(first.getSplType() == second.getSplType());
+
+	bool differs = false;
+	for(int i = 0; i < 100; i++) {
+		std::string document = first.next();
+		CHECK(document == second.next());
+		differs = differs || document != other.next();
+	}
+	CHECK(differs);
+}
+
+TEST(documents) {
+	WorkloadGenerator generator(WorkloadConfig::parse("width=10,depth=2,minArrayLength=2,maxArrayLength=2,unmatchedKeyRatio=0.3,escapeRatio=0.2"));
+	SPL::uint64 ctx = createJSONContext();
+	for(int i = 0; i < 100; i++) {
+		CHECK(parseJSON(SPL::rstring(generator.next()), ctx) == 0);
+		// 3 unmatched keys per object
+		CHECK(memberCountJSON(0, ctx) == 13 && memberCountJSON(cursorJSON(SPL::rstring("/f0"), ctx), ctx) == 13);
+		CHECK(arraySizeJSON(cursorJSON(SPL::rstring("/f1"), ctx), ctx) == 2);
+	}
+	releaseJSONContext(ctx);
+}
+
+TEST(keyOrder) {
+	WorkloadGenerator schema(WorkloadConfig::parse("width=3,arrays=0,booleanRatio=1"));
+	WorkloadGenerator reverse(WorkloadConfig::parse("width=3,arrays=0,booleanRatio=1,keyOrder=reverse"));
+	std::string document = schema.next();
+	CHECK(document.find("\"f0\"") < document.find("\"f1\"") && document.find("\"f1\"") < document.find("\"f2\""));
+	document = reverse.next();
+	CHECK(document.find("\"f2\"") < document.find("\"f1\"") && document.find("\"f1\"") < document.find("\"f0\""));
+}
+
+TEST(extract) {
+	WorkloadGenerator generator(WorkloadConfig::parse("width=3,minArrayLength=1,stringRatio=0,booleanRatio=0,numberTypes=int64,unmatchedKeyRatio=1"));
+	SPL::uint64 ctx = createJSONContext();
+	for(int i = 0; i < 100; i++) {
+		SPL::rstring document = generator.next();
+		Numbers t;
+		extractFromJSON(document, t);
+		CHECK(parseJSON(document, ctx) == 0);
+		CHECK(!t.f0.empty() && t.f0[0] == queryJSON(SPL::rstring("/f0/0"), SPL::int64(0), ctx));
+		CHECK(t.f1 == queryJSON(SPL::rstring("/f1"), SPL::int64(0), ctx) && t.f2 == queryJSON(SPL::rstring("/f2"), SPL::int64(0), ctx));
+	}
+	releaseJSONContext(ctx);
+}
+
+TEST(functions) {
+	SPL::uint64 generator = createJSONGenerator("width=2,arrays=0,stringRatio=0,booleanRatio=0,numberTypes=float64");
+	CHECK(getJSONGeneratorType(generator) == "tuple<float64 f0, float64 f1>");
+	CHECK(generateJSON(generator).find("{\"f0\":") == 0);
+	releaseJSONGenerator(generator);
+
+	bool thrown = false;
+	try {
+		generateJSON(0);
+	}
+	catch(SPL::SPLRuntimeException const&) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	thrown = false;
+	try {
+		generateJSON(generator);
+	}
+	catch(SPL::SPLRuntimeException const&) {
+		thrown = true;
+	}
+	CHECK(thrown);
+}
+
+
+int main() {
+	RUN(config);
+	RUN(type);
+	RUN(deterministic);
+	RUN(documents);
+	RUN(keyOrder);
+	RUN(extract);
+	RUN(functions);
+	return failures();
+}
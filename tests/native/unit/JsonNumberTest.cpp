@@ -0,0 +1,122 @@
+/*
+ * JsonNumberTest.cpp
+ *
+ * Unit tests of the conversion of JSON strings to SPL numbers of JsonNumber.h,
+ * the doubles are compared against strtod, and of the range checks of the JSON
+ * numbers of JsonTupleHandler.h.
+ */
+
+#include "JsonNumber.h"
+#include "JsonTupleHandler.h"
+#include "UnitTest.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace com::ibm::streamsx::json;
+
+
+template<typename T>
+static bool parse(const char * s, T & result) {
+	return parseString(s, (rapidjson::SizeType)strlen(s), result);
+}
+
+/* parses as strtod does */
+static bool matchesStrtod(const char * s) {
+	double d = -1;
+	double expected = strtod(s, 0);
+	if(parse(s, d) && (d == expected || (d == 0 && expected == 0)))
+		return true;
+
+	std::cerr << "mismatch " << s << std::endl;
+	return false;
+}
+
+
+TEST(integers) {
+	SPL::int8 i8; SPL::int16 i16; SPL::int32 i32; SPL::int64 i64;
+	SPL::uint8 u8; SPL::uint32 u32; SPL::uint64 u64;
+
+	CHECK(parse("127", i8) && i8 == 127 && !parse("128", i8));
+	CHECK(parse("-128", i8) && i8 == -128 && !parse("-129", i8));
+	CHECK(parse("-32768", i16) && i16 == -32768 && !parse("32768", i16));
+	CHECK(parse("+42", i32) && i32 == 42);
+	CHECK(!parse("", i32) && !parse("-", i32) && !parse("4 2", i32) && !parse(" 42", i32) && !parse("1.0", i32));
+	CHECK(parse("-9223372036854775808", i64) && i64 == (-9223372036854775807LL - 1) && !parse("9223372036854775808", i64));
+	CHECK(parse("9223372036854775807", i64) && i64 == 9223372036854775807LL);
+	CHECK(parse("255", u8) && u8 == 255 && !parse("256", u8) && !parse("-1", u8) && parse("-0", u8) && u8 == 0);
+	CHECK(parse("4294967295", u32) && !parse("4294967296", u32));
+	CHECK(parse("18446744073709551615", u64) && u64 == 18446744073709551615ULL && !parse("18446744073709551616", u64));
+}
+
+TEST(booleans) {
+	SPL::boolean b;
+	CHECK(parse("true", b) && b && parse("false", b) && !b);
+	CHECK(parse("1", b) && b && parse("0", b) && !b);
+	CHECK(!parse("True", b) && !parse("yes", b) && !parse("", b));
+}
+
+TEST(doubles) {
+	static const char * const valid[] = {
+		"0", "-0", "1", "1.5", "-2.25", ".5", "5.", "1e10", "1E-10", "123456789012345678", "1234567890123456789012345",
+		"0.1", "0.3", "3.141592653589793", "2.2250738585072014e-308", "1.7976931348623157e308", "4.9e-324", "0.000001234",
+		"9007199254740993", "1e23", "8.98846567431158e307", "123.456e-5", "00012.5", "0.0000000000000000000000000001234567890123456789012",
+		"1e-400", "12345678901234567890.123456789e-3", "+7", "100000000000000000000000", "0.00", "1.00000000000000000000001", 0 };
+	for(int i = 0; valid[i]; i++)
+		CHECK(matchesStrtod(valid[i]));
+
+	double d;
+	CHECK(!parse("1e400", d) && !parse("", d) && !parse(".", d) && !parse("e5", d) && !parse("1e", d) && !parse("1e+", d));
+	CHECK(!parse("--1", d) && !parse("1.2.3", d) && !parse("0x10", d));
+	CHECK(parse("NaN", d) && d != d);
+	CHECK(parse("-inf", d) && d < 0 && std::isinf(d) && parse("Infinity", d) && !parse("infin", d));
+
+	SPL::float32 f;
+	CHECK(parse("3.5", f) && f == 3.5f && !parse("1e39", f) && parse("inf", f));
+}
+
+TEST(randomDoubles) {
+	srand(1);
+	int mismatches = 0;
+	for(int i = 0; i < 200000 && mismatches < 10; i++) {
+		char buffer[64];
+		double v = (double)rand() / RAND_MAX * pow(10.0, rand() % 40 - 20);
+		snprintf(buffer, sizeof(buffer), (i & 1) ? "%.17g" : "%.6g", v);
+		if(!matchesStrtod(buffer))
+			mismatches++;
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST(numberRange) {
+	CHECK(NumberRange<SPL::int8>::contains(127) && !NumberRange<SPL::int8>::contains(128));
+	CHECK(NumberRange<SPL::int8>::contains(-128) && !NumberRange<SPL::int8>::contains(-129));
+	CHECK(NumberRange<SPL::int8>::contains(127.9) && !NumberRange<SPL::int8>::contains(128.0));
+	CHECK(NumberRange<SPL::int8>::contains(-128.9) && !NumberRange<SPL::int8>::contains(-129.0));
+	CHECK(!NumberRange<SPL::int8>::contains(std::numeric_limits<double>::quiet_NaN()));
+
+	CHECK(!NumberRange<SPL::uint8>::contains(-1) && NumberRange<SPL::uint8>::contains(-0.5));
+	CHECK(NumberRange<SPL::uint8>::contains(255u) && !NumberRange<SPL::uint8>::contains(256u));
+	CHECK(!NumberRange<SPL::uint32>::contains((int64_t)-1) && NumberRange<SPL::uint32>::contains((int64_t)4294967295LL));
+
+	CHECK(NumberRange<SPL::int64>::contains((int64_t)9223372036854775807LL));
+	CHECK(!NumberRange<SPL::int64>::contains((uint64_t)9223372036854775808ULL));
+	CHECK(!NumberRange<SPL::int64>::contains(9223372036854775808.0) && NumberRange<SPL::int64>::contains(-9223372036854775808.0));
+	CHECK(!NumberRange<SPL::uint64>::contains(18446744073709551616.0) && NumberRange<SPL::uint64>::contains(1.8e19));
+	CHECK(NumberRange<SPL::uint64>::contains((uint64_t)18446744073709551615ULL));
+
+	CHECK(NumberRange<SPL::float32>::contains(3e38) && !NumberRange<SPL::float32>::contains(1e39) && !NumberRange<SPL::float32>::contains(-1e39));
+	CHECK(NumberRange<SPL::float32>::contains((uint64_t)18446744073709551615ULL) && NumberRange<SPL::float64>::contains(1e308));
+}
+
+
+int main() {
+	RUN(integers);
+	RUN(booleans);
+	RUN(doubles);
+	RUN(randomDoubles);
+	RUN(numberRange);
+	return failures();
+}
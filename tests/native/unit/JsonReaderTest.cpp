@@ -0,0 +1,451 @@
+/*
+ * JsonReaderTest.cpp
+ *
+ * Unit tests of extractFromJSON, the parse and query functions on indexes and
+ * contexts and the parse error, extract, latency and memory statistics of
+ * JsonReader.h, built with the SPL runtime shim (see ../Makefile).
+ */
+
+#include "Json.h"
+#include "UnitTest.h"
+
+#include <sstream>
+#include <string>
+
+using namespace com::ibm::streamsx::json;
+
+
+struct Inner : SPL::Tuple {
+	SPL::int32 c1;
+	SPL::rstring c2;
+
+	Inner() : c1(0) { reg(); }
+	Inner(Inner const& o) : SPL::Tuple(), c1(o.c1), c2(o.c2) { reg(); }
+	Inner & operator=(Inner const& o) { c1 = o.c1; c2 = o.c2; return *this; }
+	bool operator==(Inner const& o) const { return c1 == o.c1 && c2 == o.c2; }
+
+	void reg() { addAttribute("c1", c1); addAttribute("c2", c2); }
+};
+
+struct Coerced : SPL::Tuple {
+	SPL::int32 a;
+	SPL::boolean b;
+	SPL::float64 f;
+	SPL::optional<SPL::int8> o;
+	SPL::list<SPL::uint16> l;
+	SPL::map<SPL::rstring, SPL::float32> m;
+	SPL::rstring s;
+
+	Coerced() : a(0), b(false), f(0) {
+		addAttribute("a", a); addAttribute("b", b); addAttribute("f", f); addAttribute("o", o);
+		addAttribute("l", l); addAttribute("m", m); addAttribute("s", s);
+	}
+};
+
+struct Collections : SPL::Tuple {
+	SPL::list<SPL::int32> l;
+	SPL::map<SPL::rstring, SPL::int32> m;
+
+	Collections() { reg(); }
+	Collections(Collections const& o) : SPL::Tuple(), l(o.l), m(o.m) { reg(); }
+	Collections & operator=(Collections const& o) { l = o.l; m = o.m; return *this; }
+
+	void reg() { addAttribute("l", l); addAttribute("m", m); }
+};
+
+struct Profiled : SPL::Tuple {
+	SPL::int32 a;
+	SPL::list<SPL::int32> l;
+	SPL::rstring s;
+
+	Profiled() : a(0) { addAttribute("a", a); addAttribute("l", l); addAttribute("s", s); }
+};
+
+struct QueryIndex {};
+struct DefaultIndex {};
+struct CursorIndex {};
+struct LargeObjectIndex {};
+struct ContextIndex {};
+struct CoerceIndex {};
+struct MemoryIndex {};
+
+
+TEST(queryComposite) {
+	CHECK(parseJSON(SPL::rstring("{\"c\":{\"c1\":2,\"c2\":\"y\",\"z\":1},\"li\":[{\"c1\":5},{\"c1\":6},3],\"m\":{\"k\":7,\"j\":\"x\"},\"mt\":{\"a\":{\"c1\":1}},\"n\":null,\"o\":4}"), QueryIndex()) == 0);
+	int st = 0;
+	Inner d;
+	d.c2 = "def";
+
+	Inner r = queryJSON("/c", d, st, QueryIndex());
+	CHECK(st == 0 && r.c1 == 2 && r.c2 == "y");
+	r = queryJSON("/li/0", d, st, QueryIndex());
+	CHECK(st == 0 && r.c1 == 5 && r.c2 == "def");
+	r = queryJSON("/o", d, st, QueryIndex());
+	CHECK(st == 2 && r == d);
+
+	SPL::list<Inner> l = queryJSON("/li", SPL::list<Inner>(), st, QueryIndex());
+	CHECK(l.size() == 2 && l[1].c1 == 6 && st == 2);
+	SPL::map<SPL::rstring, SPL::int32> m = queryJSON("/m", SPL::map<SPL::rstring, SPL::int32>(), st, QueryIndex());
+	CHECK(m.size() == 1 && m["k"] == 7);
+	SPL::map<SPL::rstring, Inner> mt = queryJSON("/mt", SPL::map<SPL::rstring, Inner>(), st, QueryIndex());
+	CHECK(mt.size() == 1 && mt["a"].c1 == 1 && st == 0);
+
+	SPL::optional<SPL::int32> o = queryJSON("/o", SPL::optional<SPL::int32>(), st, QueryIndex());
+	CHECK(st == 0 && o.isPresent() && o.value() == 4);
+	o = queryJSON("/n", SPL::optional<SPL::int32>(3), st, QueryIndex());
+	CHECK(st == 3 && !o.isPresent());
+	o = queryJSON("/x", SPL::optional<SPL::int32>(3), st, QueryIndex());
+	CHECK(st == 4 && o.value() == 3);
+	SPL::optional<Inner> ot = queryJSON("/c", SPL::optional<Inner>(), st, QueryIndex());
+	CHECK(st == 0 && ot.value().c1 == 2);
+}
+
+TEST(queryDefaultCollections) {
+	CHECK(parseJSON(SPL::rstring("{\"t\":{\"l\":[1,2],\"m\":{\"a\":1}},\"u\":{}}"), DefaultIndex()) == 0);
+	int st = 0;
+
+	// a non-empty default list is replaced, not appended to
+	Collections d;
+	d.l.push_back(9);
+	Collections r = queryJSON("/t", d, st, DefaultIndex());
+	CHECK(st == 0 && r.l.size() == 2 && r.l[0] == 1 && r.l[1] == 2);
+	r = queryJSON("/t", r, st, DefaultIndex());
+	CHECK(st == 0 && r.l.size() == 2);
+
+	// a non-empty default map is replaced, keys not in the JSON object are removed
+	d.m["z"] = 9;
+	d.m["a"] = 5;
+	r = queryJSON("/t", d, st, DefaultIndex());
+	CHECK(st == 0 && r.m.size() == 1 && r.m["a"] == 1);
+
+	// collections without a matching key keep the default
+	r = queryJSON("/u", d, st, DefaultIndex());
+	CHECK(st == 0 && r.l.size() == 1 && r.l[0] == 9 && r.m.size() == 2);
+
+	// an array nested in the list does not clear the elements added before it
+	CHECK(parseJSON(SPL::rstring("{\"t\":{\"l\":[1,[2],3]}}"), DefaultIndex()) == 0);
+	r = queryJSON("/t", d, st, DefaultIndex());
+	Collections e;
+	extractFromJSON(SPL::rstring("{\"l\":[1,[2],3]}"), e);
+	CHECK(st == 0 && r.l == e.l && r.l.size() == 2 && r.l[0] == 1 && r.l[1] == 2);
+}
+
+TEST(cursors) {
+	CHECK(parseJSON(SPL::rstring("{\"orders\":[{\"items\":[{\"price\":1.5},{\"price\":2.5},{\"price\":null}]},{\"items\":[]}],\"n\":null}"), CursorIndex()) == 0);
+	int st = -1;
+	SPL::uint32 orders = cursorJSON(SPL::rstring("/orders"), st, CursorIndex());
+	CHECK(st == 0 && orders != 0);
+	CHECK(arraySizeJSON(orders, CursorIndex()) == 2 && memberCountJSON(orders, CursorIndex()) == 0);
+
+	SPL::uint32 o0 = elementJSON(orders, 0, st, CursorIndex());
+	CHECK(st == 0 && memberCountJSON(o0, CursorIndex()) == 1);
+	SPL::uint32 items = cursorJSON(o0, "/items", st, CursorIndex());
+	CHECK(st == 0);
+	double sum = 0;
+	for(SPL::uint32 k = 0; k < arraySizeJSON(items, CursorIndex()); k++)
+		sum += queryJSON(elementJSON(items, k, CursorIndex()), "/price", 0.0, st, CursorIndex());
+	CHECK(sum == 4.0 && st == 3);
+
+	// a value gets one cursor, walking the array again does not add cursors
+	SPL::uint32 last = elementJSON(items, 2, CursorIndex());
+	for(int walk = 0; walk < 1000; walk++)
+		for(SPL::uint32 k = 0; k < arraySizeJSON(items, CursorIndex()); k++)
+			elementJSON(items, k, CursorIndex());
+	CHECK(elementJSON(items, 2, CursorIndex()) == last && cursorJSON(o0, "/items", st, CursorIndex()) == items);
+	CHECK(cursorJSON(SPL::rstring(""), st, CursorIndex()) == 0 && last == items + 3);
+	CHECK(elementJSON(items, 7, CursorIndex()) == elementJSON(items, 8, CursorIndex()));
+
+	SPL::uint32 bad = elementJSON(orders, 5, st, CursorIndex());
+	CHECK(st == 4);
+	CHECK(queryJSON(bad, "/x", 7, st, CursorIndex()) == 7 && st == 4);
+	CHECK(arraySizeJSON(bad, CursorIndex()) == 0);
+	elementJSON(o0, 0, st, CursorIndex());
+	CHECK(st == 2);
+	cursorJSON(SPL::rstring("x"), st, CursorIndex());
+	CHECK(st == 5);
+	cursorJSON(SPL::rstring("/n"), st, CursorIndex());
+	CHECK(st == 3);
+
+	CHECK(queryJSON(0u, "/orders/0/items/1/price", 0.0, CursorIndex()) == 2.5);
+	CHECK(queryJSON(SPL::rstring("/orders/0/items/1/price"), 0.0, st, CursorIndex()) == 2.5 && st == 0);
+
+	// a parse invalidates the cursors
+	CHECK(parseJSON(SPL::rstring("{}"), CursorIndex()) == 0);
+	bool thrown = false;
+	try {
+		queryJSON(items, "/x", 0, CursorIndex());
+	}
+	catch(...) {
+		thrown = true;
+	}
+	CHECK(thrown);
+}
+
+TEST(memberIndex) {
+	std::ostringstream os;
+	os << "{";
+	for(int i = 0; i < 1000; i++)
+		os << "\"k" << i << "\":" << i << ",";
+	os << "\"k5\":-1,\"nested\":{\"a\":{\"b\":[1,{\"c\":42}]}},\"\":7}";
+	SPL::rstring json = os.str();
+
+	for(int mode = 0; mode < 2; mode++) {
+		setMemberIndexThreshold(mode ? 8u : 0u, LargeObjectIndex());
+		for(int rep = 0; rep < 2; rep++) {
+			CHECK(parseJSON(json, LargeObjectIndex()) == 0);
+			int st = 0;
+			// the first of duplicate members is found
+			for(int i = 0; i < 1000; i++)
+				CHECK(queryJSON(SPL::rstring("/k" + streams_boost::lexical_cast<std::string>(i)), -2, st, LargeObjectIndex()) == i);
+			CHECK(queryJSON(SPL::rstring("/nested/a/b/1/c"), 0, st, LargeObjectIndex()) == 42 && st == 0);
+			CHECK(queryJSON(SPL::rstring("/"), 0, st, LargeObjectIndex()) == 7 && st == 0);
+			CHECK(queryJSON(SPL::rstring("/missing"), 3, st, LargeObjectIndex()) == 3 && st == 4);
+			CHECK(queryJSON(SPL::rstring("/nested/a/b/x"), 3, st, LargeObjectIndex()) == 3 && st == 4);
+			CHECK(queryJSON(SPL::rstring("/k1/x"), 3, st, LargeObjectIndex()) == 3 && st == 4);
+			SPL::uint32 c = cursorJSON(SPL::rstring("/nested"), st, LargeObjectIndex());
+			CHECK(queryJSON(c, "/a/b/0", 0, LargeObjectIndex()) == 1);
+		}
+	}
+}
+
+TEST(contexts) {
+	SPL::uint64 ctx = createJSONContext();
+	SPL::rstring big = "{\"s\":\"" + std::string(200000, 'x') + "\",\"a\":{\"b\":[1,2,{\"c\":\"\\u00e9t\\u00e9\"}]}}";
+	for(int rep = 0; rep < 3; rep++) {
+		int st = -1;
+		SPL::uint32 offset = 0;
+		CHECK(parseJSON(big, st, offset, ctx) && st == -1);
+		CHECK(queryJSON(SPL::rstring("/a/b/1"), 0, ctx) == 2);
+		CHECK(queryJSON(SPL::rstring("/a/b/2/c"), SPL::rstring(), st, ctx) == "\xc3\xa9t\xc3\xa9" && st == 0);
+		CHECK(queryJSON(SPL::rstring("/s"), SPL::rstring(), st, ctx).size() == 200000);
+		// the invalid pointer is cached
+		CHECK(queryJSON(SPL::rstring("bad"), 5, st, ctx) == 5 && st == 5);
+		CHECK(queryJSON(SPL::rstring("bad"), 5, st, ctx) == 5 && st == 5);
+
+		SPL::uint32 c = cursorJSON(SPL::rstring("/a/b"), st, ctx);
+		CHECK(st == 0 && arraySizeJSON(c, ctx) == 3);
+		SPL::uint32 e = elementJSON(c, (SPL::uint32)2, ctx);
+		CHECK(memberCountJSON(e, ctx) == 1);
+		CHECK(queryJSON(e, SPL::rstring("/c"), SPL::rstring(), ctx).size() == 5);
+		CHECK(queryJSON(e, SPL::rstring("/x"), 1, st, ctx) == 1 && st == 4);
+
+		// index and context stay separate
+		CHECK(parseJSON(SPL::rstring("{\"a\":{\"b\":[7]}}"), ContextIndex()) == 0);
+		CHECK(queryJSON(SPL::rstring("/a/b/0"), 0, ContextIndex()) == 7);
+		CHECK(queryJSON(SPL::rstring("/a/b/0"), 0, ctx) == 1);
+
+		setMemberIndexThreshold(1u, ctx);
+		CHECK(parseJSON(SPL::rstring("[1"), ctx) != 0);
+		CHECK(queryJSON(SPL::rstring("/a"), 9, st, ctx) == 9 && st == 4);
+	}
+	CHECK(parseJSON(SPL::rstring("{\"a\":{\"x\":1,\"y\":2,\"z\":3}}"), ctx) == 0);
+	CHECK(queryJSON(SPL::rstring("/a/z"), 0, ctx) == 3);
+	releaseJSONContext(ctx);
+
+	bool thrown = false;
+	try {
+		parseJSON(SPL::rstring("{}"), (SPL::uint64)0);
+	}
+	catch(...) {
+		thrown = true;
+	}
+	CHECK(thrown);
+}
+
+static bool rejected(SPL::uint64 ctx) {
+	try {
+		parseJSON(SPL::rstring("{}"), ctx);
+	}
+	catch(...) {
+		return true;
+	}
+	return false;
+}
+
+TEST(contextHandles) {
+	SPL::uint64 first = createJSONContext();
+	SPL::uint64 second = createJSONContext();
+	CHECK(first != second && !rejected(first) && !rejected(second));
+
+	// the slot of a released context is reused with another generation
+	releaseJSONContext(first);
+	CHECK(rejected(first));
+	SPL::uint64 reused = createJSONContext();
+	CHECK(reused != first && (SPL::uint32)reused == (SPL::uint32)first);
+	CHECK(rejected(first) && !rejected(reused));
+
+	bool thrown = false;
+	try {
+		releaseJSONContext(first);
+	}
+	catch(...) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	// a handle from a checkpoint of another processing element, or an address
+	CHECK(rejected(second + 1) && rejected(second ^ (1ull << 40)) && rejected((SPL::uint64)(uintptr_t)&thrown));
+	releaseJSONContext(second);
+	releaseJSONContext(reused);
+}
+
+TEST(coerceStrings) {
+	SPL::rstring json = "{\"a\":\"42\",\"b\":\"true\",\"f\":\"1.5e3\",\"o\":\"-7\",\"l\":[\"1\",2,\"x\",\"70000\",\"3\"],\"m\":{\"k\":\"2.5\",\"j\":\"bad\"},\"s\":\"123\"}";
+	Coerced t;
+	extractFromJSON(json, t);
+	CHECK(t.a == 0 && !t.b && t.f == 0 && !t.o.isPresent() && t.l.size() == 1 && t.m.size() == 0 && t.s == "123");
+
+	Coerced c;
+	extractFromJSON(json, c, true);
+	CHECK(c.a == 42 && c.b && c.f == 1500 && c.o.isPresent() && c.o.value() == -7);
+	CHECK(c.l.size() == 3 && c.l[0] == 1 && c.l[1] == 2 && c.l[2] == 3);
+	CHECK(c.m.size() == 1 && c.m["k"] == 2.5f && c.s == "123");
+
+	CHECK(parseJSON(SPL::rstring("{\"i\":\"12\",\"x\":\"12a\",\"b\":\"1\",\"t\":\"true\",\"fa\":\"false\",\"nb\":\"yes\",\"d\":\"0.1\",\"u\":\"-1\"}"), CoerceIndex()) == 0);
+	int st;
+	CHECK(queryJSON(SPL::rstring("/i"), 0, st, CoerceIndex()) == 12 && st == 1);
+	CHECK(queryJSON(SPL::rstring("/x"), 5, st, CoerceIndex()) == 5 && st == 2);
+	CHECK(queryJSON(SPL::rstring("/b"), false, st, CoerceIndex()) == true && st == 1);
+	// true and false are accepted besides the 1 and 0 of lexical_cast
+	CHECK(queryJSON(SPL::rstring("/t"), false, st, CoerceIndex()) == true && st == 1);
+	CHECK(queryJSON(SPL::rstring("/fa"), true, st, CoerceIndex()) == false && st == 1);
+	CHECK(queryJSON(SPL::rstring("/nb"), false, st, CoerceIndex()) == false && st == 2);
+	CHECK(queryJSON(SPL::rstring("/d"), 0.0, st, CoerceIndex()) == 0.1 && st == 1);
+	CHECK(queryJSON(SPL::rstring("/u"), (SPL::uint32)9, st, CoerceIndex()) == 9 && st == 2);
+	CHECK(queryJSON(SPL::rstring("/i"), (SPL::int8)0, st, CoerceIndex()) == 12 && st == 1);
+}
+
+TEST(parseErrors) {
+	ParseErrorLog log;
+	log.add(rapidjson::kParseErrorValueInvalid, 3);
+	CHECK(log.report() && log.summary() == "");
+	for(int i = 0; i < 5; i++) {
+		log.add(rapidjson::kParseErrorObjectMissColon, 10 + i);
+		CHECK(!log.report());
+	}
+	CHECK(log.getTotal() == 6 && log.getCount(rapidjson::kParseErrorObjectMissColon) == 5 && log.getCount(rapidjson::kParseErrorValueInvalid) == 1);
+	CHECK(log.getFirstOffset() == 3 && log.getLastOffset() == 14);
+
+	JsonContext ctx;
+	rapidjson::ParseErrorCode st;
+	uint32_t offset;
+	CHECK(!ctx.parse(SPL::rstring("{\"a\" 1}"), st, offset));
+	CHECK(st == rapidjson::kParseErrorObjectMissColon && offset == 5);
+	CHECK(ctx.getParseErrors().getTotal() == 1 && ctx.getParseErrors().getCount(st) == 1);
+}
+
+TEST(extractProfile) {
+	Profiled t;
+	extractFromJSON(SPL::rstring("{\"x\":1}"), t);
+	CHECK(getExtractProfile().size() == 0);
+
+	enableExtractProfile(2);
+	// x dropped with its nested keys, a mismatched container, an element of l mismatched, y and z dropped
+	extractFromJSON(SPL::rstring("{\"x\":{\"p\":[1,2],\"q\":\"r\"},\"a\":[1],\"l\":[\"a\",1],\"y\":true,\"z\":null,\"s\":\"v\"}"), t);
+	extractFromJSON(SPL::rstring("{\"x\":5}"), t);
+	SPL::map<SPL::rstring, SPL::uint64> p = getExtractProfile();
+	CHECK(p["nDocuments"] == 2 && p["nDroppedKeys"] == 4 && p["nTypeMismatches"] == 2);
+	CHECK(p["nDroppedKeysBytes"] == 23 + 9 + 9 + 5);
+	CHECK(p["typeMismatch.a.count"] == 1 && p["typeMismatch.a.bytes"] == 4);
+	CHECK(p["typeMismatch.l.count"] == 1 && p["typeMismatch.l.bytes"] == 3 && t.l.size() == 1);
+	// with capacity 2 z replaced x and x replaced y, inheriting their counts
+	CHECK(p["droppedKey.z.count"] == 2 && p["droppedKey.z.error"] == 1);
+	CHECK(p["droppedKey.x.count"] == 2 && p["droppedKey.x.error"] == 1 && !p.count("droppedKey.y.count"));
+
+	enableExtractProfile(0);
+	CHECK(getExtractProfile().size() == 0);
+}
+
+TEST(latencyProfile) {
+	CHECK(LatencyHistogram::bucket(0) == 0 && LatencyHistogram::bucket(1) == 1);
+	CHECK(LatencyHistogram::bucket(1023) == 10 && LatencyHistogram::bucket(1024) == 11);
+	LatencyHistogram h;
+	for(int i = 0; i < 98; i++)
+		h.add(100);
+	h.add(5000);
+	h.add(1000000);
+	CHECK(h.percentile(0.5) == 127 && h.percentile(0.99) == 8191 && h.percentile(0.999) == 1000000);
+
+	SlowDocuments s(2);
+	s.add(5, "a", 1);
+	s.add(9, "b", 1);
+	CHECK(!s.isSlow(4) && s.isSlow(6));
+	s.add(7, "c", 1);
+	CHECK(!s.isSlow(6) && s.isSlow(8));
+
+	LatencyProfile none(0);
+	none.add(3, "x", 1);
+	CHECK(none.toJSON().find("\"slowest\":[]") != std::string::npos);
+
+	Inner t;
+	extractFromJSON(SPL::rstring("{\"c1\":1}"), t);
+	CHECK(dumpLatencyProfile() == "{\"operators\":{}}");
+
+	enableLatencyProfile(2);
+	extractFromJSON(SPL::rstring("{\"c1\":1}"), t);
+	extractFromJSON(SPL::rstring("{\"c1\":2" + std::string(1000, ' ') + "}"), t);
+	extractFromJSON(SPL::rstring("{\"c1\":3}"), t);
+	SPL::uint64 ctx = createJSONContext();
+	parseJSON(SPL::rstring("{\"b\":1}"), ctx);
+	releaseJSONContext(ctx);
+	std::string dump = dumpLatencyProfile();
+	CHECK(dump.find("{\"extractFromJSON\":{\"count\":3,") == 0);
+	CHECK(dump.find("\"parseJSON\":{\"count\":1,") != std::string::npos);
+	CHECK(dump.find("\"size\":1008") != std::string::npos);
+}
+
+TEST(memory) {
+	AllocationStats stats;
+	CountingAllocator allocator(&stats);
+	void * p = allocator.Malloc(100);
+	p = allocator.Realloc(p, 100, 300);
+	CHECK(stats.currentBytes == 300 && stats.peakBytes == 300);
+	CountingAllocator::Free(p);
+	CHECK(stats.currentBytes == 0 && stats.allocations == 2 && stats.frees == 2);
+
+	// the arena is allocated by the first parse
+	SPL::uint64 ctx = createJSONContext();
+	CHECK(getJSONMemory(ctx)["arenaBytes"] == 0);
+	std::string big = "[";
+	for(int i = 0; i < 20000; i++)
+		big += "{\"k\":\"value\"},";
+	big += "1]";
+	CHECK(parseJSON(SPL::rstring(big), ctx) == 0);
+	SPL::map<SPL::rstring, SPL::uint64> m = getJSONMemory(ctx);
+	CHECK(m["documentChunkCurrentBytes"] > 0 && m["documentChunkBlocks"] > 0);
+	CHECK(m["documentStackCurrentBytes"] == 0 && m["documentStackPeakBytes"] > 0);
+	CHECK(m["scratchBytes"] >= big.size() && m["arenaBytes"] == 65536);
+	CHECK(queryJSON(SPL::rstring("/2/k"), SPL::rstring(""), ctx) == "value");
+
+	// the chunks of a large document are freed by the next parse
+	SPL::uint64 peak = m["documentChunkPeakBytes"];
+	CHECK(parseJSON(SPL::rstring("{\"a\":1}"), ctx) == 0);
+	m = getJSONMemory(ctx);
+	CHECK(m["documentChunkCurrentBytes"] == 0 && m["documentChunkBlocks"] == 0 && m["documentChunkPeakBytes"] == peak);
+	releaseJSONContext(ctx);
+
+	// the reader of extractFromJSON keeps its stack for the longest string, reported with an index
+	Inner t;
+	extractFromJSON(SPL::rstring("{\"c2\":\"" + std::string(5000, 'x') + "\"}"), t);
+	extractFromJSON(SPL::rstring("{\"c2\":\"y\"}"), t);
+	m = getJSONMemory(MemoryIndex());
+	CHECK(t.c2 == "y" && m["extractStackPeakBytes"] >= 5000 && m["extractStackCurrentBytes"] >= 5000);
+	CHECK(getJSONMemory(ctx = createJSONContext()).count("extractStackPeakBytes") == 0);
+	releaseJSONContext(ctx);
+}
+
+
+int main() {
+	RUN(queryComposite);
+	RUN(queryDefaultCollections);
+	RUN(cursors);
+	RUN(memberIndex);
+	RUN(contexts);
+	RUN(contextHandles);
+	RUN(coerceStrings);
+	RUN(parseErrors);
+	RUN(extractProfile);
+	RUN(latencyProfile);
+	RUN(memory);
+	return failures();
+}
@@ -0,0 +1,261 @@
+/*
+ * JsonSimdTest.cpp
+ *
+ * Unit tests of the SIMD kernels of the vendored rapidjson selected at runtime,
+ * every level the CPU supports is compared against the scalar kernels, on all
+ * alignments and on documents and strings parsed (copying and in situ) and
+ * written by rapidjson, and at the end of a page followed by an inaccessible page.
+ */
+
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "UnitTest.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef RAPIDJSON_SIMD_DISPATCH
+
+using namespace rapidjson::internal;
+
+
+/* levels supported by the CPU, scalar first */
+static std::vector<SimdLevel> levels() {
+	std::vector<SimdLevel> result;
+	for(int level = kSimdScalar; level <= GetSupportedSimdLevel(); level++)
+		result.push_back(static_cast<SimdLevel>(level));
+	return result;
+}
+
+/* random text of whitespace, plain, special and non-ASCII characters, runs are long enough for the vectors */
+static std::string randomText(size_t length, unsigned seed) {
+	static const char whitespace[] = " \n\r\t";
+	static const char special[] = "\"\\\x01\x1f";
+	srand(seed);
+	std::string text;
+	while(text.size() < length) {
+		size_t run = rand() % 70;
+		int kind = rand() % 4;
+		for(size_t i = 0; i < run && text.size() < length; i++) {
+			switch(kind) {
+				case 0: text += whitespace[rand() % 4]; break;
+				case 1: text += static_cast<char>('a' + rand() % 26); break;
+				case 2: text += static_cast<char>(0x80 + rand() % 0x80); break;
+				default: text += special[rand() % 4]; kind = 1; break;
+			}
+		}
+	}
+	return text;
+}
+
+
+TEST(level) {
+	SimdLevel supported = GetSupportedSimdLevel();
+	CHECK(GetSimdLevel() == supported);
+	CHECK(SetSimdLevel(kSimdScalar) == kSimdScalar);
+	CHECK(SetSimdLevel(kSimdAVX2) == supported);
+	CHECK(std::string(GetSimdLevelName(kSimdSSE42)) == "sse4.2");
+}
+
+TEST(kernels) {
+	const SimdKernels& scalar = GetSimdKernels(kSimdScalar);
+	std::vector<SimdLevel> supported = levels();
+	/* 64 bytes of slack after the terminator, the aligned loads may read past it */
+	std::vector<char> buffer(512 + 64 + 64);
+	int mismatches = 0;
+
+	for(unsigned seed = 0; seed < 200; seed++) {
+		std::string text = randomText(1 + seed % 300, seed);
+		size_t offset = seed % 64;
+		char * p = &buffer[0] + offset;
+		memcpy(p, text.c_str(), text.size() + 1);
+		const char * end = p + text.size();
+
+		for(size_t start = 0; start < text.size(); start += 1 + start % 7) {
+			const char * s = p + start;
+			for(size_t i = 0; i < supported.size(); i++) {
+				const SimdKernels& kernels = GetSimdKernels(supported[i]);
+				if(kernels.skipWhitespace(s) != scalar.skipWhitespace(s)
+						|| kernels.skipWhitespaceN(s, end) != scalar.skipWhitespaceN(s, end)
+						|| kernels.scanUnescaped(s) != scalar.scanUnescaped(s)
+						|| kernels.scanUnescapedN(s, end) != scalar.scanUnescapedN(s, end)) {
+					std::cerr << GetSimdLevelName(supported[i]) << " mismatch seed " << seed << " start " << start << std::endl;
+					mismatches++;
+				}
+			}
+		}
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST(document) {
+	/* long whitespace runs and strings with escapes at all positions */
+	std::string json = "{\n";
+	for(int i = 0; i < 40; i++) {
+		json += std::string(i, ' ') + "\"key" + std::string(i, 'k') + "\" :\t\r\n";
+		json += std::string(i % 17, '\t') + "\"" + std::string(i, 'v') + "\\\"" + std::string(40 - i, 'w')
+			+ "\\n\\u00e9\xc3\xa9" + std::string(i * 3, 'x') + "\"" + std::string(i % 33, ' ') + ",\n";
+	}
+	json += "\"last\": [ 1 ,  2 ,\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n 3 ] }";
+
+	std::vector<SimdLevel> supported = levels();
+	std::string expected;
+	for(size_t i = 0; i < supported.size(); i++) {
+		SetSimdLevel(supported[i]);
+
+		rapidjson::Document document;
+		CHECK(!document.Parse(json.c_str()).HasParseError());
+		rapidjson::StringBuffer buffer;
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+		document.Accept(writer);
+
+		std::vector<char> insitu(json.begin(), json.end());
+		insitu.push_back('\0');
+		rapidjson::Document insituDocument;
+		CHECK(!insituDocument.ParseInsitu(&insitu[0]).HasParseError());
+		CHECK(insituDocument == document);
+
+		if(i == 0)
+			expected = buffer.GetString();
+		CHECK(expected == buffer.GetString());
+	}
+	CHECK(expected.find("\"keykkk\":\"vvv\\\"") != std::string::npos);
+	CHECK(expected.find("\\n\xc3\xa9\xc3\xa9") != std::string::npos);
+	SetSimdLevel(kSimdAVX2);
+}
+
+TEST(strings) {
+	/* strings of all lengths and alignments with an escape or non-ASCII character at all positions */
+	std::vector<std::string> expected;
+	std::string json = "[";
+	for(int length = 0; length < 100; length++) {
+		for(int position = 0; position <= length; position += 1 + length / 8) {
+			std::string value(length, static_cast<char>('a' + length % 26));
+			std::string escaped = value;
+			if(position < length) {
+				static const char * const escapes[] = { "\\\\", "\\\"", "\\t", "\\u0041", "\\u00e9" };
+				static const char * const unescaped[] = { "\\", "\"", "\t", "A", "\xc3\xa9" };
+				int e = (length + position) % 5;
+				escaped = value.substr(0, position) + escapes[e] + value.substr(position + 1);
+				value = value.substr(0, position) + unescaped[e] + value.substr(position + 1);
+			}
+			expected.push_back(value);
+			json += std::string(expected.size() == 1 ? "" : ",") + std::string(position % 3, ' ') + "\"" + escaped + "\"";
+		}
+	}
+	json += "]";
+
+	std::vector<SimdLevel> supported = levels();
+	for(size_t i = 0; i < supported.size(); i++) {
+		SetSimdLevel(supported[i]);
+
+		rapidjson::Document document;
+		CHECK(!document.Parse(json.c_str()).HasParseError() && document.Size() == expected.size());
+		std::vector<char> insitu(json.begin(), json.end());
+		insitu.push_back('\0');
+		rapidjson::Document insituDocument;
+		CHECK(!insituDocument.ParseInsitu(&insitu[0]).HasParseError() && insituDocument.Size() == expected.size());
+
+		int mismatches = 0;
+		for(rapidjson::SizeType j = 0; j < document.Size() && j < insituDocument.Size() && j < expected.size(); j++) {
+			if(expected[j] != std::string(document[j].GetString(), document[j].GetStringLength())
+					|| expected[j] != std::string(insituDocument[j].GetString(), insituDocument[j].GetStringLength()))
+				mismatches++;
+		}
+		if(mismatches != 0)
+			std::cerr << GetSimdLevelName(supported[i]) << " " << mismatches << " mismatches" << std::endl;
+		CHECK(mismatches == 0);
+	}
+	SetSimdLevel(kSimdAVX2);
+}
+
+TEST(parseErrors) {
+	std::vector<SimdLevel> supported = levels();
+	for(size_t i = 0; i < supported.size(); i++) {
+		SetSimdLevel(supported[i]);
+		rapidjson::Document document;
+		/* control character and missing quotation mark after a long clean span */
+		document.Parse(("[\"" + std::string(100, 'a') + "\x01\"]").c_str());
+		CHECK(document.GetParseError() == rapidjson::kParseErrorStringEscapeInvalid && document.GetErrorOffset() == 102);
+		document.Parse(("[\"" + std::string(100, 'a')).c_str());
+		CHECK(document.GetParseError() == rapidjson::kParseErrorStringMissQuotationMark && document.GetErrorOffset() == 102);
+		document.Parse(("[" + std::string(100, ' ')).c_str());
+		CHECK(document.GetParseError() == rapidjson::kParseErrorValueInvalid && document.GetErrorOffset() == 101);
+	}
+	SetSimdLevel(kSimdAVX2);
+}
+
+TEST(pageBoundary) {
+	/* the terminator is the last byte of a page followed by a PROT_NONE page, an over-read past the page faults */
+	size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	char * pages = static_cast<char*>(mmap(NULL, 2 * pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	CHECK(pages != MAP_FAILED);
+	if(pages == MAP_FAILED)
+		return;
+	CHECK(mprotect(pages + pageSize, pageSize, PROT_NONE) == 0);
+	char * pageEnd = pages + pageSize;
+
+	const SimdKernels& scalar = GetSimdKernels(kSimdScalar);
+	std::vector<SimdLevel> supported = levels();
+	int mismatches = 0;
+	for(size_t length = 0; length < 100; length++) {
+		for(int kind = 0; kind < 2; kind++) {
+			char * p = pageEnd - length - 1;
+			memset(p, kind == 0 ? ' ' : 'a', length);
+			p[length] = '\0';
+			const char * end = p + length;
+			for(size_t i = 0; i < supported.size(); i++) {
+				const SimdKernels& kernels = GetSimdKernels(supported[i]);
+				if(kernels.skipWhitespace(p) != scalar.skipWhitespace(p)
+						|| kernels.skipWhitespaceN(p, end) != scalar.skipWhitespaceN(p, end)
+						|| kernels.scanUnescaped(p) != scalar.scanUnescaped(p)
+						|| kernels.scanUnescapedN(p, end) != scalar.scanUnescapedN(p, end)) {
+					std::cerr << GetSimdLevelName(supported[i]) << " mismatch length " << length << std::endl;
+					mismatches++;
+				}
+			}
+		}
+	}
+	CHECK(mismatches == 0);
+
+	/* a document whose string and trailing whitespace run up to the terminator */
+	std::string json = "[\"" + std::string(70, 'v') + "\"]" + std::string(45, ' ');
+	for(size_t i = 0; i < supported.size(); i++) {
+		SetSimdLevel(supported[i]);
+		char * p = pageEnd - json.size() - 1;
+		memcpy(p, json.c_str(), json.size() + 1);
+		rapidjson::Document document;
+		CHECK(!document.Parse(p).HasParseError() && document[0].GetStringLength() == 70);
+		rapidjson::Document insituDocument;
+		CHECK(!insituDocument.ParseInsitu(p).HasParseError() && insituDocument[0].GetStringLength() == 70);
+	}
+	SetSimdLevel(kSimdAVX2);
+
+	munmap(pages, 2 * pageSize);
+}
+
+
+int main() {
+	RUN(level);
+	RUN(kernels);
+	RUN(document);
+	RUN(strings);
+	RUN(parseErrors);
+	RUN(pageBoundary);
+	return failures();
+}
+
+#else
+
+/* the kernels are selected at compile time or not available on this platform */
+int main() {
+	std::cout << "SKIP simd" << std::endl;
+	return 0;
+}
+
+#endif /* RAPIDJSON_SIMD_DISPATCH */
@@ -0,0 +1,83 @@
+/*
+ * JsonWriterTest.cpp
+ *
+ * Unit tests of the serialization of the SPL values of JsonWriter.h, built
+ * with the SPL runtime shim (see ../Makefile).
+ */
+
+#include "Json.h"
+#include "UnitTest.h"
+
+#include <string>
+
+using namespace com::ibm::streamsx::json;
+
+
+struct Inner : SPL::Tuple {
+	SPL::int32 c1;
+	SPL::rstring c2;
+
+	Inner() : c1(0) { reg(); }
+	Inner(Inner const& o) : SPL::Tuple(), c1(o.c1), c2(o.c2) { reg(); }
+	Inner & operator=(Inner const& o) { c1 = o.c1; c2 = o.c2; return *this; }
+
+	void reg() { addAttribute("c1", c1); addAttribute("c2", c2); }
+};
+
+
+TEST(writeValue) {
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	SPL::rstring prefix("");
+
+	SPL::list<SPL::int32> l;
+	l.push_back(1);
+	l.push_back(-2);
+	SPL::map<SPL::rstring, SPL::float64> m;
+	m["a"] = 1.5;
+	SPL::optional<SPL::int64> o;
+	SPL::optional<SPL::rstring> os(SPL::rstring("q\"x"));
+	SPL::list<Inner> li(1, Inner());
+	li[0].c1 = 3;
+	li[0].c2 = "z";
+	SPL::map<SPL::ustring, SPL::int32> mu;
+	mu[SPL::ustring("u")] = 2;
+	SPL::map<SPL::int8, SPL::rstring> mi;
+	mi[-3] = "v";
+
+	writer.StartObject();
+	writer.Key("b"); writeValue(writer, SPL::boolean(true), prefix);
+	writer.Key("u"); writeValue(writer, SPL::uint64(18446744073709551615ULL), prefix);
+	writer.Key("l"); writeValue(writer, l, prefix);
+	writer.Key("m"); writeValue(writer, m, prefix);
+	writer.Key("o"); writeValue(writer, o, prefix);
+	writer.Key("os"); writeValue(writer, os, prefix);
+	writer.Key("li"); writeValue(writer, li, prefix);
+	writer.Key("mu"); writeValue(writer, mu, prefix);
+	writer.Key("mi"); writeValue(writer, mi, prefix);
+	// tuples in collections are written with the prefix removed from their attribute names
+	writer.Key("lp"); writeValue(writer, li, SPL::rstring("c"));
+	writer.EndObject();
+
+	std::string json(buffer.GetString(), buffer.GetSize());
+	CHECK(json == "{\"b\":true,\"u\":18446744073709551615,\"l\":[1,-2],\"m\":{\"a\":1.5},\"o\":null,\"os\":\"q\\\"x\",\"li\":[{\"c1\":3,\"c2\":\"z\"}]"
+		",\"mu\":{\"u\":2},\"mi\":{\"-3\":\"v\"},\"lp\":[{\"1\":3,\"2\":\"z\"}]}");
+}
+
+TEST(roundTrip) {
+	Inner t;
+	t.c1 = -7;
+	t.c2 = "tab\tquote\"\xc3\xa9";
+	SPL::rstring json = tupleToJSON(t);
+
+	Inner r;
+	extractFromJSON(json, r);
+	CHECK(r.c1 == t.c1 && r.c2 == t.c2);
+}
+
+
+int main() {
+	RUN(writeValue);
+	RUN(roundTrip);
+	return failures();
+}
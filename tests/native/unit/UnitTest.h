@@ -0,0 +1,44 @@
+/*
+ * UnitTest.h
+ *
+ * Minimal checks for the unit tests of the native code, a failed check is
+ * reported with its location and the test continues. main returns the number
+ * of failed checks:
+ *
+ *   TEST(parse) { CHECK(parseJSON(json, Index()) == 0); }
+ *   int main() { RUN(parse); return failures(); }
+ */
+
+#ifndef UNIT_TEST_H_
+#define UNIT_TEST_H_
+
+#include <iostream>
+
+namespace unit {
+
+	inline int & failureCount() {
+		static int count = 0;
+		return count;
+	}
+
+	inline void fail(const char * file, int line, const char * expression) {
+		failureCount()++;
+		std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+	}
+}
+
+#define TEST(name) static void test_##name()
+
+#define CHECK(expression) do { if(!(expression)) unit::fail(__FILE__, __LINE__, #expression); } while(0)
+
+#define RUN(name) do { \
+		int before = unit::failureCount(); \
+		test_##name(); \
+		std::cout << (unit::failureCount() == before ? "PASS " : "FAIL ") << #name << std::endl; \
+	} while(0)
+
+inline int failures() {
+	return unit::failureCount();
+}
+
+#endif /* UNIT_TEST_H_ */